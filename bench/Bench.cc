@@ -0,0 +1,167 @@
+#include <sys/time.h>
+#include <algorithm>
+#include <sstream>
+#include "Bench.hh"
+
+namespace Bench
+{
+  /*!
+  ** Get the wall clock time. boost::timer measures the processor time,
+  ** which ignores the time spent waiting for the disk or other threads.
+  **
+  ** @return The current time, in seconds
+  */
+  double
+  now()
+  {
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+  }
+
+  /*!
+  ** Get a percentile of samples, using the nearest rank.
+  ** Samples are sorted in place.
+  **
+  ** @param samples The samples
+  ** @param p The percentile wanted, between 0 and 100
+  **
+  ** @return The sample at this rank, or 0 without sample
+  */
+  double
+  percentile(std::vector<double>& samples, const double p)
+  {
+    if (samples.empty())
+      return 0.0;
+
+    std::sort(samples.begin(), samples.end());
+    unsigned int rank = static_cast<unsigned int>(p / 100.0 * samples.size() + 0.5);
+    if (rank > 0)
+      rank--;
+    if (rank >= samples.size())
+      rank = samples.size() - 1;
+
+    return samples[rank];
+  }
+
+  /*!
+  ** Construct a report.
+  **
+  ** @param name The name of the benchmark
+  */
+  Report::Report(const std::string& name)
+  {
+    add("benchmark", name);
+  }
+
+  /*!
+  ** Destruct a report.
+  */
+  Report::~Report()
+  {
+  }
+
+  /*!
+  ** Add a string measure.
+  **
+  ** @param key The name of the measure
+  ** @param value Its value
+  */
+  void
+  Report::add(const std::string& key, const std::string& value)
+  {
+    _fields.push_back(field(key, quote(value)));
+  }
+
+  /*!
+  ** Add a real measure.
+  **
+  ** @param key The name of the measure
+  ** @param value Its value
+  */
+  void
+  Report::add(const std::string& key, const double value)
+  {
+    std::ostringstream str;
+    str.precision(15);
+    str << value;
+    _fields.push_back(field(key, str.str()));
+  }
+
+  /*!
+  ** Add an integer measure.
+  **
+  ** @param key The name of the measure
+  ** @param value Its value
+  */
+  void
+  Report::add(const std::string& key, const unsigned int value)
+  {
+    std::ostringstream str;
+    str << value;
+    _fields.push_back(field(key, str.str()));
+  }
+
+  /*!
+  ** Add the distribution of latencies, in milliseconds.
+  **
+  ** @param prefix Prefix of the measure names
+  ** @param samples The latencies, in seconds. They are sorted.
+  */
+  void
+  Report::addLatencies(const std::string& prefix, std::vector<double>& samples)
+  {
+    double total = 0.0;
+    for (std::vector<double>::const_iterator i = samples.begin(); i != samples.end(); ++i)
+      total += *i;
+
+    add(prefix + "count", static_cast<unsigned int>(samples.size()));
+    add(prefix + "mean_ms", samples.empty() ? 0.0 : total * 1000.0 / samples.size());
+    add(prefix + "p50_ms", percentile(samples, 50) * 1000.0);
+    add(prefix + "p95_ms", percentile(samples, 95) * 1000.0);
+    add(prefix + "p99_ms", percentile(samples, 99) * 1000.0);
+    add(prefix + "max_ms", samples.empty() ? 0.0 : samples.back() * 1000.0);
+  }
+
+  /*!
+  ** Print the report as a JSON object, on one line.
+  **
+  ** @param o The stream where to print
+  */
+  void
+  Report::print(std::ostream& o) const
+  {
+    o << "{";
+    for (std::vector<field>::const_iterator i = _fields.begin(); i != _fields.end(); ++i)
+    {
+      if (i != _fields.begin())
+	o << ", ";
+      o << quote(i->first) << ": " << i->second;
+    }
+    o << "}" << std::endl;
+  }
+
+  /*!
+  ** Quote a string for JSON.
+  **
+  ** @param str The string to quote
+  **
+  ** @return The quoted string
+  */
+  std::string
+  Report::quote(const std::string& str)
+  {
+    std::string res = "\"";
+    for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+    {
+      if (*i == '"' || *i == '\\')
+	res += '\\';
+      if (static_cast<unsigned char>(*i) < ' ')
+	res += ' ';
+      else
+	res += *i;
+    }
+
+    return res + "\"";
+  }
+}
@@ -0,0 +1,41 @@
+#ifndef BENCH_HH_
+# define BENCH_HH_
+
+# include <iostream>
+# include <string>
+# include <utility>
+# include <vector>
+
+namespace Bench
+{
+  double now();
+  double percentile(std::vector<double>& samples, const double p);
+
+  /*!
+  ** A flat list of named measures, printed as a single JSON object so
+  ** that successive runs can be compared by a script.
+  */
+  class Report
+  {
+    typedef std::pair<std::string, std::string> field;
+
+  public:
+    Report(const std::string& name);
+    ~Report();
+
+  public:
+    void add(const std::string& key, const std::string& value);
+    void add(const std::string& key, const double value);
+    void add(const std::string& key, const unsigned int value);
+    void addLatencies(const std::string& prefix, std::vector<double>& samples);
+    void print(std::ostream& o = std::cout) const;
+
+  private:
+    static std::string quote(const std::string& str);
+
+  private:
+    std::vector<field>	_fields;
+  };
+}
+
+#endif /* !BENCH_HH_ */
@@ -0,0 +1,294 @@
+#include <boost/filesystem/operations.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <sstream>
+#include "CorpusGenerator.hh"
+
+namespace fs = boost::filesystem;
+
+namespace Bench
+{
+  namespace
+  {
+    // Frequent French words, the most frequent first. Accented letters
+    // are in ISO-8859-1, like the documents this project indexes.
+    static const char* const WORDS[] = {
+      "de", "la", "le", "et", "les", "des", "en", "un", "du", "une",
+      "que", "est", "pour", "qui", "dans", "par", "plus", "pas", "au", "sur",
+      "ne", "se", "ce", "il", "sont", "avec", "son", "mais", "comme", "ou",
+      "\351t\351", "fait", "tout", "nous", "sa", "aussi", "bien", "deux", "peut", "entre",
+      "ann\351e", "France", "temps", "monde", "pays", "ville", "travail", "maison", "politique", "gouvernement",
+      "histoire", "soci\351t\351", "syst\350me", "projet", "march\351", "\351cole", "enfants", "famille", "probl\350me", "question",
+      "d\351veloppement", "recherche", "r\351seau", "donn\351es", "information", "programme", "service", "entreprise", "\351conomie", "r\351gion",
+      "chat", "chien", "maisons", "jardin", "for\352t", "rivi\350re", "montagne", "mer", "soleil", "pluie",
+      "manger", "marcher", "parler", "chercher", "trouver", "donner", "prendre", "venir", "partir", "rester",
+      "grand", "petit", "nouveau", "premier", "dernier", "beau", "fort", "long", "jeune", "ancien",
+      "rapidement", "lentement", "souvent", "toujours", "jamais", "ensemble", "encore", "d\351j\340", "bient\364t", "longtemps",
+      "biblioth\350que", "ordinateur", "logiciel", "fichier", "document", "requ\352te", "moteur", "index", "terme", "racine",
+      0
+    };
+
+    // Syllables of the generated rare words
+    static const char* const SYLLABLES[] = {
+      "ba", "che", "di", "fo", "gre", "la", "ment", "ni", "on", "pre",
+      "que", "ri", "sion", "tte", "vau", "eur", "ois", "ain", "ier", "ade",
+      0
+    };
+
+    // Marks ending a sentence
+    static const char* const PUNCTUATION[] = { ".", ".", ".", "!", "?", 0 };
+  }
+
+  /*!
+  ** Construct a generator.
+  **
+  ** @param seed The seed of the pseudo random sequence
+  ** @param vocabularySize Number of distinct words
+  ** @param exponent The exponent of the Zipf law, 1 for natural language
+  */
+  CorpusGenerator::CorpusGenerator(const unsigned int seed,
+				   const unsigned int vocabularySize,
+				   const double exponent)
+    : _state(seed ? seed : 1)
+  {
+    // Known words first, then words built from syllables
+    for (unsigned int i = 0; WORDS[i] && _words.size() < vocabularySize; i++)
+      _words.push_back(WORDS[i]);
+
+    unsigned int syllables = 0;
+    while (SYLLABLES[syllables])
+      syllables++;
+    for (unsigned int n = 0; _words.size() < vocabularySize; n++)
+    {
+      std::string word;
+      unsigned int i = n;
+      do
+      {
+	word += SYLLABLES[i % syllables];
+	i /= syllables;
+      }
+      while (i > 0 || word.size() < 4);
+      _words.push_back(word);
+    }
+
+    // Probability of the word of rank r is proportional to 1 / r^s
+    double total = 0.0;
+    for (unsigned int r = 1; r <= _words.size(); r++)
+    {
+      total += 1.0 / std::pow(static_cast<double>(r), exponent);
+      _cumulative.push_back(total);
+    }
+    for (std::vector<double>::iterator i = _cumulative.begin(); i != _cumulative.end(); ++i)
+      *i /= total;
+  }
+
+  /*!
+  ** Destruct a generator.
+  */
+  CorpusGenerator::~CorpusGenerator()
+  {
+  }
+
+  /*!
+  ** Write the documents, numbered, in the given directory.
+  ** Documents are split in subfolders of 100 documents.
+  **
+  ** @param dirname The directory, created if needed
+  ** @param count Number of documents
+  ** @param size Approximative size of each document, in bytes
+  ** @param htmlRatio Part of HTML documents, between 0 and 1
+  **
+  ** @return The total size written, in bytes
+  */
+  unsigned int
+  CorpusGenerator::generate(const std::string& dirname,
+			    const unsigned int count,
+			    const unsigned int size,
+			    const double htmlRatio)
+  {
+    unsigned int written = 0;
+    const fs::path root(dirname, fs::native);
+    fs::create_directories(root);
+
+    for (unsigned int n = 0; n < count; n++)
+    {
+      std::ostringstream dir;
+      dir << "d" << n / 100;
+      const fs::path path = root / dir.str();
+      if (n % 100 == 0)
+	fs::create_directories(path);
+
+      const bool html = uniform() < htmlRatio;
+      std::ostringstream name;
+      name << "doc" << n << (html ? ".html" : ".txt");
+      std::ofstream file((path / name.str()).native_file_string().c_str());
+      written += html ? writeHTML(file, size) : writeText(file, size);
+    }
+
+    return written;
+  }
+
+  /*!
+  ** Get a word of the vocabulary.
+  **
+  ** @param rank The rank of the word, 0 being the most frequent
+  **
+  ** @return The word
+  */
+  const std::string&
+  CorpusGenerator::getWord(const unsigned int rank) const
+  {
+    return _words[rank % _words.size()];
+  }
+
+  /*!
+  ** Get the number of distinct words.
+  **
+  ** @return The vocabulary size
+  */
+  unsigned int
+  CorpusGenerator::getVocabularySize() const
+  {
+    return _words.size();
+  }
+
+  /*!
+  ** Get the next pseudo random number. A xorshift is used rather than
+  ** rand(), so that the corpus is the same on every platform.
+  **
+  ** @return A pseudo random number
+  */
+  unsigned int
+  CorpusGenerator::random()
+  {
+    _state ^= _state << 13;
+    _state ^= _state >> 17;
+    _state ^= _state << 5;
+    return _state;
+  }
+
+  /*!
+  ** Get a pseudo random number in [0, 1).
+  **
+  ** @return A pseudo random number
+  */
+  double
+  CorpusGenerator::uniform()
+  {
+    return (random() & 0xFFFFFF) / 16777216.0;
+  }
+
+  /*!
+  ** Draw a word following the Zipf law.
+  **
+  ** @return The word
+  */
+  const std::string&
+  CorpusGenerator::nextWord()
+  {
+    std::vector<double>::const_iterator i =
+      std::lower_bound(_cumulative.begin(), _cumulative.end(), uniform());
+    if (i == _cumulative.end())
+      --i;
+    return _words[i - _cumulative.begin()];
+  }
+
+  /*!
+  ** Write a sentence, starting with a capital letter.
+  **
+  ** @param o Where to write
+  ** @param length Number of words
+  */
+  void
+  CorpusGenerator::writeSentence(std::ostream& o, const unsigned int length)
+  {
+    for (unsigned int i = 0; i < length; i++)
+    {
+      std::string word = nextWord();
+      if (i == 0)
+	word[0] = std::toupper(word[0]);
+      else
+	o << (random() % 12 == 0 ? ", " : " ");
+      o << word;
+    }
+    o << PUNCTUATION[random() % 5];
+  }
+
+  /*!
+  ** Write a text document, made of paragraphs.
+  **
+  ** @param o Where to write
+  ** @param size Approximative size, in bytes
+  **
+  ** @return The size written
+  */
+  unsigned int
+  CorpusGenerator::writeText(std::ostream& o, const unsigned int size)
+  {
+    std::ostringstream text;
+    while (text.tellp() < static_cast<std::streamoff>(size))
+    {
+      const unsigned int sentences = 2 + random() % 5;
+      for (unsigned int i = 0; i < sentences; i++)
+      {
+	writeSentence(text, 4 + random() % 16);
+	text << " ";
+      }
+      text << "\n\n";
+    }
+    o << text.str();
+
+    return text.str().size();
+  }
+
+  /*!
+  ** Write an HTML document, with all zones the indexer knows: title,
+  ** meta tags, headings, and a body with comments, scripts, images and
+  ** entities to skip.
+  **
+  ** @param o Where to write
+  ** @param size Approximative size, in bytes
+  **
+  ** @return The size written
+  */
+  unsigned int
+  CorpusGenerator::writeHTML(std::ostream& o, const unsigned int size)
+  {
+    std::ostringstream html;
+    html << "<html>\n<head>\n<title>";
+    writeSentence(html, 3 + random() % 5);
+    html << "</title>\n<meta name=\"keywords\" content=\"";
+    writeSentence(html, 3 + random() % 3);
+    html << "\">\n<meta name=\"description\" content=\"";
+    writeSentence(html, 8 + random() % 8);
+    html << "\">\n<style type=\"text/css\">p { margin: 0; }</style>\n"
+      "<script type=\"text/javascript\">var x = \"<p>\";</script>\n"
+      "</head>\n<body>\n";
+
+    while (html.tellp() < static_cast<std::streamoff>(size))
+    {
+      const unsigned int level = 1 + random() % 3;
+      html << "<h" << level << ">";
+      writeSentence(html, 2 + random() % 6);
+      html << "</h" << level << ">\n<!-- ";
+      writeSentence(html, 3);
+      html << " -->\n<p>";
+      const unsigned int sentences = 2 + random() % 5;
+      for (unsigned int i = 0; i < sentences; i++)
+      {
+	writeSentence(html, 4 + random() % 16);
+	if (random() % 4 == 0)
+	  html << " <b>" << nextWord() << "</b> &amp; <i>" << nextWord() << "</i>";
+	if (random() % 8 == 0)
+	  html << " <img src=\"a.png\" alt=\"" << nextWord() << "\">";
+	html << " ";
+      }
+      html << "</p>\n";
+    }
+    html << "</body>\n</html>\n";
+    o << html.str();
+
+    return html.str().size();
+  }
+}
@@ -0,0 +1,47 @@
+#ifndef CORPUSGENERATOR_HH_
+# define CORPUSGENERATOR_HH_
+
+# include <fstream>
+# include <string>
+# include <vector>
+
+namespace Bench
+{
+  /*!
+  ** Write a synthetic corpus of French text and HTML documents.
+  ** Words follow a Zipf law over a fixed vocabulary, so that a few
+  ** words are everywhere and most are rare, like in real documents.
+  ** The same seed always gives the same corpus.
+  */
+  class CorpusGenerator
+  {
+  public:
+    CorpusGenerator(const unsigned int seed,
+		    const unsigned int vocabularySize,
+		    const double exponent = 1.0);
+    ~CorpusGenerator();
+
+  public:
+    unsigned int generate(const std::string& dirname,
+			  const unsigned int count,
+			  const unsigned int size,
+			  const double htmlRatio);
+    const std::string& getWord(const unsigned int rank) const;
+    unsigned int getVocabularySize() const;
+
+  private:
+    unsigned int random();
+    double uniform();
+    const std::string& nextWord();
+    void writeSentence(std::ostream& o, const unsigned int length);
+    unsigned int writeText(std::ostream& o, const unsigned int size);
+    unsigned int writeHTML(std::ostream& o, const unsigned int size);
+
+  private:
+    std::vector<std::string>	_words;
+    std::vector<double>		_cumulative;
+    unsigned int		_state;
+  };
+}
+
+#endif /* !CORPUSGENERATOR_HH_ */
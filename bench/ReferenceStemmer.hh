@@ -0,0 +1,72 @@
+#ifndef REFERENCESTEMMER_HH_
+# define REFERENCESTEMMER_HH_
+
+# include "Stemmer.hh"
+# include <iostream>
+# include <boost/algorithm/string.hpp>
+# include <string>
+
+/*!
+** The french stemmer as it was before it worked in a stack buffer, kept
+** to check that the current one gives the same stems. Positions are
+** std::size_t, as this code was only correct with a 32-bit size_t.
+*/
+namespace Reference
+{
+  static const std::wstring VOWELS = L"aeiouyâàëéêèïîôûù";
+
+  class French : public Stemmer::Generic
+  {
+    typedef std::wstring::const_iterator citer;
+    typedef std::wstring::iterator iter;
+
+  public:
+    French();
+    virtual ~French();
+    virtual const std::string getStem(const std::string& word);
+
+  private:
+    static std::wstring widen(const std::string& s);
+    static std::string narrow(const std::wstring& ws);
+    void reset();
+    std::size_t getFirstVowelPos(const std::wstring& word);
+    std::size_t getLastVowelPos(const std::wstring& word);
+    bool isVowel(const wchar_t c);
+    void computeRV();
+    void computeR1();
+    void computeR2();
+    bool isInR1(const std::wstring& suffix);
+    bool isInR2(const std::wstring& suffix);
+    bool isInRV(const std::wstring& suffix);
+    std::size_t getSuffixPos(const std::wstring& suffix);
+    bool isSuffixe(const std::wstring& suffix);
+    std::size_t getSuffixPosInRV(const std::wstring& suffix);
+    bool isSuffixeInRV(const std::wstring& suffix);
+    bool replaceSuffixWith(const std::wstring& suffix, const std::wstring& with);
+    bool deleteIfInR1(const std::wstring& suffix);
+    bool deleteIfInR2(const std::wstring& suffix);
+    bool deleteIfInRV(const std::wstring& suffix);
+
+  private:
+    void applyConsonance();
+    bool step1StandardSuffixRemoval();
+    bool step2aDeleteVerbSuffixesBeginningWithI();
+    bool step2bDeleteOtherVerbSuffixes();
+    bool step3ReplaceResidualLetters();
+    void step4ReplaceResidualSuffixes();
+    void step5UnDouble();
+    void step6UnAccent();
+
+
+  private:
+    std::wstring	_original;
+    std::wstring	_stem;
+    std::wstring	_rv;
+    std::wstring	_r1;
+    std::wstring	_r2;
+  };
+}
+
+# include "ReferenceStemmer.hxx"
+
+#endif /* !REFERENCESTEMMER_HH_ */
@@ -0,0 +1,73 @@
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+#include "CorpusGenerator.hh"
+#include "Bench.hh"
+
+namespace opt = boost::program_options;
+
+/*!
+** Generate a synthetic corpus, then print what was written as JSON.
+**
+** @param argc Number of argument
+** @param argv Arguments
+**
+** @return If error occured
+*/
+int main(int argc, char** argv)
+{
+  try
+  {
+    opt::options_description desc("Allowed options");
+    desc.add_options()
+      ("help,h", "Produce help message.")
+      ("output,o", opt::value<std::string>()->default_value("documents"),
+       "Directory where the documents are written. Default is \"documents\".")
+      ("count,n", opt::value<unsigned int>()->default_value(1000),
+       "Number of documents. Default is 1000.")
+      ("size,s", opt::value<unsigned int>()->default_value(4096),
+       "Approximative size of a document, in bytes. Default is 4096.")
+      ("html-ratio,r", opt::value<double>()->default_value(0.3),
+       "Part of HTML documents, between 0 and 1. Default is 0.3.")
+      ("vocabulary,w", opt::value<unsigned int>()->default_value(20000),
+       "Number of distinct words. Default is 20000.")
+      ("seed", opt::value<unsigned int>()->default_value(42),
+       "Seed of the generator, the same seed gives the same corpus. Default is 42.")
+      ;
+
+    opt::variables_map vm;
+    opt::store(opt::parse_command_line(argc, argv, desc), vm);
+    opt::notify(vm);
+    if (vm.count("help"))
+    {
+      std::cout << desc << std::endl;
+      return 1;
+    }
+
+    const unsigned int count = vm["count"].as<unsigned int>();
+    Bench::CorpusGenerator generator(vm["seed"].as<unsigned int>(),
+				     vm["vocabulary"].as<unsigned int>());
+    const double start = Bench::now();
+    const unsigned int bytes = generator.generate(vm["output"].as<std::string>(),
+						  count,
+						  vm["size"].as<unsigned int>(),
+						  vm["html-ratio"].as<double>());
+    const double elapsed = Bench::now() - start;
+
+    Bench::Report report("corpus");
+    report.add("output", vm["output"].as<std::string>());
+    report.add("seed", vm["seed"].as<unsigned int>());
+    report.add("vocabulary", generator.getVocabularySize());
+    report.add("docs", count);
+    report.add("bytes", bytes);
+    report.add("seconds", elapsed);
+    report.print();
+  }
+  catch (opt::error& option)
+  {
+    std::cerr << "Error :  " << option.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
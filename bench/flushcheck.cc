@@ -0,0 +1,167 @@
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/convenience.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <unistd.h>
+#include <sstream>
+#include "Database.hh"
+#include "SQLiteException.hh"
+#include "SegmentManifest.hh"
+#include "ScorerStatic.hh"
+#include "Configuration.hh"
+#include "Bench.hh"
+
+namespace opt = boost::program_options;
+namespace fs = boost::filesystem;
+
+namespace
+{
+  // Number of distinct terms of each document
+  static const unsigned int TERMS = 1000;
+
+  /*!
+  ** Count the segment files of a directory.
+  **
+  ** @param path The directory
+  **
+  ** @return The number of files
+  */
+  unsigned int countSegments(const fs::path& path)
+  {
+    unsigned int count = 0;
+    for (fs::directory_iterator i(path); i != fs::directory_iterator(); ++i)
+      if (fs::extension(i->path()) == ".seg")
+	count++;
+
+    return count;
+  }
+}
+
+/*!
+** Add more postings than a segment buffers in a single transaction of a
+** new segment database, so that committing it flushes the writer, then
+** check that each posting was written once: the segments are as many as
+** the flushes, and each document is found once.
+**
+** @param argc Number of argument
+** @param argv Arguments
+**
+** @return If error occured, or if the postings were written again
+*/
+int main(int argc, char** argv)
+{
+  try
+  {
+    opt::options_description desc("Allowed options");
+    desc.add_options()
+      ("help,h", "Produce help message.")
+      ("database-location,d", opt::value<std::string>()->default_value("flushcheck.data"),
+       "Database to create, deleted first. Default is \"flushcheck.data\".")
+      ("postings,p", opt::value<unsigned int>()->
+       default_value(Index::Database::FLUSH_SIZE / 2 * 3),
+       "Number of postings added. Default is one and a half flush.")
+      ;
+
+    opt::variables_map vm;
+    opt::store(opt::parse_command_line(argc, argv, desc), vm);
+    opt::notify(vm);
+    if (vm.count("help"))
+    {
+      std::cout << desc << std::endl;
+      return 1;
+    }
+
+    Configuration& cfg = Configuration::getInstance();
+    cfg.setDatabaseName(vm["database-location"].as<std::string>());
+    cfg.setStorageEngine("segment");
+    const fs::path segments(cfg.getDatabaseName() + ".segments", fs::native);
+
+    // Always start from an empty database
+    fs::remove(fs::path(cfg.getDatabaseName(), fs::native));
+    fs::remove_all(segments);
+
+    // A flush committing again and again would never end
+    alarm(600);
+
+    const unsigned int docs =
+      (vm["postings"].as<unsigned int>() + TERMS - 1) / TERMS;
+    Index::Database& db = Index::Database::getInstance();
+    db.open(cfg.getDatabaseName());
+    const double start = Bench::now();
+    db.beginTransaction();
+    for (unsigned int d = 0; d < docs; d++)
+    {
+      std::ostringstream filename;
+      filename << "/flushcheck/" << d;
+      Index::Column::Document doc;
+      doc.id = 0;
+      doc.filename = filename.str();
+      doc.type = Index::File::TEXT;
+      doc.hash = "";
+      doc.date = 0;
+      doc.length = TERMS;
+      doc.size = 0;
+      doc.mtime = 0;
+      doc.inode = 0;
+      db.addOrUpdateDocument(doc);
+      doc = db.getDocumentByFilename(doc.filename);
+
+      Index::Column::Word word;
+      word.idDocument = doc.id;
+      word.idTerm = 0;
+      word.weight = 1;
+      word.realCount = 1;
+      word.stemCount = 1;
+      word.score = 1;
+      std::fill(word.fieldCounts, word.fieldCounts + Index::Field::COUNT, 0);
+      word.fieldCounts[Index::Field::BODY] = 1;
+      for (unsigned int t = 0; t < TERMS; t++)
+      {
+	std::ostringstream term;
+	term << "t" << t;
+	db.addWord(term.str(), term.str(), word, doc.length);
+      }
+    }
+    db.endTransaction();
+    const double elapsed = Bench::now() - start;
+    db.close();
+
+    // Then count what was written, merged or not
+    Index::SegmentManifest manifest(segments.native_file_string());
+    Index::SegmentManifest::idArray ids;
+    manifest.getSegments(ids);
+    const unsigned int files = countSegments(segments);
+
+    db.open(cfg.getDatabaseName());
+    Search::StaticScorer scorer;
+    PostingList postings;
+    db.getPostings("t0", scorer, postings);
+    const unsigned int found = postings.ids.size();
+    db.close();
+
+    const unsigned int total = docs * TERMS;
+    const unsigned int flushes = total / Index::Database::FLUSH_SIZE + 1;
+    Bench::Report report("flushcheck");
+    report.add("docs", docs);
+    report.add("postings", total);
+    report.add("flushes", flushes);
+    report.add("segments", static_cast<unsigned int>(ids.size()));
+    report.add("segment_files", files);
+    report.add("found", found);
+    report.add("seconds", elapsed);
+    report.print();
+
+    return ids.size() <= flushes && files == ids.size() && found == docs ? 0 : 1;
+  }
+  catch (opt::error& option)
+  {
+    std::cerr << "Error :  " << option.what() << std::endl;
+    return 2;
+  }
+  catch (SQLite::Exception& ex)
+  {
+    std::cerr << ex.errorMessage() << std::endl;
+    return 3;
+  }
+}
@@ -0,0 +1,159 @@
+#include <boost/filesystem/operations.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/positional_options.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <cstdio>
+#include "Database.hh"
+#include "SQLiteException.hh"
+#include "Indexer.hh"
+#include "Configuration.hh"
+#include "Bench.hh"
+
+namespace opt = boost::program_options;
+namespace fs = boost::filesystem;
+
+namespace
+{
+  /*!
+  ** Get the size of all files under a directory.
+  **
+  ** @param path The directory
+  **
+  ** @return The size, in bytes
+  */
+  double directorySize(const fs::path& path)
+  {
+    double size = 0.0;
+    for (fs::recursive_directory_iterator i(path);
+	 i != fs::recursive_directory_iterator(); ++i)
+      if (fs::is_regular(i->status()))
+	size += fs::file_size(i->path());
+
+    return size;
+  }
+}
+
+/*!
+** Index a corpus in a new database, then print the throughput as JSON.
+**
+** @param argc Number of argument
+** @param argv Arguments
+**
+** @return If error occured
+*/
+int main(int argc, char** argv)
+{
+  try
+  {
+    opt::options_description desc("Allowed options");
+    desc.add_options()
+      ("help,h", "Produce help message.")
+      ("database-location,d", opt::value<std::string>()->default_value("bench.data"),
+       "Database to create, deleted first. Default is \"bench.data\".")
+      ("stemmer-type,s", opt::value<std::string>()->default_value("frenchquick"),
+       "Type of stemmer (french or frenchquick). Default is frenchquick.")
+      ("stopwords-file,t", opt::value<std::string>()->default_value("../StopWordList.txt"),
+       "File where the stop words are. Default is \"../StopWordList.txt\".")
+      ("jobs,j", opt::value<unsigned int>()->default_value(1),
+       "Number of threads parsing documents. Default is 1.")
+      ("stem-cache,c", opt::value<unsigned int>()->default_value(65536),
+       "Number of stems remembered. Default is 65536, 0 disables it.")
+      ;
+    opt::options_description hidden("Hidden options");
+    hidden.add_options()
+      ("corpus", opt::value<std::string>()->default_value("documents"), "hidden")
+      ;
+    opt::options_description cmdLine;
+    cmdLine.add(desc).add(hidden);
+    opt::positional_options_description p;
+    p.add("corpus", 1);
+
+    opt::variables_map vm;
+    opt::store(opt::command_line_parser(argc, argv).options(cmdLine).
+	       positional(p).run(), vm);
+    opt::notify(vm);
+    if (vm.count("help"))
+    {
+      std::cout << "Usage : [--database-location] [--stemmer-type] "
+	"[--stopwords-file] [--jobs] [--stem-cache] corpus\n" << desc << std::endl;
+      return 1;
+    }
+
+    Configuration& cfg = Configuration::getInstance();
+    cfg.setDatabaseName(vm["database-location"].as<std::string>());
+    cfg.setStemmerName(vm["stemmer-type"].as<std::string>());
+    cfg.setStopwordFilename(vm["stopwords-file"].as<std::string>());
+    cfg.setJobs(vm["jobs"].as<unsigned int>());
+    cfg.setStemCache(vm["stem-cache"].as<unsigned int>());
+
+    const fs::path corpus =
+      fs::system_complete(fs::path(vm["corpus"].as<std::string>(), fs::native));
+    if (!fs::is_directory(corpus))
+    {
+      std::cerr << "Not a directory: " << corpus.native_file_string() << std::endl;
+      return 2;
+    }
+
+    // Always start from an empty database
+    std::remove(cfg.getDatabaseName().c_str());
+    Index::Database& db = Index::Database::getInstance();
+    db.open(cfg.getDatabaseName());
+
+    double start = Bench::now();
+    {
+      Index::Indexer idx;
+      idx.setJobs(cfg.getJobs());
+      idx.indexDirectory(corpus.native_file_string());
+    }
+    const double elapsed = Bench::now() - start;
+
+    // Then index again, nothing changed so every document is skipped
+    start = Bench::now();
+    {
+      Index::Indexer idx;
+      idx.setJobs(cfg.getJobs());
+      idx.indexDirectory(corpus.native_file_string());
+    }
+    const double unchanged = Bench::now() - start;
+
+    const std::list<Index::Column::Document> docs =
+      db.getDocumentsUnder(corpus.native_file_string());
+    unsigned int tokens = 0;
+    for (std::list<Index::Column::Document>::const_iterator i = docs.begin();
+	 i != docs.end(); ++i)
+      tokens += i->length;
+    db.close();
+
+    const double bytes = directorySize(corpus);
+    const unsigned int count = docs.size();
+    Bench::Report report("index");
+    report.add("corpus", corpus.native_file_string());
+    report.add("stemmer", cfg.getStemmerName());
+    report.add("jobs", cfg.getJobs());
+    report.add("stem_cache", cfg.getStemCache());
+    report.add("docs", count);
+    report.add("bytes", bytes);
+    report.add("tokens", tokens);
+    report.add("seconds", elapsed);
+    report.add("docs_per_s", count / elapsed);
+    report.add("mb_per_s", bytes / (1024.0 * 1024.0) / elapsed);
+    report.add("tokens_per_s", tokens / elapsed);
+    report.add("unchanged_seconds", unchanged);
+    report.add("database_bytes",
+	       static_cast<double>(fs::file_size(cfg.getDatabaseName())));
+    report.print();
+  }
+  catch (opt::error& option)
+  {
+    std::cerr << "Error :  " << option.what() << std::endl;
+    return 2;
+  }
+  catch (SQLite::Exception& ex)
+  {
+    std::cerr << ex.errorMessage() << std::endl;
+    return 3;
+  }
+
+  return 0;
+}
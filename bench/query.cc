@@ -0,0 +1,188 @@
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <map>
+#include "Database.hh"
+#include "SQLiteException.hh"
+#include "Searcher.hh"
+#include "ResultCache.hh"
+#include "Configuration.hh"
+#include "CorpusGenerator.hh"
+#include "Bench.hh"
+
+namespace opt = boost::program_options;
+
+namespace
+{
+  typedef std::pair<std::string, std::string> query;
+
+  // Rank of the first word used in queries, the most frequent ones
+  // being stop words
+  static const unsigned int FIRST_RANK = 40;
+
+  /*!
+  ** Pick a word of the corpus vocabulary usable as a query term, ie
+  ** lowercase ASCII, as the indexer stores it.
+  **
+  ** @param generator The generator of the corpus
+  ** @param n The index of the pick
+  ** @param lo The lowest rank
+  ** @param hi The highest rank
+  **
+  ** @return The word
+  */
+  std::string pick(const Bench::CorpusGenerator& generator,
+		   unsigned int n, const unsigned int lo, unsigned int hi)
+  {
+    if (hi > generator.getVocabularySize())
+      hi = generator.getVocabularySize();
+    for (;; n++)
+    {
+      const std::string& word =
+	generator.getWord(lo + (n * 2654435761u) % (hi - lo));
+      bool ok = true;
+      for (std::string::const_iterator c = word.begin(); ok && c != word.end(); ++c)
+	ok = *c >= 'a' && *c <= 'z';
+      if (ok)
+	return word;
+    }
+  }
+
+  /*!
+  ** Build the query mix: each kind of request the searcher handles.
+  **
+  ** @param generator The generator of the corpus
+  ** @param runs Number of queries of each kind
+  **
+  ** @return The kind and the text of each query
+  */
+  std::vector<query> buildQueries(const Bench::CorpusGenerator& generator,
+				  const unsigned int runs)
+  {
+    std::vector<query> queries;
+    for (unsigned int i = 0; i < runs; i++)
+    {
+      const std::string frequent = pick(generator, i, FIRST_RANK, 200);
+      const std::string common = pick(generator, i + 7, 200, 2000);
+      const std::string rare = pick(generator, i + 13, 2000, 20000);
+
+      queries.push_back(query("frequent", frequent));
+      queries.push_back(query("rare", rare));
+      queries.push_back(query("and", frequent + " & " + common));
+      queries.push_back(query("or", frequent + " | " + common + " | " + rare));
+      queries.push_back(query("not", frequent + " -" + common));
+      queries.push_back(query("nested", "(" + frequent + " | " + rare + ") & " + common));
+    }
+
+    return queries;
+  }
+}
+
+/*!
+** Run a query mix on an indexed corpus, then print the latencies as JSON.
+**
+** @param argc Number of argument
+** @param argv Arguments
+**
+** @return If error occured
+*/
+int main(int argc, char** argv)
+{
+  try
+  {
+    opt::options_description desc("Allowed options");
+    desc.add_options()
+      ("help,h", "Produce help message.")
+      ("database-location,d", opt::value<std::string>()->default_value("bench.data"),
+       "Database of the indexed corpus. Default is \"bench.data\".")
+      ("vocabulary,w", opt::value<unsigned int>()->default_value(20000),
+       "Number of distinct words of the corpus. Default is 20000.")
+      ("runs,r", opt::value<unsigned int>()->default_value(50),
+       "Number of queries of each kind. Default is 50.")
+      ("limit,l", opt::value<unsigned int>()->default_value(0),
+       "Only find the given number of best documents. Default is 0, no limit.")
+      ("scorer", opt::value<std::string>()->default_value("static"),
+       "How found documents are ranked: static or bm25. Default is static.")
+      ("cached,c", "Keep the search cache between queries, to measure hits.")
+      ;
+
+    opt::variables_map vm;
+    opt::store(opt::parse_command_line(argc, argv, desc), vm);
+    opt::notify(vm);
+    if (vm.count("help"))
+    {
+      std::cout << desc << std::endl;
+      return 1;
+    }
+
+    Configuration& cfg = Configuration::getInstance();
+    cfg.setDatabaseName(vm["database-location"].as<std::string>());
+    cfg.setLimit(vm["limit"].as<unsigned int>());
+    cfg.setScorerName(vm["scorer"].as<std::string>());
+    if (cfg.getScorerName() != "bm25" && cfg.getScorerName() != "static")
+    {
+      std::cerr << cfg.getScorerName() << " : Unknow scorer" << std::endl;
+      return 2;
+    }
+    const bool cached = vm.count("cached") > 0;
+
+    Bench::CorpusGenerator generator(1, vm["vocabulary"].as<unsigned int>());
+    const std::vector<query> queries =
+      buildQueries(generator, vm["runs"].as<unsigned int>());
+
+    Index::Database& db = Index::Database::getInstance();
+    Search::ResultCache& cache = Search::ResultCache::getInstance();
+    db.open(cfg.getDatabaseName());
+    db.clearSearchCache();
+
+    // With the cache kept, a first pass fills it, and only the second
+    // one is measured
+    std::map<std::string, std::vector<double> > latencies;
+    std::vector<double> all;
+    double found = 0.0;
+    for (unsigned int pass = cached ? 0 : 1; pass < 2; pass++)
+      for (std::vector<query>::const_iterator i = queries.begin(); i != queries.end(); ++i)
+      {
+	if (!cached)
+	{
+	  db.clearSearchCache();
+	  cache.clear();
+	}
+
+	Search::Searcher searcher;
+	const double start = Bench::now();
+	searcher.search(i->second, cfg.getLimit());
+	const double elapsed = Bench::now() - start;
+
+	if (pass == 0)
+	  continue;
+	latencies[i->first].push_back(elapsed);
+	all.push_back(elapsed);
+	found += searcher.getDocumentList().size();
+      }
+    db.close();
+
+    Bench::Report report("query");
+    report.add("database", cfg.getDatabaseName());
+    report.add("limit", cfg.getLimit());
+    report.add("cached", std::string(cached ? "yes" : "no"));
+    report.add("found_mean", queries.empty() ? 0.0 : found / queries.size());
+    report.addLatencies("", all);
+    for (std::map<std::string, std::vector<double> >::iterator i = latencies.begin();
+	 i != latencies.end(); ++i)
+      report.addLatencies(i->first + "_", i->second);
+    report.print();
+  }
+  catch (opt::error& option)
+  {
+    std::cerr << "Error :  " << option.what() << std::endl;
+    return 2;
+  }
+  catch (SQLite::Exception& ex)
+  {
+    std::cerr << ex.errorMessage() << std::endl;
+    return 3;
+  }
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <fstream>
+#include "StemmerFrench.hh"
+#include "ReferenceStemmer.hh"
+#include "Bench.hh"
+
+namespace opt = boost::program_options;
+
+namespace
+{
+  // Number of mismatching words printed
+  static const unsigned int MAX_PRINTED = 20;
+}
+
+/*!
+** Stem each word of a list with the current french stemmer and with
+** the reference one, then print the words stemmed differently, and the
+** counts as JSON.
+**
+** @param argc Number of argument
+** @param argv Arguments
+**
+** @return If error occured, or if a stem differs
+*/
+int main(int argc, char** argv)
+{
+  try
+  {
+    opt::options_description desc("Allowed options");
+    desc.add_options()
+      ("help,h", "Produce help message.")
+      ("words,w", opt::value<std::string>()->default_value("french-words.txt"),
+       "List of words, one per line. Default is \"french-words.txt\".")
+      ;
+
+    opt::variables_map vm;
+    opt::store(opt::parse_command_line(argc, argv, desc), vm);
+    opt::notify(vm);
+    if (vm.count("help"))
+    {
+      std::cout << desc << std::endl;
+      return 1;
+    }
+
+    const std::string filename = vm["words"].as<std::string>();
+    std::ifstream file(filename.c_str());
+    if (!file)
+    {
+      std::cerr << filename << " : Can't read the words" << std::endl;
+      return 2;
+    }
+    std::vector<std::string> words;
+    std::string word;
+    while (std::getline(file, word))
+      if (!word.empty())
+	words.push_back(word);
+
+    Stemmer::French stemmer;
+    Reference::French reference;
+    unsigned int mismatches = 0;
+    const double start = Bench::now();
+    for (std::vector<std::string>::const_iterator i = words.begin();
+	 i != words.end(); ++i)
+    {
+      const std::string expected = reference.getStem(*i);
+      const std::string stem = stemmer.getStem(*i);
+      if (stem == expected)
+	continue;
+      if (mismatches++ < MAX_PRINTED)
+	std::cerr << *i << " : " << stem << " instead of " << expected << std::endl;
+    }
+    const double elapsed = Bench::now() - start;
+
+    Bench::Report report("stemcheck");
+    report.add("words", static_cast<unsigned int>(words.size()));
+    report.add("mismatches", mismatches);
+    report.add("seconds", elapsed);
+    report.print();
+
+    return mismatches == 0 ? 0 : 1;
+  }
+  catch (opt::error& option)
+  {
+    std::cerr << "Error :  " << option.what() << std::endl;
+    return 2;
+  }
+}
@@ -0,0 +1,134 @@
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <fstream>
+#include "StemmerFrenchQuick.hh"
+#include "Bench.hh"
+
+namespace opt = boost::program_options;
+
+namespace
+{
+  typedef std::vector<std::string> Words;
+
+  /*!
+  ** Stem the words again and again with a stemmer of its own, starting
+  ** at a different word in each thread, and count the stems that differ
+  ** from the expected ones.
+  **
+  ** @param words Words to stem
+  ** @param expected Stems given by a single thread
+  ** @param first Index of the first word stemmed
+  ** @param rounds Number of times the whole list is stemmed
+  ** @param mismatches Where the number of differing stems is stored
+  */
+  void stem(const Words& words, const Words& expected, unsigned int first,
+	    unsigned int rounds, unsigned int* mismatches)
+  {
+    Stemmer::FrenchQuick stemmer;
+    unsigned int count = 0;
+    for (unsigned int r = 0; r < rounds; ++r)
+      for (unsigned int n = 0, i = first; n < words.size();
+	   ++n, i = (i + 1) % words.size())
+	if (stemmer.getStem(words[i]) != expected[i])
+	  ++count;
+    *mismatches = count;
+  }
+}
+
+/*!
+** Stem a list of words in several threads at once, each with its own
+** quick french stemmer, and check every stem against the ones of a
+** single-threaded pass. Print the counts as JSON.
+**
+** @param argc Number of argument
+** @param argv Arguments
+**
+** @return If error occured, or if a stem differs
+*/
+int main(int argc, char** argv)
+{
+  try
+  {
+    opt::options_description desc("Allowed options");
+    desc.add_options()
+      ("help,h", "Produce help message.")
+      ("words,w", opt::value<std::string>()->default_value("french-words.txt"),
+       "List of words, one per line. Default is \"french-words.txt\".")
+      ("threads,j", opt::value<unsigned int>()->default_value(8),
+       "Number of stemming threads. Default is 8.")
+      ("rounds,r", opt::value<unsigned int>()->default_value(20),
+       "Number of times each thread stems the list. Default is 20.")
+      ;
+
+    opt::variables_map vm;
+    opt::store(opt::parse_command_line(argc, argv, desc), vm);
+    opt::notify(vm);
+    if (vm.count("help"))
+    {
+      std::cout << desc << std::endl;
+      return 1;
+    }
+
+    const std::string filename = vm["words"].as<std::string>();
+    std::ifstream file(filename.c_str());
+    if (!file)
+    {
+      std::cerr << filename << " : Can't read the words" << std::endl;
+      return 2;
+    }
+    Words words;
+    std::string word;
+    while (std::getline(file, word))
+      if (!word.empty())
+	words.push_back(word);
+    if (words.empty())
+    {
+      std::cerr << filename << " : No word to stem" << std::endl;
+      return 2;
+    }
+
+    Words expected;
+    {
+      Stemmer::FrenchQuick stemmer;
+      for (Words::const_iterator i = words.begin(); i != words.end(); ++i)
+	expected.push_back(stemmer.getStem(*i));
+    }
+
+    const unsigned int nthreads = vm["threads"].as<unsigned int>();
+    const unsigned int rounds = vm["rounds"].as<unsigned int>();
+    std::vector<unsigned int> mismatches(nthreads, 0);
+    const double start = Bench::now();
+    {
+      boost::thread_group threads;
+      for (unsigned int t = 0; t < nthreads; ++t)
+	threads.create_thread(boost::bind(&stem, boost::cref(words),
+					  boost::cref(expected),
+					  t * words.size() / nthreads, rounds,
+					  &mismatches[t]));
+      threads.join_all();
+    }
+    const double elapsed = Bench::now() - start;
+
+    unsigned int total = 0;
+    for (unsigned int t = 0; t < nthreads; ++t)
+      total += mismatches[t];
+
+    Bench::Report report("stemstress");
+    report.add("threads", nthreads);
+    report.add("words", static_cast<unsigned int>(words.size()));
+    report.add("stems", static_cast<unsigned int>(words.size()) * rounds * nthreads);
+    report.add("mismatches", total);
+    report.add("seconds", elapsed);
+    report.print();
+
+    return total == 0 ? 0 : 1;
+  }
+  catch (opt::error& option)
+  {
+    std::cerr << "Error :  " << option.what() << std::endl;
+    return 2;
+  }
+}
@@ -1,32 +1,192 @@
+#include <algorithm>
 #include "ArrayUtils.hh"
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+namespace
+{
+  // Above this size ratio, the small list is searched in the large one
+  // by galloping, instead of walking both lists.
+  static const unsigned int GALLOP_RATIO = 32;
+}
+
+/*!
+** Intersect two posting lists. Scores of documents found in both lists
+** are summed.
+**
+** @param left The first list
+** @param right The second list
+** @param dst Where to store the result, must not be one of the operands
+*/
+void
+ArrayUtils::intersect(const PostingList& left, const PostingList& right,
+		      PostingList& dst)
+{
+  clear(dst);
+  if (left.ids.empty() || right.ids.empty())
+    return;
+
+  if (left.ids.size() * GALLOP_RATIO < right.ids.size())
+    intersectGalloping(left, right, dst);
+  else
+    if (right.ids.size() * GALLOP_RATIO < left.ids.size())
+      intersectGalloping(right, left, dst);
+    else
+      intersectBlocks(left, right, dst);
+}
 
 /*!
-** Merge to array, avoiding redundancy
+** Unite two posting lists, with a linear merge. Scores of documents
+** found in both lists are summed.
 **
-** @param dst Destination array
-** @param src Array to merge
+** @param left The first list
+** @param right The second list
+** @param dst Where to store the result, must not be one of the operands
 */
 void
-ArrayUtils::arrayMerge(array& dst, const array& src)
+ArrayUtils::unite(const PostingList& left, const PostingList& right,
+		  PostingList& dst)
 {
-  for (citer i = src.begin(); i != src.end(); ++i)
-    dst.push_back(*i);
-  dst.unique();
+  const unsigned int leftSize = left.ids.size();
+  const unsigned int rightSize = right.ids.size();
+  unsigned int i = 0;
+  unsigned int j = 0;
+
+  clear(dst);
+  dst.ids.reserve(leftSize + rightSize);
+  dst.scores.reserve(leftSize + rightSize);
+  while (i < leftSize && j < rightSize)
+  {
+    if (left.ids[i] < right.ids[j])
+    {
+      append(dst, left.ids[i], left.scores[i]);
+      i++;
+    }
+    else
+      if (right.ids[j] < left.ids[i])
+      {
+	append(dst, right.ids[j], right.scores[j]);
+	j++;
+      }
+      else
+      {
+	append(dst, left.ids[i], left.scores[i] + right.scores[j]);
+	i++;
+	j++;
+      }
+  }
+  dst.ids.insert(dst.ids.end(), left.ids.begin() + i, left.ids.end());
+  dst.scores.insert(dst.scores.end(), left.scores.begin() + i, left.scores.end());
+  dst.ids.insert(dst.ids.end(), right.ids.begin() + j, right.ids.end());
+  dst.scores.insert(dst.scores.end(), right.scores.begin() + j, right.scores.end());
 }
 
 /*!
-** Filter the array, deleting all entry in dst from src.
+** Keep the documents of the first list which are not in the second one.
+** Scores of the first list are kept.
 **
-** @param dst Array to filter
-** @param src The filter
+** @param left The list to filter
+** @param right The documents to delete
+** @param dst Where to store the result, must not be one of the operands
 */
 void
-ArrayUtils::arrayFilter(array& dst, const array&)
+ArrayUtils::subtract(const PostingList& left, const PostingList& right,
+		     PostingList& dst)
 {
-  for (citer i = dst.begin(); i != dst.end(); ++i)
+  const unsigned int leftSize = left.ids.size();
+  const unsigned int rightSize = right.ids.size();
+  unsigned int j = 0;
+
+  clear(dst);
+  for (unsigned int i = 0; i < leftSize; i++)
+  {
+    const unsigned int id = left.ids[i];
+    j = gallop(right.ids, j, id);
+    if (j >= rightSize || right.ids[j] != id)
+      append(dst, id, left.scores[i]);
+  }
+}
+
+/*!
+** Intersect a small posting list with a much larger one, looking for
+** each id of the small one in the large one by galloping.
+**
+** @param small The smallest list
+** @param large The largest list
+** @param dst Where to store the result
+*/
+void
+ArrayUtils::intersectGalloping(const PostingList& small, const PostingList& large,
+			       PostingList& dst)
+{
+  const unsigned int smallSize = small.ids.size();
+  const unsigned int largeSize = large.ids.size();
+  unsigned int j = 0;
+
+  for (unsigned int i = 0; i < smallSize && j < largeSize; i++)
+  {
+    j = gallop(large.ids, j, small.ids[i]);
+    if (j < largeSize && large.ids[j] == small.ids[i])
+      append(dst, small.ids[i], small.scores[i] + large.scores[j]);
+  }
+}
+
+/*!
+** Intersect two posting lists of similar sizes. Each id of the left list
+** is compared to a block of four ids of the right list at once, when SSE2
+** is available. Blocks entirely lesser than the current id are skipped.
+**
+** @param left The first list
+** @param right The second list
+** @param dst Where to store the result
+*/
+void
+ArrayUtils::intersectBlocks(const PostingList& left, const PostingList& right,
+			    PostingList& dst)
+{
+  const unsigned int leftSize = left.ids.size();
+  const unsigned int rightSize = right.ids.size();
+  unsigned int i = 0;
+  unsigned int j = 0;
+
+#ifdef __SSE2__
+  // All ids of right before j are lesser than left.ids[i]
+  const unsigned int* rightIds = &right.ids[0];
+  while (i < leftSize && j + 4 <= rightSize)
+  {
+    const unsigned int id = left.ids[i];
+    if (rightIds[j + 3] < id)
+    {
+      j += 4;
+      continue;
+    }
+
+    const __m128i block =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(rightIds + j));
+    const int mask = _mm_movemask_epi8(_mm_cmpeq_epi32(block, _mm_set1_epi32(static_cast<int>(id))));
+    if (mask != 0)
+    {
+      const unsigned int k = j + __builtin_ctz(mask) / 4;
+      append(dst, id, left.scores[i] + right.scores[k]);
+      j = k + 1;
+    }
+    i++;
+  }
+#endif
+
+  while (i < leftSize && j < rightSize)
   {
-    // FIXME
-    //     if (src.find(*i))
-    //       dst.erase(*i);
+    if (left.ids[i] < right.ids[j])
+      i++;
+    else
+      if (right.ids[j] < left.ids[i])
+	j++;
+      else
+      {
+	append(dst, left.ids[i], left.scores[i] + right.scores[j]);
+	i++;
+	j++;
+      }
   }
 }
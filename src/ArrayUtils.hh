@@ -2,17 +2,45 @@
 # define ARRAYUTILS_HH_
 
 # include "Column.hh"
-# include <list>
+# include <cassert>
+# include <algorithm>
+# include <vector>
+
+/*!
+** A posting list: documents sorted by id, with their score.
+** Ids and scores are kept in two arrays, so that ids can be compared
+** several at a time.
+*/
+struct PostingList
+{
+  std::vector<unsigned int>	ids;
+  std::vector<double>		scores;
+};
 
 class ArrayUtils
 {
-  typedef std::list< ::Index::Column::DocumentResult> array;
-  typedef array::iterator iter;
-  typedef array::const_iterator citer;
+  typedef std::vector<unsigned int> idArray;
 
 public:
-  static void arrayMerge(array& dst, const array& src);
-  static void arrayFilter(array& dst, const array& src);
+  static void append(PostingList& dst, const unsigned int id, const double score);
+  static void clear(PostingList& dst);
+  static void swap(PostingList& left, PostingList& right);
+  static void intersect(const PostingList& left, const PostingList& right,
+			PostingList& dst);
+  static void unite(const PostingList& left, const PostingList& right,
+		    PostingList& dst);
+  static void subtract(const PostingList& left, const PostingList& right,
+		       PostingList& dst);
+  static unsigned int gallop(const idArray& ids, unsigned int from,
+			     const unsigned int id);
+
+private:
+  static void intersectGalloping(const PostingList& small, const PostingList& large,
+				 PostingList& dst);
+  static void intersectBlocks(const PostingList& left, const PostingList& right,
+			      PostingList& dst);
 };
 
+# include "ArrayUtils.hxx"
+
 #endif /* !ARRAYUTILS_HH_ */
@@ -0,0 +1,70 @@
+/*!
+** Add a document at the end of a posting list.
+** Its id must be greater than all the ids of the list.
+**
+** @param dst The posting list
+** @param id The document id
+** @param score The document score
+*/
+inline void
+ArrayUtils::append(PostingList& dst, const unsigned int id, const double score)
+{
+  assert(dst.ids.empty() || dst.ids.back() < id);
+  dst.ids.push_back(id);
+  dst.scores.push_back(score);
+}
+
+/*!
+** Empty a posting list.
+**
+** @param dst The posting list
+*/
+inline void
+ArrayUtils::clear(PostingList& dst)
+{
+  dst.ids.clear();
+  dst.scores.clear();
+}
+
+/*!
+** Exchange the content of two posting lists, without copying it.
+**
+** @param left The first list
+** @param right The second list
+*/
+inline void
+ArrayUtils::swap(PostingList& left, PostingList& right)
+{
+  left.ids.swap(right.ids);
+  left.scores.swap(right.scores);
+}
+
+/*!
+** Find the first position, starting at from, whose id is not lesser than
+** the given one. Steps are doubled until the id is passed, then the last
+** step is searched by dichotomy, so it costs log(distance).
+**
+** @param ids The sorted ids
+** @param from Where to begin
+** @param id The id to look for
+**
+** @return The found position, or ids.size()
+*/
+inline unsigned int
+ArrayUtils::gallop(const idArray& ids, unsigned int from, const unsigned int id)
+{
+  const unsigned int size = ids.size();
+  unsigned int step = 1;
+  unsigned int to = from;
+
+  while (to < size && ids[to] < id)
+  {
+    from = to + 1;
+    to += step;
+    step *= 2;
+  }
+  if (to > size)
+    to = size;
+
+  return std::lower_bound(ids.begin() + from, ids.begin() + to, id) - ids.begin();
+}
@@ -0,0 +1,135 @@
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "Client.hh"
+#include "Server.hh"
+
+namespace Search
+{
+  /*!
+  ** Construct a client, not connected yet.
+  **
+  ** @param socketName The path of the Unix socket, or the TCP port
+  */
+  Client::Client(const std::string& socketName)
+    : _socketName(socketName), _fd(-1)
+  {
+  }
+
+  /*!
+  ** Destruct a client, closing its connection.
+  */
+  Client::~Client()
+  {
+    if (_fd >= 0)
+      close(_fd);
+  }
+
+  /*!
+  ** Connect to the server.
+  **
+  ** @return If the server accepted the connection
+  */
+  bool
+  Client::connect()
+  {
+    struct sockaddr_storage address;
+    socklen_t length;
+    const int family = Server::getAddress(_socketName, address, length);
+    if (family == AF_UNSPEC)
+    {
+      std::cerr << _socketName << " : Invalid socket name" << std::endl;
+      return false;
+    }
+
+    _fd = socket(family, SOCK_STREAM, 0);
+    if (_fd < 0 ||
+	::connect(_fd, reinterpret_cast<struct sockaddr*>(&address), length) != 0)
+    {
+      std::cerr << _socketName << " : " << strerror(errno) << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  /*!
+  ** Send a request, then display the answer of the server. A request
+  ** is a single line, so its line ends are sent as spaces.
+  **
+  ** @param request The document search request
+  ** @param k The maximum number of documents wanted, or 0 for no limit
+  ** @param out Where to display the documents found
+  ** @param err Where to display the error of the server
+  **
+  ** @return If the server answered
+  */
+  bool
+  Client::search(const std::string& request, const unsigned int k,
+		 std::ostream& out, std::ostream& err)
+  {
+    std::ostringstream line;
+    line << k << ' ';
+    for (std::string::const_iterator i = request.begin(); i != request.end(); ++i)
+      line << (*i == '\n' || *i == '\r' ? ' ' : *i);
+    line << '\n';
+    if (!Server::writeAll(_fd, line.str()))
+    {
+      std::cerr << _socketName << " : " << strerror(errno) << std::endl;
+      return false;
+    }
+
+    // A line with the status and the length of the text, then the text
+    std::string::size_type end;
+    while ((end = _buffer.find('\n')) == std::string::npos &&
+	   receive(_buffer.length() + 1))
+      ;
+    unsigned int status = 0;
+    std::string::size_type length = 0;
+    if (end != std::string::npos)
+    {
+      std::istringstream header(_buffer.substr(0, end));
+      _buffer.erase(0, end + 1);
+      if (!(header >> status >> length))
+	end = std::string::npos;
+    }
+    if (end == std::string::npos || !receive(length))
+    {
+      std::cerr << _socketName << " : Invalid answer" << std::endl;
+      return false;
+    }
+
+    (status == 0 ? out : err) << _buffer.substr(0, length);
+    _buffer.erase(0, length);
+
+    return true;
+  }
+
+  /*!
+  ** Read from the server until some bytes are buffered.
+  **
+  ** @param length The number of bytes wanted
+  **
+  ** @return If they were read before the connection was closed
+  */
+  bool
+  Client::receive(const std::string::size_type length)
+  {
+    char chunk[4096];
+    while (_buffer.length() < length)
+    {
+      const ssize_t read = recv(_fd, chunk, sizeof (chunk), 0);
+      if (read < 0 && errno == EINTR)
+	continue;
+      if (read <= 0)
+	return false;
+      _buffer.append(chunk, read);
+    }
+
+    return true;
+  }
+}
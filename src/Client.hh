@@ -0,0 +1,36 @@
+#ifndef CLIENT_HH_
+# define CLIENT_HH_
+
+# include <iostream>
+# include <string>
+
+namespace Search
+{
+  /*!
+  ** Send search requests to a running server, on the socket it listens,
+  ** and display its answers like a local search would.
+  */
+  class Client
+  {
+  public:
+    Client(const std::string& socketName);
+    ~Client();
+
+  public:
+    bool connect();
+    bool search(const std::string& request, const unsigned int k,
+		std::ostream& out = std::cout, std::ostream& err = std::cerr);
+
+  private:
+    Client(const Client& client);
+    Client& operator=(const Client& client);
+    bool receive(const std::string::size_type length);
+
+  private:
+    const std::string	_socketName;
+    int			_fd;
+    std::string		_buffer;
+  };
+}
+
+#endif /* !CLIENT_HH_ */
@@ -16,7 +16,10 @@ operator<<(std::ostream& o, const Index::Column::Document& doc)
     "Doc.type = " << doc.type << std::endl <<
     "Doc.hash = " << doc.hash << std::endl <<
     "Doc.date = " << doc.date << std::endl <<
-    "Doc.length = " << doc.length << std::endl;
+    "Doc.length = " << doc.length << std::endl <<
+    "Doc.size = " << doc.size << std::endl <<
+    "Doc.mtime = " << doc.mtime << std::endl <<
+    "Doc.inode = " << doc.inode << std::endl;
 }
 
 /*!
@@ -35,7 +38,11 @@ operator<<(std::ostream& o, const Index::Column::Word& word)
     "Word.weight = " << word.weight << std::endl <<
     "Word.realCount = " << word.realCount << std::endl <<
     "Word.stemCount = " << word.stemCount << std::endl <<
-    "Word.score = " << word.score << std::endl;
+    "Word.score = " << word.score << std::endl <<
+    "Word.fieldCounts = " << word.fieldCounts[Index::Field::BODY] << " " <<
+    word.fieldCounts[Index::Field::TITLE] << " " <<
+    word.fieldCounts[Index::Field::HEADING] << " " <<
+    word.fieldCounts[Index::Field::META] << std::endl;
 }
 
 /*!
@@ -51,7 +58,8 @@ operator<<(std::ostream& o, const Index::Column::Term& term)
 {
   return o << "Term.id = " << term.id << std::endl <<
     "Term.realTerm = " << term.realTerm << std::endl <<
-    "Term.stemTerm = " << term.stemTerm << std::endl;
+    "Term.stemTerm = " << term.stemTerm << std::endl <<
+    "Term.documentCount = " << term.documentCount << std::endl;
 }
 
 /*!
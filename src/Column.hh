@@ -14,6 +14,22 @@ namespace Index
       };
   }
 
+  /*!
+  ** The zones of a document where a word can be found, counted apart
+  ** to rank the documents.
+  */
+  namespace Field
+  {
+    enum type
+      {
+	BODY = 0,
+	TITLE,
+	HEADING,
+	META,
+	COUNT
+      };
+  }
+
   namespace Column
   {
     struct Result
@@ -29,8 +45,11 @@ namespace Index
       std::string	filename;
       File::type	type;
       std::string	hash;
-      std::string	date;
+      long long		date;
       unsigned int	length;
+      long long		size;
+      long long		mtime;
+      long long		inode;
     };
 
     struct Word
@@ -41,6 +60,8 @@ namespace Index
       unsigned int	realCount;
       unsigned int	stemCount;
       double		score;
+      unsigned int	fieldCounts[Field::COUNT];
+      std::string	positions;
     };
 
     struct Term
@@ -48,6 +69,13 @@ namespace Index
       unsigned int	id;
       std::string	realTerm;
       std::string	stemTerm;
+      unsigned int	documentCount;
+    };
+
+    struct Collection
+    {
+      unsigned int	documents;
+      long long		length;
     };
 
     struct DocumentWord : public Document, public Word
@@ -13,20 +13,44 @@ public:
   const std::string& getDatabaseName() const;
   const std::string& getStemmerName() const;
   const std::string& getStopwordFilename() const;
+  const std::string& getStorageEngine() const;
+  const std::string& getScorerName() const;
+  const std::string& getSocketName() const;
   bool getVerbose() const;
+  unsigned int getJobs() const;
+  unsigned int getLimit() const;
+  unsigned int getStemCache() const;
+  bool getFoldAccents() const;
+  bool getParanoid() const;
 
   void setMode(const std::string& mode);
   void setDatabaseName(const std::string& dbName);
   void setStemmerName(const std::string& stemmerName);
   void setStopwordFilename(const std::string& stopwordFilename);
+  void setStorageEngine(const std::string& storageEngine);
+  void setScorerName(const std::string& scorerName);
+  void setSocketName(const std::string& socketName);
   void setVerbose(const bool verbose);
+  void setJobs(const unsigned int jobs);
+  void setLimit(const unsigned int limit);
+  void setStemCache(const unsigned int stemCache);
+  void setFoldAccents(const bool foldAccents);
+  void setParanoid(const bool paranoid);
 
 private:
   std::string		_mode;
   std::string		_databaseName;
   std::string		_stemmerName;
   std::string		_stopwordFilename;
+  std::string		_storageEngine;
+  std::string		_scorerName;
+  std::string		_socketName;
   bool			_verbose;
+  unsigned int		_jobs;
+  unsigned int		_limit;
+  unsigned int		_stemCache;
+  bool			_foldAccents;
+  bool			_paranoid;
 };
 
 # include "Configuration.hxx"
@@ -42,6 +42,40 @@ Configuration::getStopwordFilename() const
   return _stopwordFilename;
 }
 
+/*!
+** Get the storage engine of the postings: "sqlite" or "segment".
+**
+** @return The storage engine
+*/
+inline const std::string&
+Configuration::getStorageEngine() const
+{
+  return _storageEngine;
+}
+
+/*!
+** Get how the searcher ranks documents: "bm25" or "static".
+**
+** @return The scorer type
+*/
+inline const std::string&
+Configuration::getScorerName() const
+{
+  return _scorerName;
+}
+
+/*!
+** Get where the search server listens: the path of a Unix socket, or
+** a TCP port on localhost.
+**
+** @return The socket name
+*/
+inline const std::string&
+Configuration::getSocketName() const
+{
+  return _socketName;
+}
+
 /*!
 ** Check if verbose mode is activated
 **
@@ -53,6 +87,62 @@ Configuration::getVerbose() const
   return _verbose;
 }
 
+/*!
+** Get the number of parsing threads used by the indexer.
+**
+** @return The number of parsing threads
+*/
+inline unsigned int
+Configuration::getJobs() const
+{
+  return _jobs;
+}
+
+/*!
+** Get the maximum number of documents found by the searcher.
+**
+** @return The maximum number of documents, or 0 for no limit
+*/
+inline unsigned int
+Configuration::getLimit() const
+{
+  return _limit;
+}
+
+/*!
+** Get the number of stems remembered by each stemmer of the indexer.
+**
+** @return The number of stems, or 0 for no cache
+*/
+inline unsigned int
+Configuration::getStemCache() const
+{
+  return _stemCache;
+}
+
+/*!
+** Check if accents are folded when words are indexed and searched.
+**
+** @return If accents are folded
+*/
+inline bool
+Configuration::getFoldAccents() const
+{
+  return _foldAccents;
+}
+
+/*!
+** Check if every file is hashed while indexing, even when its size,
+** date and inode are unchanged.
+**
+** @return If every file is hashed
+*/
+inline bool
+Configuration::getParanoid() const
+{
+  return _paranoid;
+}
+
 /*!
 ** Set the mode.
 **
@@ -86,6 +176,39 @@ Configuration::setStemmerName(const std::string& stemmerName)
   _stemmerName = stemmerName;
 }
 
+/*!
+** Set the storage engine of the postings.
+**
+** @param storageEngine The storage engine, "sqlite" or "segment"
+*/
+inline void
+Configuration::setStorageEngine(const std::string& storageEngine)
+{
+  _storageEngine = storageEngine;
+}
+
+/*!
+** Set how the searcher ranks documents.
+**
+** @param scorerName The scorer type, "bm25" or "static"
+*/
+inline void
+Configuration::setScorerName(const std::string& scorerName)
+{
+  _scorerName = scorerName;
+}
+
+/*!
+** Set where the search server listens.
+**
+** @param socketName The path of a Unix socket, or a TCP port on localhost
+*/
+inline void
+Configuration::setSocketName(const std::string& socketName)
+{
+  _socketName = socketName;
+}
+
 /*!
 ** The stop word filename.
 **
@@ -107,3 +230,59 @@ Configuration::setVerbose(const bool verbose)
 {
   _verbose = verbose;
 }
+
+/*!
+** Set the number of parsing threads used by the indexer.
+**
+** @param jobs The number of parsing threads
+*/
+inline void
+Configuration::setJobs(const unsigned int jobs)
+{
+  _jobs = jobs;
+}
+
+/*!
+** Set the maximum number of documents found by the searcher.
+**
+** @param limit The maximum number of documents, or 0 for no limit
+*/
+inline void
+Configuration::setLimit(const unsigned int limit)
+{
+  _limit = limit;
+}
+
+/*!
+** Set the number of stems remembered by each stemmer of the indexer.
+**
+** @param stemCache The number of stems, or 0 for no cache
+*/
+inline void
+Configuration::setStemCache(const unsigned int stemCache)
+{
+  _stemCache = stemCache;
+}
+
+/*!
+** Set if accents are folded when words are indexed and searched.
+**
+** @param foldAccents If accents are folded
+*/
+inline void
+Configuration::setFoldAccents(const bool foldAccents)
+{
+  _foldAccents = foldAccents;
+}
+
+/*!
+** Set if every file is hashed while indexing, even when its size,
+** date and inode are unchanged.
+**
+** @param paranoid If every file is hashed
+*/
+inline void
+Configuration::setParanoid(const bool paranoid)
+{
+  _paranoid = paranoid;
+}
@@ -1,11 +1,134 @@
+#include <unistd.h>
 #include <cassert>
+#include <cerrno>
+#include <cstring>
 #include "Utils.hh"
 #include "Database.hh"
+#include "Configuration.hh"
 #include "SQLiteQuery.hh"
 #include "SQLiteException.hh"
 
 namespace Index
 {
+  namespace
+  {
+    /*!
+    ** Schema migrations. The n-th entry upgrades a database from version n
+    ** to version n + 1. The version is stored in the "user_version" pragma.
+    */
+    static const char* const MIGRATIONS[] =
+      {
+	// Version 1: indexes on all lookup columns, (id_doc, id_term) as Word key.
+	// Duplicates are dropped first, so that unique indexes can be built.
+	"DELETE FROM Document WHERE id_doc NOT IN"
+	" (SELECT MAX(id_doc) FROM Document GROUP BY filename);"
+	"CREATE UNIQUE INDEX DocumentFilename ON Document(filename);"
+	"DELETE FROM Term WHERE id_term NOT IN"
+	" (SELECT MIN(id_term) FROM Term GROUP BY real_term);"
+	"CREATE UNIQUE INDEX TermRealTerm ON Term(real_term);"
+	"CREATE INDEX TermStemTerm ON Term(stem_term);"
+	"CREATE TABLE WordNew(id_doc INTEGER, id_term INTEGER, weight REAL, real_count INTEGER,"
+	" stem_count INTEGER, score REAL, PRIMARY KEY(id_doc, id_term));"
+	"INSERT OR REPLACE INTO WordNew SELECT * FROM Word"
+	" WHERE id_doc IN (SELECT id_doc FROM Document)"
+	" AND id_term IN (SELECT id_term FROM Term);"
+	"DROP TABLE Word;"
+	"ALTER TABLE WordNew RENAME TO Word;"
+	"CREATE INDEX WordTerm ON Word(id_term);"
+	"CREATE INDEX SearchSentence ON Search(sentence);"
+	"CREATE INDEX ResultSearch ON Result(id_search);",
+
+	// Version 2: words of a term by score, so that the best documents of a
+	// term are read first, without sorting all of them.
+	"DROP INDEX WordTerm;"
+	"CREATE INDEX WordTermScore ON Word(id_term, score);",
+
+	// Version 3: terms of each cached search, to invalidate it only when
+	// one of its terms or documents changes. Previous searches can't be
+	// invalidated, so they are dropped.
+	"DELETE FROM Search;"
+	"DELETE FROM Result;"
+	"CREATE TABLE SearchTerm(id_search INTEGER, term TEXT);"
+	"CREATE INDEX SearchTermTerm ON SearchTerm(term);"
+	"CREATE INDEX SearchTermSearch ON SearchTerm(id_search);"
+	"CREATE INDEX ResultDocument ON Result(id_doc);",
+
+	// Version 4: size, modification time and inode of each document, so
+	// that an unchanged file is skipped without being read. Documents
+	// indexed before have none, and are hashed once more.
+	"ALTER TABLE Document ADD COLUMN size INTEGER;"
+	"ALTER TABLE Document ADD COLUMN mtime INTEGER;"
+	"ALTER TABLE Document ADD COLUMN inode INTEGER;",
+
+	// Version 5: statistics to rank documents with BM25F. Words are counted
+	// by field; words indexed before are all counted in the body. The number
+	// of documents of each term, and the number and total length of the
+	// documents, are kept up to date by triggers. Previous searches were
+	// ranked otherwise, so they are dropped.
+	"ALTER TABLE Word ADD COLUMN title_count INTEGER;"
+	"ALTER TABLE Word ADD COLUMN heading_count INTEGER;"
+	"ALTER TABLE Word ADD COLUMN meta_count INTEGER;"
+	"ALTER TABLE Term ADD COLUMN df INTEGER NOT NULL DEFAULT 0;"
+	"UPDATE Term SET df = (SELECT COUNT(*) FROM Word WHERE Word.id_term = Term.id_term);"
+	"CREATE TRIGGER WordInsert AFTER INSERT ON Word BEGIN"
+	" UPDATE Term SET df = df + 1 WHERE id_term = NEW.id_term; END;"
+	"CREATE TRIGGER WordDelete AFTER DELETE ON Word BEGIN"
+	" UPDATE Term SET df = df - 1 WHERE id_term = OLD.id_term; END;"
+	"CREATE TABLE Collection(documents INTEGER, length INTEGER);"
+	"INSERT INTO Collection SELECT COUNT(*), COALESCE(SUM(length), 0) FROM Document;"
+	"CREATE TRIGGER DocumentInsert AFTER INSERT ON Document BEGIN"
+	" UPDATE Collection SET documents = documents + 1, length = length + NEW.length; END;"
+	"CREATE TRIGGER DocumentDelete AFTER DELETE ON Document BEGIN"
+	" UPDATE Collection SET documents = documents - 1, length = length - OLD.length; END;"
+	"CREATE TRIGGER DocumentLength AFTER UPDATE OF length ON Document"
+	" WHEN NEW.length != OLD.length BEGIN"
+	" UPDATE Collection SET length = length - OLD.length + NEW.length; END;"
+	"DELETE FROM Search;"
+	"DELETE FROM Result;"
+	"DELETE FROM SearchTerm;",
+
+	// Version 6: positions of each word in its document, to find phrases.
+	// Words indexed before have none, until their document changes, and
+	// phrases searched before were never found.
+	"ALTER TABLE Word ADD COLUMN positions BLOB;"
+	"DELETE FROM Search;"
+	"DELETE FROM Result;"
+	"DELETE FROM SearchTerm;",
+
+	// Version 7: dates as seconds since the epoch, indexed, so that the
+	// documents of a period are found by a range. The table is rebuilt,
+	// as a TEXT column would compare them as strings, and its sequence is
+	// kept so that deleted ids are not reused. Searches by date matched
+	// all documents before, so they are dropped.
+	"CREATE TABLE DocumentNew(id_doc INTEGER PRIMARY KEY AUTOINCREMENT, filename TEXT,"
+	" type INTEGER, hash TEXT, date INTEGER, length INTEGER, size INTEGER,"
+	" mtime INTEGER, inode INTEGER);"
+	"INSERT INTO DocumentNew SELECT id_doc, filename, type, hash, CAST(date AS INTEGER),"
+	" length, size, mtime, inode FROM Document;"
+	"DELETE FROM sqlite_sequence WHERE name = 'DocumentNew';"
+	"INSERT INTO sqlite_sequence SELECT 'DocumentNew', seq FROM sqlite_sequence"
+	" WHERE name = 'Document';"
+	"DROP TABLE Document;"
+	"ALTER TABLE DocumentNew RENAME TO Document;"
+	"CREATE UNIQUE INDEX DocumentFilename ON Document(filename);"
+	"CREATE INDEX DocumentDate ON Document(date);"
+	"CREATE TRIGGER DocumentInsert AFTER INSERT ON Document BEGIN"
+	" UPDATE Collection SET documents = documents + 1, length = length + NEW.length; END;"
+	"CREATE TRIGGER DocumentDelete AFTER DELETE ON Document BEGIN"
+	" UPDATE Collection SET documents = documents - 1, length = length - OLD.length; END;"
+	"CREATE TRIGGER DocumentLength AFTER UPDATE OF length ON Document"
+	" WHEN NEW.length != OLD.length BEGIN"
+	" UPDATE Collection SET length = length - OLD.length + NEW.length; END;"
+	"DELETE FROM Search;"
+	"DELETE FROM Result;"
+	"DELETE FROM SearchTerm;",
+	0
+      };
+
+    // Version of a database with all migrations applied
+    static const int LAST_VERSION = sizeof (MIGRATIONS) / sizeof (*MIGRATIONS) - 1;
+  }
+
   /*!
   ** Create an index database object.
   */
@@ -21,7 +144,62 @@ namespace Index
   }
 
   /*!
-  ** Create database if it doesn't exists yet.
+  ** Create a read-only connection, opened by Database::reader().
+  */
+  Database::Connection::Connection()
+    : segmentsLoaded(false), segmentsVersion(0), snapshot(false)
+  {
+  }
+
+  /*!
+  ** Destruct a connection, unmapping its segments.
+  */
+  Database::Connection::~Connection()
+  {
+    unloadSegments();
+  }
+
+  /*!
+  ** Unmap all segments of a connection. They are mapped again when
+  ** needed.
+  */
+  void
+  Database::Connection::unloadSegments()
+  {
+    for (std::vector<Segment*>::iterator i = segments.begin();
+	 i != segments.end(); ++i)
+      delete *i;
+    segments.clear();
+    segmentsLoaded = false;
+  }
+
+  /*!
+  ** Begin a snapshot of the index for the calling thread.
+  */
+  Database::Snapshot::Snapshot()
+  {
+    Database::getInstance().beginSnapshot();
+  }
+
+  /*!
+  ** End the snapshot. A failed search may have ended it already.
+  */
+  Database::Snapshot::~Snapshot()
+  {
+    try
+    {
+      Database::getInstance().endSnapshot();
+    }
+    catch (SQLite::Exception& ex)
+    {
+      std::cerr << "Can't end a snapshot : " << ex.errorMessage() << std::endl;
+    }
+  }
+
+  /*!
+  ** Create database if it doesn't exists yet, and switch it to WAL
+  ** mode. With segments, their directory is created too, and their
+  ** manifest is read.
   **
   ** @param filename SQLite3 database
   */
@@ -29,22 +207,188 @@ namespace Index
   Database::open(const std::string& filename)
   {
     bool exists = Utils::fileExists(filename);
+    _filename = filename;
     _db.open(filename.c_str());
     if (!exists)
       createDatabase();
+    migrate();
+
+    // Commits only sync the log, which is enough for a WAL database
+    _db.execQuery("PRAGMA journal_mode = WAL;");
+    _db.execDML("PRAGMA synchronous = NORMAL;");
+
+    if (Configuration::getInstance().getStorageEngine() == "segment")
+    {
+      _manifest.reset(new SegmentManifest(filename + ".segments"));
+      _merger.reset(new SegmentMerger(*_manifest));
+    }
   }
 
   /*!
-  ** Close the database.
+  ** Close the database, writing the buffered postings first. The merges
+  ** they make due are done before.
   */
   void
   Database::close()
   {
+    flush();
+    _merger.reset();
+    _readers.reset();
+    _manifest.reset();
     _db.close();
   }
 
   /*!
-  ** Create the structure of the new database.
+  ** Write the buffered postings as a new segment, then the hashes of
+  ** their documents, and drop the cached searches they may change. If
+  ** the segment can't be written, the documents keep an empty hash, so
+  ** they are indexed again next time. Without buffered postings, the
+  ** hashes of the documents which were only touched are still written.
+  */
+  void
+  Database::flush()
+  {
+    if (!_manifest.get() || (_writer.empty() && _hashes.empty()))
+      return;
+
+    hashMap hashes;
+    hashes.swap(_hashes);
+    const bool changed = !_writer.empty();
+    if (changed)
+    {
+      SegmentManifest::Lock locked(*_manifest);
+      const unsigned int id = _manifest->allocate();
+      const std::string filename = _manifest->getFilename(id);
+      if (!_writer.write(filename))
+      {
+	std::cerr << filename << " : " << strerror(errno) << std::endl;
+	_writer.clear();
+	return;
+      }
+      if (!_manifest->append(id))
+      {
+	unlink(filename.c_str());
+	_writer.clear();
+	return;
+      }
+    }
+
+    beginTransaction();
+    for (hashMap::const_iterator i = hashes.begin(); i != hashes.end(); ++i)
+    {
+      SQLite::Statement& stmt =
+	_db.cachedStatement("UPDATE Document SET hash = ? WHERE filename = ?;");
+      stmt.bind(1, i->second.c_str());
+      stmt.bind(2, i->first.c_str());
+      stmt.execDML();
+    }
+    // Cleared before committing, as a full writer is flushed on commit
+    if (changed)
+      invalidateSearches(_writer);
+    _writer.clear();
+    endTransaction();
+    if (changed)
+      _merger->schedule();
+  }
+
+  /*!
+  ** Compact the index. All segments are merged into a single one, which
+  ** drops the postings of the modified and deleted documents. Without
+  ** segments, the SQLite file is rebuilt instead.
+  **
+  ** @return The number of merged segments
+  */
+  unsigned int
+  Database::compact()
+  {
+    if (!_manifest.get())
+    {
+      _db.execDML("VACUUM;");
+      return 0;
+    }
+
+    flush();
+    return _merger->mergeAll();
+  }
+
+  /*!
+  ** Get the version of the data, which changes each time another
+  ** connection, maybe of another process, commits a change.
+  **
+  ** @return The data version
+  */
+  unsigned int
+  Database::getDataVersion()
+  {
+    return _db.execScalar("PRAGMA data_version;");
+  }
+
+  /*!
+  ** Begin a read transaction on the connection of the calling thread,
+  ** then map the live segments. Until the snapshot ends, the thread
+  ** reads the database as it was at its first read, and the segments
+  ** mapped then.
+  */
+  void
+  Database::beginSnapshot()
+  {
+    Connection& c = reader();
+    if (c.snapshot)
+      endSnapshot();
+
+    c.db.cachedStatement("begin transaction;").execDML();
+    getCollection();
+    if (_manifest.get())
+      loadSegments(c);
+    c.snapshot = true;
+  }
+
+  /*!
+  ** End the snapshot of the calling thread, if any.
+  */
+  void
+  Database::endSnapshot()
+  {
+    Connection& c = reader();
+    if (!c.snapshot)
+      return;
+
+    c.snapshot = false;
+    c.db.cachedStatement("commit transaction;").execDML();
+  }
+
+  /*!
+  ** Upgrade the database schema to the last version, applying
+  ** each missing migration in its own transaction. A database of an
+  ** unknown version, written by a newer program, is refused.
+  */
+  void
+  Database::migrate()
+  {
+    int version = _db.execScalar("PRAGMA user_version;");
+    if (version < 0 || version > LAST_VERSION)
+    {
+      std::ostringstream msg;
+      msg << _filename << " : The database is newer than this program (version "
+	  << version << ", expected at most " << LAST_VERSION << ")";
+      throw SQLite::Exception(SQLite::CPPSQLITE_ERROR,
+			      const_cast<char*>(msg.str().c_str()),
+			      SQLite::DONT_DELETE_MSG);
+    }
+    for (; MIGRATIONS[version]; version++)
+    {
+      std::ostringstream cmd;
+      cmd << "PRAGMA user_version = " << version + 1 << ";";
+      beginTransaction();
+      _db.execDML(MIGRATIONS[version]);
+      _db.execDML(cmd.str().c_str());
+      endTransaction();
+    }
+  }
+
+  /*!
+  ** Create the structure of the new database, in its first version.
+  ** Then migrate() brings it to the last one.
   */
   void
   Database::createDatabase()
@@ -118,9 +462,11 @@ namespace Index
   Database::getDocumentByFilename(const std::string& filename)
   {
     assert(filename != "");
-    std::ostringstream cmd;
-    cmd << "SELECT * FROM Document WHERE filename = '" << filename << "';";
-    return getDocument(cmd.str());
+    SQLite::Statement& stmt =
+      _db.cachedStatement("SELECT * FROM Document WHERE filename = ?;");
+    stmt.bind(1, filename.c_str());
+    SQLite::Query q = stmt.execQuery();
+    return getDocument(q);
   }
 
   /*!
@@ -135,9 +481,33 @@ namespace Index
   Database::getDocumentById(const unsigned int idDoc)
   {
     assert(idDoc != 0);
-    std::ostringstream cmd;
-    cmd << "SELECT * FROM Document WHERE id_doc = '" << idDoc << "';";
-    return getDocument(cmd.str());
+    SQLite::Statement& stmt =
+      reader().db.cachedStatement("SELECT * FROM Document WHERE id_doc = ?;");
+    stmt.bind(1, idDoc);
+    SQLite::Query q = stmt.execQuery();
+    return getDocument(q);
+  }
+
+  /*!
+  ** Get all documents located under the given directory, at any depth.
+  ** As '0' follows '/', all these filenames are in a single range of the
+  ** filename index.
+  **
+  ** @param directory The directory, without its trailing '/'
+  **
+  ** @return A list of document
+  */
+  const std::list<Column::Document>
+  Database::getDocumentsUnder(const std::string& directory)
+  {
+    const std::string lower = directory + "/";
+    const std::string upper = directory + "0";
+    SQLite::Statement& stmt =
+      _db.cachedStatement("SELECT * FROM Document WHERE filename >= ? AND filename < ?;");
+    stmt.bind(1, lower.c_str());
+    stmt.bind(2, upper.c_str());
+    SQLite::Query q = stmt.execQuery();
+    return getDocuments(q);
   }
 
   /*!
@@ -154,10 +524,12 @@ namespace Index
   {
     assert(idDocument != 0);
     assert(idTerm != 0);
-    std::ostringstream cmd;
-    cmd << "SELECT * FROM Word WHERE id_doc = " << idDocument <<
-      " AND id_term = " << idTerm << ";";
-    return getWord(cmd.str());
+    SQLite::Statement& stmt =
+      _db.cachedStatement("SELECT * FROM Word WHERE id_doc = ? AND id_term = ?;");
+    stmt.bind(1, idDocument);
+    stmt.bind(2, idTerm);
+    SQLite::Query q = stmt.execQuery();
+    return getWord(q);
   }
 
   /*!
@@ -172,9 +544,11 @@ namespace Index
   Database::getTermById(const unsigned int idTerm)
   {
     assert(idTerm != 0);
-    std::ostringstream cmd;
-    cmd << "SELECT * FROM Term WHERE id_term = '" << idTerm << "';";
-    return getTerm(cmd.str());
+    SQLite::Statement& stmt =
+      _db.cachedStatement("SELECT * FROM Term WHERE id_term = ?;");
+    stmt.bind(1, idTerm);
+    SQLite::Query q = stmt.execQuery();
+    return getTerm(q);
   }
 
   /*!
@@ -189,40 +563,48 @@ namespace Index
   Database::getTermByName(const std::string& termName)
   {
     assert(termName != "");
-    std::ostringstream cmd;
-    cmd << "SELECT * FROM Term WHERE real_term = '" << termName << "';";
-    return getTerm(cmd.str());
+    SQLite::Statement& stmt =
+      _db.cachedStatement("SELECT * FROM Term WHERE real_term = ?;");
+    stmt.bind(1, termName.c_str());
+    SQLite::Query q = stmt.execQuery();
+    return getTerm(q);
   }
 
   /*!
   ** Add or update a document. Document is added if doc.id == 0,
-  ** else an update operation is performed.
+  ** else an update operation is performed. With segments, its hash is
+  ** kept aside until its postings are written.
   **
   ** @param doc The document to add or update
   */
   void
   Database::addOrUpdateDocument(const Column::Document& doc)
   {
-    std::ostringstream cmd;
-
     // Check if already exists, then add or update
-    if (!Column::docExists(doc))
-      cmd << "INSERT INTO Document(filename, type, hash, date, length) VALUES(" <<
-	'\'' << doc.filename << '\''<< "," <<
-	doc.type << "," <<
-	'\'' << doc.hash << '\'' << "," <<
-	'\'' << doc.date << '\'' << "," <<
-	doc.length << ");";
+    SQLite::Statement& stmt = !Column::docExists(doc) ?
+      _db.cachedStatement("INSERT INTO Document(filename, type, hash, date, length, "
+			  "size, mtime, inode) VALUES(?, ?, ?, ?, ?, ?, ?, ?);") :
+      _db.cachedStatement("UPDATE Document SET filename = ?, type = ?, hash = ?, "
+			  "date = ?, length = ?, size = ?, mtime = ?, inode = ? "
+			  "WHERE id_doc = ?;");
+    stmt.bind(1, doc.filename.c_str());
+    stmt.bind(2, static_cast<int>(doc.type));
+    if (!_manifest.get())
+      stmt.bind(3, doc.hash.c_str());
     else
-      cmd << "UPDATE Document SET " <<
-	"filename = " << '\'' << doc.filename << '\''<< "," <<
-	"type = " << doc.type << "," <<
-	"hash = " << '\'' << doc.hash << '\'' << "," <<
-	"date = " << '\'' << doc.date << '\'' << "," <<
-	"length = " << doc.length <<
-	" WHERE id_doc = " << doc.id << ";";
+    {
+      stmt.bind(3, "");
+      _hashes[doc.filename] = doc.hash;
+    }
+    stmt.bind(4, static_cast<sqlite_int64>(doc.date));
+    stmt.bind(5, doc.length);
+    stmt.bind(6, static_cast<sqlite_int64>(doc.size));
+    stmt.bind(7, static_cast<sqlite_int64>(doc.mtime));
+    stmt.bind(8, static_cast<sqlite_int64>(doc.inode));
+    if (Column::docExists(doc))
+      stmt.bind(9, doc.id);
 
-    _db.execDML(cmd.str().c_str());
+    stmt.execDML();
   }
 
   /*!
@@ -233,17 +615,56 @@ namespace Index
   void
   Database::addWord(const Column::Word& word)
   {
-    std::ostringstream cmd;
+    SQLite::Statement& stmt =
+      _db.cachedStatement("INSERT INTO Word(id_doc, id_term, weight, real_count, "
+			  "stem_count, score, title_count, heading_count, meta_count, "
+			  "positions) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?);");
+    stmt.bind(1, word.idDocument);
+    stmt.bind(2, word.idTerm);
+    stmt.bind(3, word.weight);
+    stmt.bind(4, word.realCount);
+    stmt.bind(5, word.stemCount);
+    stmt.bind(6, word.score);
+    stmt.bind(7, word.fieldCounts[Field::TITLE]);
+    stmt.bind(8, word.fieldCounts[Field::HEADING]);
+    stmt.bind(9, word.fieldCounts[Field::META]);
+    stmt.bind(10, reinterpret_cast<const unsigned char*>(word.positions.data()),
+	      word.positions.length());
 
-    cmd << "INSERT INTO Word(id_doc, id_term, weight, real_count, stem_count, score) VALUES(" <<
-      word.idDocument << "," <<
-      word.idTerm << "," <<
-      word.weight << "," <<
-      word.realCount << "," <<
-      word.stemCount << "," <<
-      word.score << ");";
+    stmt.execDML();
+  }
 
-    _db.execDML(cmd.str().c_str());
+  /*!
+  ** Add the word of a term in a document, adding the term if it doesn't
+  ** exist yet. With segments, the word is only buffered, and the terms
+  ** are kept in the segment dictionaries.
+  **
+  ** @param realTerm The term
+  ** @param stemTerm The stem of this term
+  ** @param word The word, whose term id is set with SQLite
+  ** @param length The length of the document, kept by segments
+  */
+  void
+  Database::addWord(const std::string& realTerm, const std::string& stemTerm,
+		    Column::Word& word, const unsigned int length)
+  {
+    if (_manifest.get())
+    {
+      _writer.add(realTerm, word, length);
+      return;
+    }
+
+    Column::Term term = getTermByName(realTerm);
+    if (!Column::termExists(term))
+    {
+      term.realTerm = realTerm;
+      term.stemTerm = stemTerm;
+      addOrUpdateTerm(term);
+      term = getTermByName(realTerm);
+    }
+    assert(Column::termExists(term));
+    word.idTerm = term.id;
+    addWord(word);
   }
 
   /*!
@@ -254,17 +675,17 @@ namespace Index
   void
   Database::updateWord(const Column::Word& word)
   {
-    std::ostringstream cmd;
+    SQLite::Statement& stmt =
+      _db.cachedStatement("UPDATE Word SET weight = ?, real_count = ?, stem_count = ?, "
+			  "score = ? WHERE id_doc = ? AND id_term = ?;");
+    stmt.bind(1, word.weight);
+    stmt.bind(2, word.realCount);
+    stmt.bind(3, word.stemCount);
+    stmt.bind(4, word.score);
+    stmt.bind(5, word.idDocument);
+    stmt.bind(6, word.idTerm);
 
-    cmd << "UPDATE Word SET " <<
-      "weight = " << word.weight << "," <<
-      "real_count = " << word.realCount << "," <<
-      "stem_count = " << word.stemCount << "," <<
-      "score = " << word.score <<
-      " WHERE id_doc = " << word.idDocument <<
-      " AND id_term = " << word.idTerm <<";";
-
-    _db.execDML(cmd.str().c_str());
+    stmt.execDML();
   }
 
   /*!
@@ -276,135 +697,562 @@ namespace Index
   void
   Database::addOrUpdateTerm(const Column::Term& term)
   {
-    std::ostringstream cmd;
-
     // Check if already exists, then add or update
-    if (!Column::termExists(term))
-      cmd << "INSERT INTO Term(real_term, stem_term) VALUES(" <<
-	'\'' << term.realTerm << '\''<< "," <<
-	'\'' << term.stemTerm << '\'' << ");";
-    else
-      cmd << "UPDATE Term SET " <<
-	"real_term = " << '\'' << term.realTerm << '\''<< "," <<
-	"stem_term = " << '\'' << term.stemTerm << '\'' <<
-	" WHERE id_term = " << term.id << ";";
+    SQLite::Statement& stmt = !Column::termExists(term) ?
+      _db.cachedStatement("INSERT INTO Term(real_term, stem_term) VALUES(?, ?);") :
+      _db.cachedStatement("UPDATE Term SET real_term = ?, stem_term = ? "
+			  "WHERE id_term = ?;");
+    stmt.bind(1, term.realTerm.c_str());
+    stmt.bind(2, term.stemTerm.c_str());
+    if (Column::termExists(term))
+      stmt.bind(3, term.id);
 
-    _db.execDML(cmd.str().c_str());
+    stmt.execDML();
   }
 
   /*!
-  ** Get the number of stem the given word contains.
+  ** Delete a document, and all it's associated words. With segments,
+  ** the next one holds the document, so its older postings are dead.
   **
-  ** @param word The word
+  ** @param doc The document to delete.
+  ** @param erase If we erase the document or just trunc it.
+  */
+  void
+  Database::deleteDocument(const Column::Document& doc, const bool erase)
+  {
+    if (erase)
+    {
+      SQLite::Statement& stmt =
+	_db.cachedStatement("DELETE FROM Document WHERE id_doc = ?;");
+      stmt.bind(1, doc.id);
+      stmt.execDML();
+    }
+    if (_manifest.get())
+    {
+      _writer.remove(doc.id);
+      if (erase)
+	_hashes.erase(doc.filename);
+      return;
+    }
+    SQLite::Statement& stmt =
+      _db.cachedStatement("DELETE FROM Word WHERE id_doc = ?;");
+    stmt.bind(1, doc.id);
+    stmt.execDML();
+  }
+
+  /*!
+  ** Delete the terms which are not used by any word anymore, ie which
+  ** are found in no document.
   **
-  ** @return Number of stem
+  ** @return Number of deleted terms
   */
-  int
-  Database::getStemNumber(const Column::Word& word, const std::string& stem)
+  unsigned int
+  Database::deleteUnusedTerms()
   {
-    std::ostringstream cmd;
-    cmd << "SELECT SUM(real_count) FROM Word " <<
-      " JOIN Term ON Word.id_term = Term.id_term AND id_doc = " <<
-      word.idDocument << " AND stem_term = '" << stem << "';";
+    SQLite::Statement& stmt =
+      _db.cachedStatement("DELETE FROM Term WHERE df = 0;");
 
-    return _db.execScalar(cmd.str().c_str());
+    return stmt.execDML();
   }
 
   /*!
-  ** Update correctly all stem number found.
+  ** Get all terms of a document.
   **
-  ** @param word The word to update
-  ** @param stem The stem form of a term
-  ** @param stemCount The stem number found
+  ** @param idDoc The document id
+  **
+  ** @return The list of terms
   */
-  void
-  Database::updateAllStemNumber(const Column::Word& word,
-				const std::string& stem,
-				const unsigned int stemCount)
-  {
-    std::ostringstream request;
-    request << "SELECT Word.id_term FROM Word JOIN Term ON Word.id_term = Term.id_term " <<
-      " WHERE id_doc = " << word.idDocument << " AND stem_term = '" <<
-      stem << "'";
-    SQLite::Query q = _db.execQuery(request.str().c_str());
-    unsigned int id = 0;
+  const std::list<std::string>
+  Database::getDocumentTerms(const unsigned int idDoc)
+  {
+    SQLite::Statement& stmt =
+      _db.cachedStatement("SELECT real_term FROM Word"
+			  " JOIN Term ON Term.id_term = Word.id_term WHERE id_doc = ?;");
+    stmt.bind(1, idDoc);
+    SQLite::Query q = stmt.execQuery();
+
+    std::list<std::string> terms;
     while (!q.eof())
     {
-      for (int fld = 0; fld < q.numFields(); fld++)
+      terms.push_back(q.getStringField(0));
+      q.nextRow();
+    }
+
+    return terms;
+  }
+
+  /*!
+  ** Delete the cached searches whose results may depend on a document:
+  ** the ones containing one of its current terms, and the ones where it
+  ** was found. Called before and after its words are rewritten.
+  **
+  ** @param idDoc The document id
+  **
+  ** @return Number of deleted searches
+  */
+  unsigned int
+  Database::invalidateSearches(const unsigned int idDoc)
+  {
+    SQLite::Statement& stmt =
+      _db.cachedStatement("SELECT id_search FROM SearchTerm WHERE term IN"
+			  " (SELECT real_term FROM Word JOIN Term ON Term.id_term = Word.id_term"
+			  " WHERE id_doc = ?1)"
+			  " UNION SELECT id_search FROM Result WHERE id_doc = ?1;");
+    stmt.bind(1, idDoc);
+    SQLite::Query q = stmt.execQuery();
+
+    std::set<unsigned int> searches;
+    while (!q.eof())
+    {
+      searches.insert(q.getIntField(0));
+      q.nextRow();
+    }
+    deleteSearches(searches);
+
+    return searches.size();
+  }
+
+  /*!
+  ** Delete the cached searches whose results may depend on the postings
+  ** of a segment to be written: the ones containing one of its terms, and
+  ** the ones where one of its documents was found. As for a single
+  ** document, the ranks of the other searches are kept.
+  **
+  ** @param writer The buffered postings
+  **
+  ** @return Number of deleted searches
+  */
+  unsigned int
+  Database::invalidateSearches(const SegmentWriter& writer)
+  {
+    std::set<unsigned int> searches;
+    SQLite::Statement& terms =
+      _db.cachedStatement("SELECT id_search, term FROM SearchTerm;");
+    SQLite::Query q = terms.execQuery();
+    while (!q.eof())
+    {
+      if (writer.hasTerm(q.getStringField(1)))
+	searches.insert(q.getIntField(0));
+      q.nextRow();
+    }
+
+    std::vector<unsigned int> documents;
+    writer.getDocuments(documents);
+    SQLite::Statement& found =
+      _db.cachedStatement("SELECT id_search FROM Result WHERE id_doc = ?;");
+    for (std::vector<unsigned int>::const_iterator i = documents.begin();
+	 i != documents.end(); ++i)
+    {
+      found.bind(1, *i);
+      SQLite::Query r = found.execQuery();
+      while (!r.eof())
       {
-	if (std::string(q.fieldName(fld)) == "id_term")
-	{
-	  id = Utils::stringToInt(q.fieldValue(fld));
-	  std::ostringstream cmd;
-	  cmd << "UPDATE Word SET " <<
-	    " stem_count = " << stemCount <<
-	    " WHERE id_term = " << id << ";";
-	  _db.execDML(cmd.str().c_str());
-	}
+	searches.insert(r.getIntField(0));
+	r.nextRow();
       }
+    }
+    deleteSearches(searches);
+
+    return searches.size();
+  }
+
+  /*!
+  ** Delete some cached searches, with their results and terms.
+  **
+  ** @param searches The search ids
+  */
+  void
+  Database::deleteSearches(const std::set<unsigned int>& searches)
+  {
+    static const char* const tables[] = {
+      "DELETE FROM Search WHERE id_search = ?;",
+      "DELETE FROM Result WHERE id_search = ?;",
+      "DELETE FROM SearchTerm WHERE id_search = ?;",
+      0
+    };
+    for (std::set<unsigned int>::const_iterator i = searches.begin();
+	 i != searches.end(); ++i)
+      for (unsigned int t = 0; tables[t]; t++)
+      {
+	SQLite::Statement& del = _db.cachedStatement(tables[t]);
+	del.bind(1, *i);
+	del.execDML();
+      }
+  }
+
+  /*!
+  ** Get the number of documents, and their total length. They are kept
+  ** up to date by triggers on Document.
+  **
+  ** @return The statistics of the collection
+  */
+  const Column::Collection
+  Database::getCollection()
+  {
+    SQLite::Statement& stmt =
+      reader().db.cachedStatement("SELECT documents, length FROM Collection;");
+    SQLite::Query q = stmt.execQuery();
+
+    Column::Collection collection = {0, 0};
+    if (!q.eof())
+    {
+      collection.documents = q.getIntField(0);
+      collection.length = q.getInt64Field(1);
+    }
+
+    return collection;
+  }
+
+  /*!
+  ** Get the k best documents containing the given term. With precomputed
+  ** scores, thanks to the (id_term, score) index, only these k documents
+  ** are read. Else, or with segments which are sorted by id, all live
+  ** postings of the term are scored.
+  **
+  ** @param term The term to look for
+  ** @param k The number of documents wanted
+  ** @param scorer How to score the documents
+  ** @param top Where to store the documents
+  */
+  void
+  Database::getBestDocuments(const std::string& term, const unsigned int k,
+			     Search::Scorer& scorer, TopK& top)
+  {
+    assert(term != "");
+    if (_manifest.get())
+    {
+      std::vector<Segment::Iterator> postings;
+      findPostings(term, scorer, postings);
+      for (std::vector<Segment::Iterator>::iterator it = postings.begin();
+	   it != postings.end(); ++it)
+	for (; !it->atEnd(); it->next())
+	  top.push(it->getId(), scorePosting(*it, scorer));
+      return;
+    }
+
+    if (!scorer.isPrecomputed())
+    {
+      PostingList postings;
+      getPostings(term, scorer, postings);
+      top.addAll(postings);
+      return;
+    }
+
+    SQLite::Statement& stmt =
+      reader().db.cachedStatement("SELECT id_doc, score FROM Word"
+				  " WHERE id_term = (SELECT id_term FROM Term WHERE real_term = ?)"
+				  " ORDER BY score DESC LIMIT ?;");
+    stmt.bind(1, term.c_str());
+    stmt.bind(2, k);
+    SQLite::Query q = stmt.execQuery();
+
+    while (!q.eof())
+    {
+      top.push(q.getIntField(0), q.getFloatField(1));
       q.nextRow();
     }
-    assert(q.eof());
   }
 
   /*!
-  ** Delete a document, and all it's associated words.
+  ** Get the documents of a period, found by the index on their date,
+  ** sorted by id so that they are intersected like a posting list.
+  ** Their score is 0.
   **
-  ** @param doc The document to delete.
-  ** @param erase If we erase the document or just trunc it.
+  ** @param from The first second of the period
+  ** @param to The first second after the period
+  ** @param postings Where to store the documents
   */
   void
-  Database::deleteDocument(const Column::Document& doc, const bool erase)
+  Database::getDocumentsByDate(const long long from, const long long to,
+			       PostingList& postings)
   {
-    if (erase)
+    ArrayUtils::clear(postings);
+    SQLite::Statement& stmt =
+      reader().db.cachedStatement("SELECT id_doc FROM Document WHERE date >= ? AND date < ?"
+				  " ORDER BY id_doc;");
+    stmt.bind(1, static_cast<sqlite_int64>(from));
+    stmt.bind(2, static_cast<sqlite_int64>(to));
+    SQLite::Query q = stmt.execQuery();
+    while (!q.eof())
     {
-      std::ostringstream cmd;
-      cmd << "DELETE FROM Document WHERE " <<
-	" id_doc = " << doc.id << ";";
-      _db.execDML(cmd.str().c_str());
+      ArrayUtils::append(postings, q.getIntField(0), 0);
+      q.nextRow();
     }
-    std::ostringstream cmd;
-    cmd << "DELETE FROM Word WHERE " <<
-      " id_doc = " << doc.id << ";";
-    _db.execDML(cmd.str().c_str());
   }
 
   /*!
-  ** Get a complete document list.
+  ** Get the posting list of a term, ie all documents containing it,
+  ** sorted by id, with the score of the term in each of them.
   **
-  ** @param condition The retrieval condition
+  ** @param term The term to look for
+  ** @param scorer How to score the documents
+  ** @param postings Where to store the posting list
+  */
+  void
+  Database::getPostings(const std::string& term, Search::Scorer& scorer,
+			PostingList& postings)
+  {
+    assert(term != "");
+    ArrayUtils::clear(postings);
+    if (_manifest.get())
+    {
+      // A document is live in a single segment, so they share no id
+      std::vector<Segment::Iterator> lists;
+      findPostings(term, scorer, lists);
+      PostingList part;
+      PostingList merged;
+      for (std::vector<Segment::Iterator>::iterator it = lists.begin();
+	   it != lists.end(); ++it)
+      {
+	ArrayUtils::clear(part);
+	for (; !it->atEnd(); it->next())
+	  ArrayUtils::append(part, it->getId(), scorePosting(*it, scorer));
+	ArrayUtils::unite(postings, part, merged);
+	ArrayUtils::swap(postings, merged);
+      }
+      return;
+    }
+
+    const unsigned int idTerm = findTerm(term, scorer);
+    if (idTerm == 0)
+      return;
+
+    SQLite::Statement& stmt =
+      reader().db.cachedStatement("SELECT Word.id_doc, real_count, stem_count, score,"
+				  " title_count, heading_count, meta_count, length FROM Word"
+				  " JOIN Document ON Document.id_doc = Word.id_doc"
+				  " WHERE id_term = ? ORDER BY Word.id_doc;");
+    stmt.bind(1, idTerm);
+    SQLite::Query q = stmt.execQuery();
+
+    Column::Word word = {0, idTerm, 0, 0, 0, 0.0, {0, 0, 0, 0}, ""};
+    unsigned int length;
+    while (!q.eof())
+    {
+      readPosting(q, word, length);
+      ArrayUtils::append(postings, word.idDocument, scorer.score(word, length));
+      q.nextRow();
+    }
+  }
+
+  /*!
+  ** Intersect a posting list with the one of a term. Scores of the
+  ** documents kept are summed. With segments, the postings of the term
+  ** are jumped over with their skip entries, so only the blocks where a
+  ** candidate may be are decoded.
   **
-  ** @return A list of document
+  ** @param term The term to look for
+  ** @param scorer How to score the documents
+  ** @param candidates The sorted posting list to intersect with
+  ** @param dst Where to store the result, must not be the candidates
+  */
+  void
+  Database::intersectPostings(const std::string& term,
+			      Search::Scorer& scorer,
+			      const PostingList& candidates,
+			      PostingList& dst)
+  {
+    assert(term != "");
+    if (!_manifest.get())
+    {
+      PostingList postings;
+      getPostings(term, scorer, postings);
+      ArrayUtils::intersect(candidates, postings, dst);
+      return;
+    }
+
+    ArrayUtils::clear(dst);
+    if (candidates.ids.empty())
+      return;
+
+    std::vector<Segment::Iterator> lists;
+    findPostings(term, scorer, lists);
+    PostingList part;
+    PostingList merged;
+    for (std::vector<Segment::Iterator>::iterator it = lists.begin();
+	 it != lists.end(); ++it)
+    {
+      ArrayUtils::clear(part);
+      for (unsigned int c = 0; c < candidates.ids.size() && !it->atEnd(); c++)
+      {
+	it->advance(candidates.ids[c]);
+	if (!it->atEnd() && it->getId() == candidates.ids[c])
+	  ArrayUtils::append(part, candidates.ids[c],
+			     candidates.scores[c] + scorePosting(*it, scorer));
+      }
+      ArrayUtils::unite(dst, part, merged);
+      ArrayUtils::swap(dst, merged);
+    }
+  }
+
+  /*!
+  ** Get the positions of a term in some documents. With segments, the
+  ** postings of the term are jumped over with their skip entries.
+  **
+  ** @param term The term to look for
+  ** @param candidates The sorted documents
+  ** @param positions Where to store the positions of the term in each
+  ** document, empty if it's not found there
   */
-  const std::list<Column::DocumentResult>
-  Database::getCompleteDocuments(const std::string& condition)
-  {
-    assert(condition != "");
-    std::ostringstream cmd;
-    cmd << "SELECT "
-      "Document.id_doc, hash, filename, date, score, real_term, stem_term "
-      " FROM Document JOIN Word ON Document.id_doc = Word.id_doc"
-	" JOIN Term On Term.id_term = Word.id_term " <<
-      " WHERE " << condition << " ORDER BY score;";
-    const std::list<Column::DocumentWordTerm> lst = getDocumentWords(cmd.str());
-    std::list<Column::DocumentResult> resList;
-    Column::DocumentResult res;
-    for (std::list<Column::DocumentWordTerm>::const_iterator i = lst.begin();
-	 i != lst.end(); ++i)
+  void
+  Database::getPositions(const std::string& term, const PostingList& candidates,
+			 std::vector<std::vector<unsigned int> >& positions)
+  {
+    assert(term != "");
+    positions.assign(candidates.ids.size(), std::vector<unsigned int>());
+    Connection& c = reader();
+    if (_manifest.get())
+    {
+      loadSegments(c);
+      Segment::Iterator it;
+      for (std::vector<Segment*>::const_iterator i = c.segments.begin();
+	   i != c.segments.end(); ++i)
+      {
+	if (!(*i)->find(term, it))
+	  continue;
+	for (unsigned int d = 0; d < candidates.ids.size() && !it.atEnd(); d++)
+	{
+	  it.advance(candidates.ids[d]);
+	  if (!it.atEnd() && it.getId() == candidates.ids[d])
+	  {
+	    const std::string encoded = it.getPositions();
+	    Utils::decodePositions(encoded.data(), encoded.length(), positions[d]);
+	  }
+	}
+      }
+      return;
+    }
+
+    SQLite::Statement& find =
+      c.db.cachedStatement("SELECT id_term FROM Term WHERE real_term = ?;");
+    find.bind(1, term.c_str());
+    SQLite::Query t = find.execQuery();
+    if (t.eof())
+      return;
+    const unsigned int idTerm = t.getIntField(0);
+    t.finalize();
+
+    SQLite::Statement& stmt =
+      c.db.cachedStatement("SELECT positions FROM Word WHERE id_doc = ? AND id_term = ?;");
+    for (unsigned int d = 0; d < candidates.ids.size(); d++)
     {
-      res.id = i->Column::Document::id;
-      res.filename = i->filename;
-      res.type = i->type;
-      res.hash = i->hash;
-      res.date = i->date;
-      res.type = i->type;
-      res.length = i->length;
-      res.idDoc = i->Column::Document::id;
-      res.rank = i->score;
-      resList.push_back(res);
+      stmt.bind(1, candidates.ids[d]);
+      stmt.bind(2, idTerm);
+      SQLite::Query q = stmt.execQuery();
+      if (q.eof())
+	continue;
+      int length = 0;
+      const unsigned char* data = q.getBlobField(0, length);
+      Utils::decodePositions(reinterpret_cast<const char*>(data), length, positions[d]);
     }
+  }
+
+  /*!
+  ** Find a term, and give its statistics to a scorer. Its number of
+  ** documents is kept in Term by triggers on Word.
+  **
+  ** @param term The term to look for
+  ** @param scorer The scorer of the term
+  **
+  ** @return The term id, or 0 if the term isn't indexed
+  */
+  unsigned int
+  Database::findTerm(const std::string& term, Search::Scorer& scorer)
+  {
+    SQLite::Statement& stmt =
+      reader().db.cachedStatement("SELECT id_term, df FROM Term WHERE real_term = ?;");
+    stmt.bind(1, term.c_str());
+    SQLite::Query q = stmt.execQuery();
+    if (q.eof())
+      return 0;
+
+    const unsigned int idTerm = q.getIntField(0);
+    const unsigned int documentCount = q.getIntField(1);
+    q.finalize();
+    scorer.setTerm(getCollection(), documentCount);
+
+    return idTerm;
+  }
+
+  /*!
+  ** Find the postings of a term in all segments, and give its statistics
+  ** to a scorer. Its number of documents is the number of its live
+  ** postings, so that it doesn't change when segments are merged.
+  **
+  ** @param term The term to look for
+  ** @param scorer The scorer of the term
+  ** @param postings Where to store the postings of each segment
+  ** containing the term, from the newest segment to the oldest
+  */
+  void
+  Database::findPostings(const std::string& term, Search::Scorer& scorer,
+			 std::vector<Segment::Iterator>& postings)
+  {
+    Connection& c = reader();
+    loadSegments(c);
+    postings.clear();
+    unsigned int documentCount = 0;
+    Segment::Iterator it;
+    for (std::vector<Segment*>::const_iterator i = c.segments.begin();
+	 i != c.segments.end(); ++i)
+      if ((*i)->find(term, it))
+      {
+	documentCount += it.getLiveCount();
+	postings.push_back(it);
+      }
+    scorer.setTerm(getCollection(), documentCount);
+  }
+
+  /*!
+  ** Get the read-only connection of the calling thread, opening it on
+  ** first use. It's closed when the thread ends.
+  **
+  ** @return The connection
+  */
+  Database::Connection&
+  Database::reader()
+  {
+    Connection* c = _readers.get();
+    if (c)
+      return *c;
+
+    c = new Connection();
+    _readers.reset(c);
+    c->db.open(_filename.c_str(), true);
 
-    return resList;
+    return *c;
   }
 
+  /*!
+  ** Map the live segments of a connection, if not done yet or if they
+  ** changed since, the newest first, unless it's in a snapshot. The
+  ** segments still live stay mapped. A segment may be removed by a merge
+  ** before being mapped, then the manifest is read again.
+  **
+  ** @param c The connection
+  */
+  void
+  Database::loadSegments(Connection& c)
+  {
+    if (c.snapshot && c.segmentsLoaded)
+      return;
+    _manifest->refresh();
+    if (c.segmentsLoaded && _manifest->getVersion() == c.segmentsVersion)
+      return;
+
+    c.segmentsLoaded = false;
+    for (unsigned int attempt = 0; attempt < 3; attempt++)
+    {
+      SegmentManifest::idArray ids;
+      const unsigned int version = _manifest->getSegments(ids);
+      if (_manifest->open(ids, c.segments))
+      {
+	c.segmentsVersion = version;
+	c.segmentsLoaded = true;
+	return;
+      }
+      _manifest->refresh();
+    }
+    std::cerr << "Can't map the segments of the index" << std::endl;
+  }
 }
@@ -4,16 +4,84 @@
 # include <iostream>
 # include <cassert>
 # include <list>
+# include <map>
+# include <memory>
+# include <set>
+# include <vector>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/tss.hpp>
 # include "Utils.hh"
 # include "Column.hh"
 # include "Singleton.hh"
 # include "SQLiteDB.hh"
+# include "SQLiteException.hh"
+# include "ArrayUtils.hh"
+# include "TopK.hh"
+# include "Scorer.hh"
+# include "Segment.hh"
+# include "SegmentWriter.hh"
+# include "SegmentManifest.hh"
+# include "SegmentMerger.hh"
 
 namespace Index
 {
+  /*!
+  ** The index database. Documents, terms, cached searches and lists are
+  ** stored with SQLite, with the statistics of the collection used to
+  ** rank documents. Postings are stored either in its Word table, or
+  ** with the "segment" storage engine, in immutable segment files next
+  ** to it, which are merged in the background. With segments, the hash
+  ** of a document is only written once its postings are, so an
+  ** interrupted indexation reads it again.
+  **
+  ** The database is in WAL mode: a single connection writes, while each
+  ** thread searches with its own read-only connection, which neither
+  ** waits for the writer nor makes it wait.
+  */
   class Database : public Singleton<Database>
   {
     friend class Singleton<Database>;
+    typedef std::map<std::string, std::string> hashMap;
+
+    // Time to wait for the writer lock when saving results, in milliseconds
+    static const int SAVE_TIMEOUT = 100;
+
+    /*!
+    ** The read-only connection of a thread, with the segments it maps.
+    ** They are kept during a snapshot.
+    */
+    struct Connection
+    {
+      SQLite::DB		db;
+      std::vector<Segment*>	segments;
+      bool			segmentsLoaded;
+      unsigned int		segmentsVersion;
+      bool			snapshot;
+
+      Connection();
+      ~Connection();
+      void unloadSegments();
+    };
+
+  public:
+    // Number of buffered postings from which a segment is written
+    static const unsigned int FLUSH_SIZE = 1000000;
+
+    /*!
+    ** Read the index from a single snapshot while it lives: the calling
+    ** thread sees neither the changes committed since, nor the segments
+    ** written since.
+    */
+    class Snapshot
+    {
+    public:
+      Snapshot();
+      ~Snapshot();
+
+    private:
+      Snapshot(const Snapshot& snapshot);
+      Snapshot& operator=(const Snapshot& snapshot);
+    };
 
   private:
     Database();
@@ -23,11 +91,17 @@ namespace Index
     void open(const std::string& filename);
     void close();
     void createDatabase();
+    void migrate();
     void dumpAll();
     void dump(const std::string& tableName);
     void beginTransaction();
     void endTransaction();
     void clearSearchCache();
+    void flush();
+    unsigned int compact();
+    unsigned int getDataVersion();
+    void beginSnapshot();
+    void endSnapshot();
 
     /*!
     ** DAO
@@ -35,25 +109,40 @@ namespace Index
   public:
     const Column::Document getDocumentByFilename(const std::string& filename);
     const Column::Document getDocumentById(const unsigned int idDoc);
+    const std::list<Column::Document> getDocumentsUnder(const std::string& directory);
     const Column::Word getWordByIds(const unsigned int idDocument, const unsigned int idTerm);
     const Column::Term getTermById(const unsigned int idTerm);
     const Column::Term getTermByName(const std::string& termName);
     void addOrUpdateDocument(const Column::Document& doc);
     void addWord(const Column::Word& word);
+    void addWord(const std::string& realTerm, const std::string& stemTerm,
+		 Column::Word& word, const unsigned int length);
     void updateWord(const Column::Word& word);
     void addOrUpdateTerm(const Column::Term& term);
-    int getStemNumber(const Column::Word& word, const std::string& stem);
-    void updateTermScore(const Column::Document& doc);
-    void updateAllStemNumber(const Column::Word& word,
-			     const std::string& stem,
-			     const unsigned int stemCount);
     void deleteDocument(const Column::Document& doc, const bool erase);
-    const std::list<Column::DocumentResult> getCompleteDocuments(const std::string& condition);
+    unsigned int deleteUnusedTerms();
+    const std::list<std::string> getDocumentTerms(const unsigned int idDoc);
+    const Column::Collection getCollection();
+    void getPostings(const std::string& term, Search::Scorer& scorer,
+		     PostingList& postings);
+    void intersectPostings(const std::string& term, Search::Scorer& scorer,
+			   const PostingList& candidates, PostingList& dst);
+    void getBestDocuments(const std::string& term, const unsigned int k,
+			  Search::Scorer& scorer, TopK& top);
+    void getDocumentsByDate(const long long from, const long long to,
+			    PostingList& postings);
+    void getPositions(const std::string& term, const PostingList& candidates,
+		      std::vector<std::vector<unsigned int> >& positions);
     unsigned int getSimilarRequest(const std::string& query);
+    void getLiveSearches(const std::set<unsigned int>& searches,
+			 std::set<unsigned int>& live);
     const std::list<Column::DocumentResult> getCachedSearchResult(const unsigned int id);
     void saveResult(const Column::Result& res, const double rank);
-    void saveResults(const std::list<Column::DocumentResult>& list,
-		     const std::string& sentence);
+    unsigned int saveResults(const std::list<Column::DocumentResult>& list,
+			     const std::string& sentence,
+			     const std::vector<std::string>& terms);
+    unsigned int invalidateSearches(const unsigned int idDoc);
+    unsigned int invalidateSearches(const SegmentWriter& writer);
 
     /*!
     ** Templated DAO
@@ -66,14 +155,40 @@ namespace Index
     ** Private inlined DAO Helpers
     */
   private:
-    const Column::Document getDocument(const std::string& request);
-    const Column::Word getWord(const std::string& request);
-    const Column::Term getTerm(const std::string& request);
-    const std::list<Column::DocumentWordTerm> getDocumentWords(const std::string& request);
-    const std::list<Column::DocumentResult> getDocumentResults(const std::string& request);
+    void readDocument(SQLite::Query& q, Column::Document& doc);
+    const Column::Document getDocument(SQLite::Query& q);
+    const std::list<Column::Document> getDocuments(SQLite::Query& q);
+    const Column::Word getWord(SQLite::Query& q);
+    void readPosting(SQLite::Query& q, Column::Word& word, unsigned int& length);
+    static void setBodyCount(Column::Word& word);
+    const Column::Term getTerm(SQLite::Query& q);
+    const std::list<Column::DocumentResult> getDocumentResults(SQLite::Query& q);
+    unsigned int saveSearch(const std::list<Column::DocumentResult>& list,
+			    const std::string& sentence,
+			    const std::vector<std::string>& terms);
+    void deleteSearches(const std::set<unsigned int>& searches);
+
+    /*!
+    ** Segments
+    */
+  private:
+    Connection& reader();
+    void loadSegments(Connection& c);
+    unsigned int findTerm(const std::string& term, Search::Scorer& scorer);
+    void findPostings(const std::string& term, Search::Scorer& scorer,
+		      std::vector<Segment::Iterator>& postings);
+    static double scorePosting(const Segment::Iterator& it,
+			       const Search::Scorer& scorer);
 
   private:
-    SQLite::DB	_db;
+    std::string				_filename;
+    SQLite::DB				_db;
+    boost::mutex			_saving;
+    boost::thread_specific_ptr<Connection>	_readers;
+    std::auto_ptr<SegmentManifest>	_manifest;
+    std::auto_ptr<SegmentMerger>	_merger;
+    SegmentWriter			_writer;
+    hashMap				_hashes;
   };
 }
 
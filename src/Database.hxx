@@ -6,57 +6,80 @@ namespace Index
   inline void
   Database::beginTransaction()
   {
-    _db.execDML("begin transaction;");
+    _db.cachedStatement("begin transaction;").execDML();
   }
 
   /*!
-  ** End a transaction
+  ** End a transaction. With segments, a new one is written once enough
+  ** postings were buffered.
   */
   inline void
   Database::endTransaction()
   {
-    _db.execDML("commit transaction;");
+    _db.cachedStatement("commit transaction;").execDML();
+    if (_writer.size() >= FLUSH_SIZE)
+      flush();
   }
 
   /*!
-  ** Get a document using a request.
+  ** Read the document of the current row of an executed query.
   **
-  ** @param request The request to execute
-  **
-  ** @return A document filled with all information, else an id doc equal to 0
+  ** @param q The query to read
+  ** @param doc The document to fill
   */
-  inline const Column::Document
-  Database::getDocument(const std::string& request)
+  inline void
+  Database::readDocument(SQLite::Query& q, Column::Document& doc)
   {
-    SQLite::Query q = _db.execQuery(request.c_str());
-    Column::Document doc = {0, "", File::TEXT, "", "", 0};
-    if (!q.eof())
+    for (int fld = 0; fld < q.numFields(); fld++)
     {
-      for (int fld = 0; fld < q.numFields(); fld++)
-      {
-	if (std::string(q.fieldName(fld)) == "id_doc")
-	  doc.id = Utils::stringToInt(q.fieldValue(fld));
+      if (std::string(q.fieldName(fld)) == "id_doc")
+	doc.id = Utils::stringToInt(q.fieldValue(fld));
+      else
+	if (std::string(q.fieldName(fld)) == "filename")
+	  doc.filename = q.fieldValue(fld);
 	else
-	  if (std::string(q.fieldName(fld)) == "filename")
-	    doc.filename = q.fieldValue(fld);
+	  if (std::string(q.fieldName(fld)) == "type")
+	  {
+	    unsigned int t = Utils::stringToInt(q.fieldValue(fld));
+	    doc.type = t == File::HTML ? File::HTML : File::TEXT;
+	  }
 	  else
-	    if (std::string(q.fieldName(fld)) == "type")
-	    {
-	      unsigned int t = Utils::stringToInt(q.fieldValue(fld));
-	      doc.type = t == File::HTML ? File::HTML : File::TEXT;
-	    }
+	    if (std::string(q.fieldName(fld)) == "hash")
+	      doc.hash = q.fieldValue(fld);
 	    else
-	      if (std::string(q.fieldName(fld)) == "hash")
-		doc.hash = q.fieldValue(fld);
+	      if (std::string(q.fieldName(fld)) == "date")
+		doc.date = q.getInt64Field(fld);
 	      else
-		if (std::string(q.fieldName(fld)) == "date")
-		  doc.date = q.fieldValue(fld);
+		if (std::string(q.fieldName(fld)) == "length")
+		  doc.length = Utils::stringToInt(q.fieldValue(fld));
 		else
-		  if (std::string(q.fieldName(fld)) == "length")
-		    doc.length = Utils::stringToInt(q.fieldValue(fld));
+		  if (std::string(q.fieldName(fld)) == "size")
+		    doc.size = q.getInt64Field(fld);
 		  else
-		    assert(false);
-      }
+		    if (std::string(q.fieldName(fld)) == "mtime")
+		      doc.mtime = q.getInt64Field(fld);
+		    else
+		      if (std::string(q.fieldName(fld)) == "inode")
+			doc.inode = q.getInt64Field(fld);
+		      else
+			assert(false);
+    }
+  }
+
+  /*!
+  ** Get a document from an executed query.
+  **
+  ** @param q The query to read
+  **
+  ** @return A document filled with all information, else an id doc equal to 0
+  */
+  inline const Column::Document
+  Database::getDocument(SQLite::Query& q)
+  {
+    Column::Document doc = {0, "", File::TEXT, "", 0, 0, 0, 0, 0};
+    if (!q.eof())
+    {
+      readDocument(q, doc);
       q.nextRow();
     }
     assert(q.eof());
@@ -65,17 +88,39 @@ namespace Index
   }
 
   /*!
-  ** Get a word using a request.
+  ** Get all documents from an executed query.
+  **
+  ** @param q The query to read
+  **
+  ** @return A list of documents filled with all information
+  */
+  inline const std::list<Column::Document>
+  Database::getDocuments(SQLite::Query& q)
+  {
+    std::list<Column::Document> docList;
+
+    while (!q.eof())
+    {
+      Column::Document doc = {0, "", File::TEXT, "", 0, 0, 0, 0, 0};
+      readDocument(q, doc);
+      docList.push_back(doc);
+      q.nextRow();
+    }
+
+    return docList;
+  }
+
+  /*!
+  ** Get a word from an executed query.
   **
-  ** @param request The request to execute
+  ** @param q The query to read
   **
   ** @return A word filled with all information, else an id_doc and an idTerm equal to 0
   */
   inline const Column::Word
-  Database::getWord(const std::string& request)
+  Database::getWord(SQLite::Query& q)
   {
-    SQLite::Query q = _db.execQuery(request.c_str());
-    Column::Word word = {0, 0, 0, 0, 0, 0.0};
+    Column::Word word = {0, 0, 0, 0, 0, 0.0, {0, 0, 0, 0}, ""};
     if (!q.eof())
     {
       for (int fld = 0; fld < q.numFields(); fld++)
@@ -98,8 +143,25 @@ namespace Index
 		  if (std::string(q.fieldName(fld)) == "score")
 		    word.score = Utils::stringToDouble(q.fieldValue(fld));
 		  else
-		    assert(false);
+		    if (std::string(q.fieldName(fld)) == "title_count")
+		      word.fieldCounts[Field::TITLE] = q.getIntField(fld);
+		    else
+		      if (std::string(q.fieldName(fld)) == "heading_count")
+			word.fieldCounts[Field::HEADING] = q.getIntField(fld);
+		      else
+			if (std::string(q.fieldName(fld)) == "meta_count")
+			  word.fieldCounts[Field::META] = q.getIntField(fld);
+			else
+			  if (std::string(q.fieldName(fld)) == "positions")
+			  {
+			    int length = 0;
+			    const unsigned char* data = q.getBlobField(fld, length);
+			    word.positions.assign(reinterpret_cast<const char*>(data), length);
+			  }
+			  else
+			    assert(false);
       }
+      setBodyCount(word);
       q.nextRow();
     }
     assert(q.eof());
@@ -108,75 +170,71 @@ namespace Index
   }
 
   /*!
-  ** Get a document word using a request.
-  **
-  ** @param request The request to execute
+  ** Read the word of the current row of an executed posting query: its
+  ** document, counts and score, then the length of the document.
   **
-  ** @return A document filled with all information, else an id doc equal to 0
+  ** @param q The query to read
+  ** @param word The word to fill
+  ** @param length Where to store the length of the document
   */
-  inline const std::list<Column::DocumentWordTerm>
-  Database::getDocumentWords(const std::string& request)
+  inline void
+  Database::readPosting(SQLite::Query& q, Column::Word& word, unsigned int& length)
   {
-    SQLite::Query q = _db.execQuery(request.c_str());
-    std::list<Column::DocumentWordTerm> docList;
+    word.idDocument = q.getIntField(0);
+    word.realCount = q.getIntField(1);
+    word.stemCount = q.getIntField(2);
+    word.score = q.getFloatField(3);
+    word.fieldCounts[Field::TITLE] = q.getIntField(4);
+    word.fieldCounts[Field::HEADING] = q.getIntField(5);
+    word.fieldCounts[Field::META] = q.getIntField(6);
+    setBodyCount(word);
+    length = q.getIntField(7);
+  }
 
-    while (!q.eof())
-    {
-      Column::DocumentWordTerm doc;
-      for (int fld = 0; fld < q.numFields(); fld++)
-      {
+  /*!
+  ** Count in the body the occurences of a word which are in no other
+  ** field. Words indexed without their fields are all in the body.
+  **
+  ** @param word The word, whose other fields are counted
+  */
+  inline void
+  Database::setBodyCount(Column::Word& word)
+  {
+    const unsigned int others = word.fieldCounts[Field::TITLE] +
+      word.fieldCounts[Field::HEADING] + word.fieldCounts[Field::META];
+    word.fieldCounts[Field::BODY] = word.realCount > others ? word.realCount - others : 0;
+  }
 
-	if (std::string(q.fieldName(fld)) == "id_doc")
-	  doc.Column::Document::id = Utils::stringToInt(q.fieldValue(fld));
-	else if (std::string(q.fieldName(fld)) == "filename")
-	  doc.filename = q.fieldValue(fld);
-	else if (std::string(q.fieldName(fld)) == "type")
-	{
-	  unsigned int t = Utils::stringToInt(q.fieldValue(fld));
-	  doc.type = t == File::HTML ? File::HTML : File::TEXT;
-	}
-	else if (std::string(q.fieldName(fld)) == "hash")
-	  doc.hash = q.fieldValue(fld);
-	else if (std::string(q.fieldName(fld)) == "date")
-	  doc.date = q.fieldValue(fld);
-	else if (std::string(q.fieldName(fld)) == "length")
-	  doc.length = Utils::stringToInt(q.fieldValue(fld));
-	else if (std::string(q.fieldName(fld)) == "id_term")
-	  doc.idTerm = Utils::stringToInt(q.fieldValue(fld));
-	else if (std::string(q.fieldName(fld)) == "weight")
-	  doc.weight = Utils::stringToDouble(q.fieldValue(fld));
-	else if (std::string(q.fieldName(fld)) == "real_count")
-	  doc.realCount = Utils::stringToInt(q.fieldValue(fld));
-	else if (std::string(q.fieldName(fld)) == "stem_count")
-	  doc.stemCount = Utils::stringToInt(q.fieldValue(fld));
-	else if (std::string(q.fieldName(fld)) == "score")
-	  doc.score = Utils::stringToDouble(q.fieldValue(fld));
-	else if (std::string(q.fieldName(fld)) == "real_term")
-	  doc.realTerm = q.fieldValue(fld);
-	else if (std::string(q.fieldName(fld)) == "stem_term")
-	  doc.stemTerm = q.fieldValue(fld);
-	else
-	  assert(false);
-      }
-      docList.push_back(doc);
-      q.nextRow();
-    }
-    assert(q.eof());
+  /*!
+  ** Score the current posting of a segment. Precomputed scores are read
+  ** as is, without looking for the length of the document.
+  **
+  ** @param it The postings of a term, not at their end
+  ** @param scorer The scorer, already given the statistics of the term
+  **
+  ** @return The score
+  */
+  inline double
+  Database::scorePosting(const Segment::Iterator& it, const Search::Scorer& scorer)
+  {
+    if (scorer.isPrecomputed())
+      return it.getScore();
 
-    return docList;
+    Column::Word word;
+    it.getWord(word);
+    return scorer.score(word, it.getLength());
   }
 
   /*!
-  ** Get a document result using a request.
+  ** Get a document result from an executed query.
   **
-  ** @param request The request to execute
+  ** @param q The query to read
   **
   ** @return A document filled with all information, else an id doc equal to 0
   */
   inline const std::list<Column::DocumentResult>
-  Database::getDocumentResults(const std::string& request)
+  Database::getDocumentResults(SQLite::Query& q)
   {
-    SQLite::Query q = _db.execQuery(request.c_str());
     std::list<Column::DocumentResult> docList;
 
     Column::DocumentResult doc;
@@ -199,7 +257,7 @@ namespace Index
 	else if (std::string(q.fieldName(fld)) == "hash")
 	  doc.hash = q.fieldValue(fld);
 	else if (std::string(q.fieldName(fld)) == "date")
-	  doc.date = q.fieldValue(fld);
+	  doc.date = q.getInt64Field(fld);
 	else if (std::string(q.fieldName(fld)) == "length")
 	  doc.length = Utils::stringToInt(q.fieldValue(fld));
 	else if (std::string(q.fieldName(fld)) == "id_search")
@@ -216,17 +274,16 @@ namespace Index
   }
 
   /*!
-  ** Get a term using a request.
+  ** Get a term from an executed query.
   **
-  ** @param request The request to execute
+  ** @param q The query to read
   **
   ** @return A term filled with all information, else an id term equal to 0
   */
   inline const Column::Term
-  Database::getTerm(const std::string& request)
+  Database::getTerm(SQLite::Query& q)
   {
-    SQLite::Query q = _db.execQuery(request.c_str());
-    Column::Term term = {0, "",""};
+    Column::Term term = {0, "", "", 0};
     if (!q.eof())
     {
       for (int fld = 0; fld < q.numFields(); fld++)
@@ -240,7 +297,10 @@ namespace Index
 	    if (std::string(q.fieldName(fld)) == "stem_term")
 	      term.stemTerm = q.fieldValue(fld);
 	    else
-	      assert(false);
+	      if (std::string(q.fieldName(fld)) == "df")
+		term.documentCount = q.getIntField(fld);
+	      else
+		assert(false);
       }
       q.nextRow();
     }
@@ -249,23 +309,6 @@ namespace Index
     return term;
   }
 
-  /*!
-  ** Update all score for all word in a document, adjusting
-  ** it with the given document length.
-  **
-  ** @param doc The document where the words are
-  */
-  inline void
-  Database::updateTermScore(const Column::Document& doc)
-  {
-    std::ostringstream cmd;
-    cmd << "UPDATE Word SET " <<
-      "score = 100 * (score / " << doc.length <<
-      ") WHERE id_doc = " << doc.id << ";";
-
-    _db.execDML(cmd.str().c_str());
-  }
-
   /*!
   ** Fill the black list.
   **
@@ -296,9 +339,10 @@ namespace Index
   inline unsigned int
   Database::getSimilarRequest(const std::string& query)
   {
-    const std::string cmd = "SELECT id_search FROM Search WHERE"
-      " sentence = '" + query + "';";
-    SQLite::Query q = _db.execQuery(cmd.c_str());
+    SQLite::Statement& stmt =
+      reader().db.cachedStatement("SELECT id_search FROM Search WHERE sentence = ?;");
+    stmt.bind(1, query.c_str());
+    SQLite::Query q = stmt.execQuery();
     unsigned int i = 0;
     if (!q.eof())
     {
@@ -312,6 +356,30 @@ namespace Index
     return i;
   }
 
+  /*!
+  ** Find which of some searches are still saved, ie weren't invalidated
+  ** since.
+  **
+  ** @param searches The search ids
+  ** @param live Where to store the ids still saved
+  */
+  inline void
+  Database::getLiveSearches(const std::set<unsigned int>& searches,
+			    std::set<unsigned int>& live)
+  {
+    live.clear();
+    SQLite::Statement& stmt =
+      reader().db.cachedStatement("SELECT 1 FROM Search WHERE id_search = ?;");
+    for (std::set<unsigned int>::const_iterator i = searches.begin();
+	 i != searches.end(); ++i)
+    {
+      stmt.bind(1, *i);
+      SQLite::Query q = stmt.execQuery();
+      if (!q.eof())
+	live.insert(*i);
+    }
+  }
+
   /*!
   ** Get all doc associated to the given id.
   **
@@ -322,11 +390,13 @@ namespace Index
   inline const std::list<Column::DocumentResult>
   Database::getCachedSearchResult(const unsigned int id)
   {
-    std::stringstream cmd;
-    cmd << "SELECT * FROM Search JOIN Result ON Search.id_search = Result.id_search"
-      " JOIN Document ON Result.id_doc = Document.id_doc"
-      " WHERE Search.id_search = " << id << ";";
-    return getDocumentResults(cmd.str());
+    SQLite::Statement& stmt =
+      reader().db.cachedStatement("SELECT * FROM Search JOIN Result ON Search.id_search = Result.id_search"
+				  " JOIN Document ON Result.id_doc = Document.id_doc"
+				  " WHERE Search.id_search = ?;");
+    stmt.bind(1, id);
+    SQLite::Query q = stmt.execQuery();
+    return getDocumentResults(q);
   }
 
   /*!
@@ -338,51 +408,109 @@ namespace Index
   Database::saveResult(const Column::Result& res,
 		       const double rank)
   {
-    std::stringstream cmd;
-    cmd << "INSERT INTO Result (id_search, id_doc, rank) "
-      " VALUES(" <<
-      res.idSearch << ", " <<
-      res.idDoc << ", " <<
-      rank << "); ";
-    _db.execDML(cmd.str().c_str());
+    SQLite::Statement& stmt =
+      _db.cachedStatement("INSERT INTO Result (id_search, id_doc, rank) VALUES(?, ?, ?);");
+    stmt.bind(1, res.idSearch);
+    stmt.bind(2, res.idDoc);
+    stmt.bind(3, rank);
+    stmt.execDML();
   }
 
   /*!
   ** Save the results in database, hence cache all search.
+  ** The terms of the search are saved too, to know when to invalidate it.
+  ** Searching threads save them one at a time, with the writer
+  ** connection. They aren't saved if another process, like the
+  ** indexer, keeps writing: a search doesn't wait for it.
   **
   ** @param list The list of found document
+  ** @param sentence The normalized search
+  ** @param terms The terms of the search
+  **
+  ** @return The id of the saved search, or 0 if it wasn't saved
   */
-  inline void
+  inline unsigned int
   Database::saveResults(const std::list<Column::DocumentResult>& list,
-			const std::string& sentence)
+			const std::string& sentence,
+			const std::vector<std::string>& terms)
+  {
+    boost::mutex::scoped_lock lock(_saving);
+    const int timeout = _db.getBusyTimeout();
+    _db.setBusyTimeout(SAVE_TIMEOUT);
+    unsigned int id = 0;
+    try
+    {
+      id = saveSearch(list, sentence, terms);
+    }
+    catch (SQLite::Exception& ex)
+    {
+      _db.setBusyTimeout(timeout);
+      if (ex.errorCode() != SQLITE_BUSY)
+	throw;
+      _db.cachedStatement("rollback transaction;").execDML();
+      return 0;
+    }
+    _db.setBusyTimeout(timeout);
+
+    return id;
+  }
+
+  /*!
+  ** Save a search and its results, in a transaction.
+  **
+  ** @param list The list of found document
+  ** @param sentence The normalized search
+  ** @param terms The terms of the search
+  **
+  ** @return The id of the search
+  */
+  inline unsigned int
+  Database::saveSearch(const std::list<Column::DocumentResult>& list,
+		       const std::string& sentence,
+		       const std::vector<std::string>& terms)
   {
+    beginTransaction();
+
     // Save the search
-    std::stringstream cmd;
-    cmd << "INSERT INTO Search(id_search, sentence) "
-      "VALUES(NULL, '" << sentence << "');";
-    _db.execDML(cmd.str().c_str());
+    SQLite::Statement& stmt =
+      _db.cachedStatement("INSERT INTO Search(id_search, sentence) VALUES(NULL, ?);");
+    stmt.bind(1, sentence.c_str());
+    stmt.execDML();
 
     // Save all results attached to this search
-    unsigned int id = getSimilarRequest(sentence);
     Column::Result res;
-    res.idSearch = id;
-    beginTransaction();
+    res.idSearch = static_cast<unsigned int>(_db.lastRowId());
     for (std::list<Column::DocumentResult>::const_iterator iter = list.begin();
 	 iter != list.end(); ++iter)
     {
       res.idDoc = iter->Column::Document::id;
       saveResult(res, iter->rank);
     }
+
+    // Save the terms of this search
+    for (std::vector<std::string>::const_iterator iter = terms.begin();
+	 iter != terms.end(); ++iter)
+    {
+      SQLite::Statement& term =
+	_db.cachedStatement("INSERT INTO SearchTerm(id_search, term) VALUES(?, ?);");
+      term.bind(1, res.idSearch);
+      term.bind(2, iter->c_str());
+      term.execDML();
+    }
     endTransaction();
+
+    return res.idSearch;
   }
 
   /*!
-  ** Clear all search cache, deleting all data in Search and Result tables.
+  ** Clear all search cache, deleting all data in Search, Result and
+  ** SearchTerm tables.
   */
   inline void
   Database::clearSearchCache()
   {
     _db.execDML("DELETE FROM Search;");
     _db.execDML("DELETE FROM Result;");
+    _db.execDML("DELETE FROM SearchTerm;");
   }
 }
@@ -1,61 +1,94 @@
+#include <cstdlib>
+#include <ctime>
 #include "DateUtils.hh"
+#include "ParseException.hh"
 
 /*!
-** Convert a timestamp to a formatted date.
+** Convert a timestamp to a formatted date, like dd/mm/yyyy.
 **
-** @param timestamp The string timestamp
+** @param timestamp The timestamp
 **
 ** @return A formatted date
 */
 std::string
-DateUtils::timestampToStringDate(const unsigned long timestamp)
+DateUtils::timestampToStringDate(const long long timestamp)
 {
   std::tm time;
   std::time_t ctimestamp = static_cast<std::time_t>(timestamp);
   boost::date_time::c_time::localtime(&ctimestamp, &time);
   std::ostringstream format;
-  format << time.tm_mday << '/' << time.tm_mon << '/' << (time.tm_year + 1900);
+  format << time.tm_mday << '/' << (time.tm_mon + 1) << '/' << (time.tm_year + 1900);
   return format.str();
 }
 
 /*!
-** Convert a string timestamp to a formatted date.
+** Convert a date, ie like dd/mm/yy, dd/mm/yyyy, "now", "tomorrow" or
+** "yesterday", to the timestamp of the beginning of its day, in local
+** time. Years of two digits are between 1970 and 2069.
+** Throw a parse error on an invalid date.
 **
-** @param timestamp The string timestamp
+** @param date The formatted date
 **
-** @return A formatted date
+** @return A timestamp
 */
-std::string
-DateUtils::timestampToStringDate(const std::string timestamp)
+long long
+DateUtils::stringDateToTimestamp(const std::string& date)
 {
-  unsigned long t;
-  Utils::fromString(t, timestamp);
-  return timestampToStringDate(t);
+  std::tm time;
+  std::time_t now = std::time(0);
+  boost::date_time::c_time::localtime(&now, &time);
+  time.tm_hour = 0;
+  time.tm_min = 0;
+  time.tm_sec = 0;
+  time.tm_isdst = -1;
+
+  if (date == "tomorrow")
+    time.tm_mday++;
+  else
+    if (date == "yesterday")
+      time.tm_mday--;
+    else
+      if (date != "now")
+      {
+	const std::string::size_type first = date.find('/');
+	const std::string::size_type second = date.find('/', first + 1);
+	if (first == std::string::npos || second == std::string::npos)
+	  throw Search::Request::ParseException("Invalid date " + date);
+	const int day = atoi(date.substr(0, first).c_str());
+	const int month = atoi(date.substr(first + 1, second - first - 1).c_str());
+	int year = atoi(date.substr(second + 1).c_str());
+	if (date.length() - second - 1 <= 2)
+	  year += year < 70 ? 2000 : 1900;
+	time.tm_mday = day;
+	time.tm_mon = month - 1;
+	time.tm_year = year - 1900;
+
+	// mktime() accepts days out of their month, so check it kept them
+	std::tm check = time;
+	if (std::mktime(&check) == -1 || check.tm_mday != day ||
+	    check.tm_mon != month - 1 || check.tm_year != year - 1900)
+	  throw Search::Request::ParseException("Invalid date " + date);
+      }
+
+  return std::mktime(&time);
 }
 
 /*!
-** Convert a string date format, ie like jj/mm/yyyy to a timestamp.
-** Can throw a parse error.
+** Get the beginning of the day after the one of a timestamp, in local
+** time, whatever the length of the day.
 **
-** @param date The formatted date.
+** @param timestamp The timestamp of the beginning of a day
 **
-** @return A timestamp
+** @return The timestamp of the beginning of the next day
 */
-unsigned long
-DateUtils::stringDateToTimestamp(const std::string& date)
+long long
+DateUtils::nextDay(const long long timestamp)
 {
-  // FIXME : split chain
-  // FIXME : throw an error on invalid date.
-
-  // 4 Cases :
-  // * :date(xx/xx/xx)
-  // * :date(> xx/xx/xx)
-  // * :date(< xx/xx/xx)
-  // * :date(xx/xx/xx - xx/xx/xx)
-  //
-  // Just get the date ? ok
-
-  date.find_first_of('/');
+  std::tm time;
+  std::time_t ctimestamp = static_cast<std::time_t>(timestamp);
+  boost::date_time::c_time::localtime(&ctimestamp, &time);
+  time.tm_mday++;
+  time.tm_isdst = -1;
 
-  return 0/*FIXME*/;
+  return std::mktime(&time);
 }
@@ -4,12 +4,16 @@
 # include "Utils.hh"
 # include <boost/date_time.hpp>
 
+/*!
+** Convert dates between timestamps, as stored for documents, and the
+** formats of requests and results. Days are the ones of local time.
+*/
 class DateUtils
 {
 public:
-  static std::string timestampToStringDate(const unsigned long timestamp);
-  static std::string timestampToStringDate(const std::string timestamp);
-  static unsigned long stringDateToTimestamp(const std::string& date);
+  static std::string timestampToStringDate(const long long timestamp);
+  static long long stringDateToTimestamp(const std::string& date);
+  static long long nextDay(const long long timestamp);
 };
 
 #endif /* !DATEUTILS_HH_ */
@@ -0,0 +1,191 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <boost/thread/once.hpp>
+#include "DocumentSource.hh"
+
+namespace Index
+{
+  namespace
+  {
+    // Size of the blocks read from a file which can't be mapped
+    static const unsigned int READ_SIZE = 64 * 1024;
+
+    // Documents mapped by the current thread, the last one first
+    static __thread DocumentSource* mapped = 0;
+
+    // Action of SIGBUS before the mapped documents were guarded
+    static struct sigaction previous;
+
+    // Size of a memory page
+    static long pageSize = 0;
+
+    static boost::once_flag guarded = BOOST_ONCE_INIT;
+  }
+
+  /*!
+  ** Construct an empty document source.
+  */
+  DocumentSource::DocumentSource()
+    : _map(0), _length(0), _truncated(0), _next(0)
+  {
+  }
+
+  /*!
+  ** Destruct a document source, unmapping the document.
+  */
+  DocumentSource::~DocumentSource()
+  {
+    close();
+  }
+
+  /*!
+  ** Open a document. A non empty regular file is mapped, and the
+  ** kernel is told it will be read sequentially, so it reads ahead.
+  **
+  ** @param filename The path of the document
+  **
+  ** @return If the document could be read
+  */
+  bool
+  DocumentSource::open(const std::string& filename)
+  {
+    close();
+
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat st;
+    bool res = fstat(fd, &st) == 0;
+    if (res && !(S_ISREG(st.st_mode) && st.st_size > 0 && st.st_size <= INT_MAX &&
+		 map(fd, static_cast<unsigned int>(st.st_size))))
+      res = read(fd);
+    ::close(fd);
+
+    return res;
+  }
+
+  /*!
+  ** Release the document.
+  */
+  void
+  DocumentSource::close()
+  {
+    if (_map)
+    {
+      DocumentSource** source = &mapped;
+      while (*source && *source != this)
+	source = &(*source)->_next;
+      if (*source)
+	*source = _next;
+      munmap(_map, _length);
+    }
+    _map = 0;
+    _length = 0;
+    _buffer.clear();
+    _truncated = 0;
+    _next = 0;
+  }
+
+  /*!
+  ** Map a regular file, guarded against its truncation.
+  **
+  ** @param fd The opened file
+  ** @param length The size of the file
+  **
+  ** @return If the file was mapped
+  */
+  bool
+  DocumentSource::map(const int fd, const unsigned int length)
+  {
+    boost::call_once(&DocumentSource::guard, guarded);
+    void* addr = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+      return false;
+    madvise(addr, length, MADV_SEQUENTIAL);
+
+    _map = addr;
+    _length = length;
+    _next = mapped;
+    mapped = this;
+
+    return true;
+  }
+
+  /*!
+  ** Catch the SIGBUS raised when a page of a truncated file is read,
+  ** once for all threads.
+  */
+  void
+  DocumentSource::guard()
+  {
+    pageSize = sysconf(_SC_PAGESIZE);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof (action));
+    action.sa_sigaction = onBusError;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGBUS, &action, &previous);
+  }
+
+  /*!
+  ** Signal handler: if the faulting address is in a document mapped by
+  ** the thread, its pages from there to the end are replaced by zeros,
+  ** and the document is known truncated. Reading goes on. Any other
+  ** fault is raised again with the previous action.
+  **
+  ** @param info Where the fault occured
+  */
+  void
+  DocumentSource::onBusError(int, siginfo_t* info, void*)
+  {
+    char* const addr = static_cast<char*>(info->si_addr);
+    for (DocumentSource* source = mapped; source; source = source->_next)
+    {
+      char* const begin = static_cast<char*>(source->_map);
+      if (addr < begin || addr >= begin + source->_length)
+	continue;
+
+      char* const page = begin + (addr - begin) / pageSize * pageSize;
+      if (mmap(page, begin + source->_length - page, PROT_READ,
+	       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+	break;
+      source->_truncated = 1;
+      return;
+    }
+
+    sigaction(SIGBUS, &previous, 0);
+  }
+
+  /*!
+  ** Read a file until its end, when it can't be mapped.
+  **
+  ** @param fd The opened file
+  **
+  ** @return If the file was read
+  */
+  bool
+  DocumentSource::read(const int fd)
+  {
+    for (;;)
+    {
+      _buffer.resize(_length + READ_SIZE);
+      const ssize_t n = ::read(fd, &_buffer[_length], READ_SIZE);
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0)
+      {
+	_buffer.resize(_length);
+	return n == 0;
+      }
+      _length += n;
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#ifndef DOCUMENTSOURCE_HH_
+# define DOCUMENTSOURCE_HH_
+
+# include <signal.h>
+# include <string>
+# include <vector>
+
+namespace Index
+{
+  /*!
+  ** Give the content of a document as a single block of memory.
+  ** A regular file is mapped, so it's hashed and tokenized straight
+  ** from the page cache, without any copy. Other files (pipes, devices,
+  ** or a file which can't be mapped) are read into a buffer.
+  **
+  ** A mapped file truncated meanwhile would kill the process with SIGBUS
+  ** when its lost pages are read. They are replaced by zeros instead, and
+  ** the source tells it was truncated, so that the document is skipped.
+  */
+  class DocumentSource
+  {
+  public:
+    DocumentSource();
+    ~DocumentSource();
+
+  public:
+    bool open(const std::string& filename);
+    void close();
+    const char* getData() const;
+    unsigned int getLength() const;
+    bool isMapped() const;
+    bool isTruncated() const;
+
+  private:
+    DocumentSource(const DocumentSource& source);
+    DocumentSource& operator=(const DocumentSource& source);
+    bool map(const int fd, const unsigned int length);
+    bool read(const int fd);
+    static void guard();
+    static void onBusError(int, siginfo_t* info, void*);
+
+  private:
+    void*			_map;
+    unsigned int		_length;
+    std::vector<char>		_buffer;
+    volatile sig_atomic_t	_truncated;
+    DocumentSource*		_next;
+  };
+}
+
+# include "DocumentSource.hxx"
+
+#endif /* !DOCUMENTSOURCE_HH_ */
@@ -0,0 +1,50 @@
+namespace Index
+{
+  /*!
+  ** Get the content of the document.
+  **
+  ** @return The content, which is not null terminated
+  */
+  inline const char*
+  DocumentSource::getData() const
+  {
+    if (_map)
+      return static_cast<const char*>(_map);
+
+    return _buffer.empty() ? 0 : &_buffer[0];
+  }
+
+  /*!
+  ** Get the length of the document.
+  **
+  ** @return The length of the content
+  */
+  inline unsigned int
+  DocumentSource::getLength() const
+  {
+    return _length;
+  }
+
+  /*!
+  ** Check if the document is mapped, or was read in a buffer.
+  **
+  ** @return If the document is mapped
+  */
+  inline bool
+  DocumentSource::isMapped() const
+  {
+    return _map != 0;
+  }
+
+  /*!
+  ** Check if the mapped file was truncated while it was read: its lost
+  ** content was read as zeros.
+  **
+  ** @return If the file was truncated
+  */
+  inline bool
+  DocumentSource::isTruncated() const
+  {
+    return _truncated != 0;
+  }
+}
@@ -0,0 +1,75 @@
+#include "DocumentTerms.hh"
+
+namespace Index
+{
+  /*!
+  ** Construct an empty term accumulator.
+  */
+  DocumentTerms::DocumentTerms()
+    : _position(0)
+  {
+  }
+
+  /*!
+  ** Destruct a term accumulator.
+  */
+  DocumentTerms::~DocumentTerms()
+  {
+  }
+
+  /*!
+  ** Add an occurence of a term, at the next position. Weight is averaged
+  ** with previous ones, and occurences are counted by field.
+  ** A new entry has an empty stem, that the caller has to fill.
+  **
+  ** @param term The term found
+  ** @param weight The weight of this occurence
+  ** @param field The field where it was found
+  **
+  ** @return The entry of this term
+  */
+  DocumentTerms::Entry&
+  DocumentTerms::add(const std::string& term, const double weight,
+		     const Field::type field)
+  {
+    termsMap::iterator i = _terms.find(term);
+    if (i == _terms.end())
+    {
+      Entry e = {"", weight, 1, {0, 0, 0, 0}, std::vector<unsigned int>()};
+      e.fieldCounts[field] = 1;
+      Entry& entry = _terms.insert(std::make_pair(term, e)).first->second;
+      entry.positions.push_back(_position++);
+      return entry;
+    }
+
+    Entry& e = i->second;
+    e.weight = ((e.weight * e.realCount) + weight) / (e.realCount + 1);
+    e.realCount++;
+    e.fieldCounts[field]++;
+    e.positions.push_back(_position++);
+
+    return e;
+  }
+
+  /*!
+  ** Sum all occurences by stem.
+  */
+  void
+  DocumentTerms::countStems()
+  {
+    _stems.clear();
+    for (const_iterator i = _terms.begin(); i != _terms.end(); ++i)
+      _stems[i->second.stemTerm] += i->second.realCount;
+  }
+
+  /*!
+  ** Forget all terms, to be ready for the next document.
+  */
+  void
+  DocumentTerms::clear()
+  {
+    _terms.clear();
+    _stems.clear();
+    _position = 0;
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef DOCUMENTTERMS_HH_
+# define DOCUMENTTERMS_HH_
+
+# include <iostream>
+# include <string>
+# include <vector>
+# include <tr1/unordered_map>
+# include "Column.hh"
+
+namespace Index
+{
+  /*!
+  ** Accumulate all terms of a single document in memory, so that each
+  ** word is written only once in database when the document is finished.
+  ** Words are numbered in the order they are found, including the ones
+  ** which are not indexed, so that phrases can be found.
+  */
+  class DocumentTerms
+  {
+  public:
+    struct Entry
+    {
+      std::string	stemTerm;
+      double		weight;
+      unsigned int	realCount;
+      unsigned int	fieldCounts[Field::COUNT];
+      std::vector<unsigned int>	positions;
+    };
+
+  private:
+    typedef std::tr1::unordered_map<std::string, Entry> termsMap;
+    typedef std::tr1::unordered_map<std::string, unsigned int> stemsMap;
+
+  public:
+    typedef termsMap::const_iterator const_iterator;
+
+  public:
+    DocumentTerms();
+    ~DocumentTerms();
+
+  public:
+    Entry& add(const std::string& term, const double weight,
+	       const Field::type field);
+    void skip();
+    void countStems();
+    unsigned int getStemCount(const std::string& stem) const;
+    unsigned int size() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    void clear();
+
+  private:
+    termsMap		_terms;
+    stemsMap		_stems;
+    unsigned int	_position;
+  };
+}
+
+# include "DocumentTerms.hxx"
+
+#endif /* !DOCUMENTTERMS_HH_ */
@@ -0,0 +1,59 @@
+namespace Index
+{
+  /*!
+  ** Skip a word which is not indexed, but still takes a position.
+  */
+  inline void
+  DocumentTerms::skip()
+  {
+    _position++;
+  }
+
+  /*!
+  ** Get the number of different terms found.
+  **
+  ** @return Number of distinct terms
+  */
+  inline unsigned int
+  DocumentTerms::size() const
+  {
+    return _terms.size();
+  }
+
+  /*!
+  ** Get an iterator on the first term.
+  **
+  ** @return Iterator on the first term
+  */
+  inline DocumentTerms::const_iterator
+  DocumentTerms::begin() const
+  {
+    return _terms.begin();
+  }
+
+  /*!
+  ** Get an iterator past the last term.
+  **
+  ** @return Iterator past the last term
+  */
+  inline DocumentTerms::const_iterator
+  DocumentTerms::end() const
+  {
+    return _terms.end();
+  }
+
+  /*!
+  ** Get the number of occurences of all terms sharing the given stem.
+  ** countStems() must have been called before.
+  **
+  ** @param stem The stem form of a term
+  **
+  ** @return Number of occurences
+  */
+  inline unsigned int
+  DocumentTerms::getStemCount(const std::string& stem) const
+  {
+    stemsMap::const_iterator i = _stems.find(stem);
+    return i == _stems.end() ? 0 : i->second;
+  }
+}
@@ -0,0 +1,471 @@
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include "HTMLScanner.hh"
+
+namespace Index
+{
+  namespace
+  {
+    typedef std::string::size_type size_type;
+
+    // Longest entity name we try to decode
+    static const size_type MAX_ENTITY = 10;
+
+    struct Entity
+    {
+      const char*	name;
+      const char*	text;
+    };
+
+    // Named entities, sorted by name. Upper case letters are looked up in
+    // lower case, as words are indexed in lower case.
+    static const Entity ENTITIES[] = {
+      {"aacute", "á"}, {"acirc", "â"}, {"aelig", "ae"}, {"agrave", "à"},
+      {"amp", "&"}, {"apos", "'"}, {"aring", "å"}, {"atilde", "ã"},
+      {"auml", "ä"}, {"ccedil", "ç"}, {"eacute", "é"}, {"ecirc", "ê"},
+      {"egrave", "è"}, {"euml", "ë"}, {"gt", ">"}, {"iacute", "í"},
+      {"icirc", "î"}, {"igrave", "ì"}, {"iuml", "ï"}, {"laquo", "\""},
+      {"ldquo", "\""}, {"lsquo", "'"}, {"lt", "<"}, {"nbsp", " "},
+      {"ntilde", "ñ"}, {"oacute", "ó"}, {"ocirc", "ô"}, {"oelig", "oe"},
+      {"ograve", "ò"}, {"oslash", "ø"}, {"otilde", "õ"}, {"ouml", "ö"},
+      {"quot", "\""}, {"raquo", "\""}, {"rdquo", "\""}, {"rsquo", "'"},
+      {"szlig", "ss"}, {"uacute", "ú"}, {"ucirc", "û"}, {"ugrave", "ù"},
+      {"uuml", "ü"}, {"yacute", "ý"}, {"yuml", "ÿ"}
+    };
+    static const size_type ENTITIES_SIZE = sizeof (ENTITIES) / sizeof (ENTITIES[0]);
+
+    inline bool
+    operator<(const Entity& entity, const std::string& name)
+    {
+      return name.compare(entity.name) > 0;
+    }
+
+    inline bool
+    isSpace(const char c)
+    {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+    }
+
+    inline char
+    toLower(const char c)
+    {
+      return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+    }
+
+    /*!
+    ** Find a character in a part of a text.
+    **
+    ** @param html The text
+    ** @param length The length of the text
+    ** @param c The character to find
+    ** @param pos Where to begin the search
+    **
+    ** @return The position of the character, or npos if not found
+    */
+    inline size_type
+    find(const char* html, size_type length, const char c, size_type pos)
+    {
+      if (pos >= length)
+	return std::string::npos;
+      const void* found = std::memchr(html + pos, c, length - pos);
+      return found ? static_cast<const char*>(found) - html : std::string::npos;
+    }
+
+    /*!
+    ** Find a string in a part of a text.
+    **
+    ** @param html The text
+    ** @param length The length of the text
+    ** @param str The string to find
+    ** @param pos Where to begin the search
+    **
+    ** @return The position of the string, or npos if not found
+    */
+    inline size_type
+    find(const char* html, size_type length, const char* str, size_type pos)
+    {
+      if (pos >= length)
+	return std::string::npos;
+      const char* found = std::search(html + pos, html + length,
+				      str, str + std::strlen(str));
+      return found != html + length ? found - html : std::string::npos;
+    }
+
+    /*!
+    ** Append a character given by its code point. Latin-1 letters are
+    ** written in lower case UTF-8, other non ASCII characters are
+    ** considered as separators.
+    **
+    ** @param code The code point
+    ** @param out Where to append the character
+    */
+    void
+    appendCodePoint(unsigned long code, std::string& out)
+    {
+      if (code > 0 && code < 0x80)
+	out += static_cast<char>(code);
+      else
+	if (code >= 0xC0 && code <= 0xFF && code != 0xD7 && code != 0xF7)
+	{
+	  if (code < 0xDF)
+	    code += 0x20;
+	  out += static_cast<char>(0xC0 | (code >> 6));
+	  out += static_cast<char>(0x80 | (code & 0x3F));
+	}
+	else
+	  out += ' ';
+    }
+
+    /*!
+    ** Decode the entity beginning at the given position.
+    ** Unknown entities are replaced by a space, and a '&' which does not
+    ** begin an entity is kept as is.
+    **
+    ** @param html The text where the entity is
+    ** @param length The length of the text
+    ** @param pos The position of the '&'
+    ** @param out Where to append the decoded text
+    **
+    ** @return The position following the entity
+    */
+    size_type
+    decodeEntity(const char* html, size_type length, size_type pos,
+		 std::string& out)
+    {
+      size_type i = pos + 1;
+
+      if (i < length && html[i] == '#')
+      {
+	const bool hexa = i + 1 < length && (html[i + 1] == 'x' || html[i + 1] == 'X');
+	i += hexa ? 2 : 1;
+	const size_type begin = i;
+	unsigned long code = 0;
+	for (; i < length && i - begin < 8; i++)
+	{
+	  const char c = toLower(html[i]);
+	  if (c >= '0' && c <= '9')
+	    code = code * (hexa ? 16 : 10) + c - '0';
+	  else
+	    if (hexa && c >= 'a' && c <= 'f')
+	      code = code * 16 + c - 'a' + 10;
+	    else
+	      break;
+	}
+	if (i == begin)
+	{
+	  out += '&';
+	  return pos + 1;
+	}
+	appendCodePoint(code, out);
+	return i < length && html[i] == ';' ? i + 1 : i;
+      }
+
+      std::string name;
+      for (; i < length && i - pos <= MAX_ENTITY && std::isalnum(static_cast<unsigned char>(html[i])); i++)
+	name += toLower(html[i]);
+      if (name.empty() || i >= length || html[i] != ';')
+      {
+	out += '&';
+	return pos + 1;
+      }
+
+      const Entity* entity = std::lower_bound(ENTITIES, ENTITIES + ENTITIES_SIZE, name);
+      if (entity != ENTITIES + ENTITIES_SIZE && name == entity->name)
+	out += entity->text;
+      else
+	out += ' ';
+
+      return i + 1;
+    }
+
+    /*!
+    ** Compare, ignoring case, a part of a text with a lower case word.
+    **
+    ** @param html The text
+    ** @param length The length of the text
+    ** @param pos Where to compare in the text
+    ** @param word The lower case word
+    **
+    ** @return If the text contains the word at the given position
+    */
+    bool
+    matchAt(const char* html, size_type length, size_type pos,
+	    const std::string& word)
+    {
+      if (pos + word.length() > length)
+	return false;
+      for (size_type i = 0; i < word.length(); i++)
+	if (toLower(html[pos + i]) != word[i])
+	  return false;
+
+      return true;
+    }
+  }
+
+  /*!
+  ** Destruct a listener.
+  */
+  HTMLScanner::Listener::~Listener()
+  {
+  }
+
+  /*!
+  ** Construct an HTML scanner.
+  **
+  ** @param listener The listener which receives the text
+  */
+  HTMLScanner::HTMLScanner(Listener& listener)
+    : _listener(listener), _titleDepth(0), _headingDepth(0)
+  {
+  }
+
+  /*!
+  ** Destruct an HTML scanner.
+  */
+  HTMLScanner::~HTMLScanner()
+  {
+  }
+
+  /*!
+  ** Scan a whole HTML document. The document is only read, so it can
+  ** be scanned directly from a mapped file.
+  **
+  ** @param html The document
+  ** @param length The length of the document
+  */
+  void
+  HTMLScanner::scan(const char* html, const size_type length)
+  {
+    size_type pos = 0;
+
+    _text.clear();
+    _titleDepth = 0;
+    _headingDepth = 0;
+    while (pos < length)
+    {
+      const char* const special = "<&";
+      const size_type next = std::find_first_of(html + pos, html + length,
+						special, special + 2) - html;
+      _text.append(html + pos, next - pos);
+      if (next == length)
+	break;
+      if (html[next] == '<')
+	pos = scanMarkup(html, length, next);
+      else
+	pos = decodeEntity(html, length, next, _text);
+    }
+    flush();
+  }
+
+  /*!
+  ** Scan a tag, a comment or a declaration.
+  **
+  ** @param html The document
+  ** @param length The length of the document
+  ** @param pos The position of the '<'
+  **
+  ** @return The position following the markup
+  */
+  size_type
+  HTMLScanner::scanMarkup(const char* html, const size_type length,
+			  size_type pos)
+  {
+    // Comment
+    if (pos + 4 <= length && std::memcmp(html + pos, "<!--", 4) == 0)
+    {
+      const size_type end = find(html, length, "-->", pos + 4);
+      return end == std::string::npos ? length : end + 3;
+    }
+
+    // Declaration or processing instruction
+    if (pos + 1 < length && (html[pos + 1] == '!' || html[pos + 1] == '?'))
+    {
+      const size_type end = find(html, length, '>', pos + 2);
+      return end == std::string::npos ? length : end + 1;
+    }
+
+    Tag tag;
+    const size_type end = scanTag(html, length, pos, tag);
+    if (end == pos)
+    {
+      // Not a tag, so it's only text
+      _text += '<';
+      return pos + 1;
+    }
+
+    if (!tag.closing && (tag.name == "script" || tag.name == "style"))
+      return skipRawText(html, length, end, tag.name);
+
+    processTag(tag);
+    return end;
+  }
+
+  /*!
+  ** Read a tag, its name and the few properties we need.
+  **
+  ** @param html The document
+  ** @param length The length of the document
+  ** @param pos The position of the '<'
+  ** @param tag The tag to fill
+  **
+  ** @return The position following the tag, or pos if it's not a tag
+  */
+  size_type
+  HTMLScanner::scanTag(const char* html, const size_type length,
+		       size_type pos, Tag& tag) const
+  {
+    size_type i = pos + 1;
+
+    tag.closing = i < length && html[i] == '/';
+    if (tag.closing)
+      i++;
+    if (i >= length || !std::isalpha(static_cast<unsigned char>(html[i])))
+      return pos;
+    for (; i < length && std::isalnum(static_cast<unsigned char>(html[i])); i++)
+      tag.name += toLower(html[i]);
+
+    while (i < length && html[i] != '>')
+    {
+      if (isSpace(html[i]) || html[i] == '/')
+      {
+	i++;
+	continue;
+      }
+
+      std::string attr;
+      for (; i < length && !isSpace(html[i]) && html[i] != '=' &&
+	     html[i] != '>' && html[i] != '/'; i++)
+	attr += toLower(html[i]);
+      while (i < length && isSpace(html[i]))
+	i++;
+      if (i >= length || html[i] != '=')
+	continue;
+      i++;
+      while (i < length && isSpace(html[i]))
+	i++;
+
+      // Read the value, quoted or not, and decode its entities
+      std::string value;
+      const char quote = i < length && (html[i] == '"' || html[i] == '\'') ? html[i++] : 0;
+      while (i < length && (quote ? html[i] != quote : !isSpace(html[i]) && html[i] != '>'))
+	if (html[i] == '&')
+	  i = decodeEntity(html, length, i, value);
+	else
+	  value += html[i++];
+      if (quote && i < length)
+	i++;
+
+      if (attr == "name")
+	tag.nameAttr = value;
+      else
+	if (attr == "content")
+	  tag.content = value;
+	else
+	  if (attr == "alt")
+	    tag.alt = value;
+    }
+
+    return i < length ? i + 1 : length;
+  }
+
+  /*!
+  ** Skip the content of a script or a style, up to its closing tag.
+  **
+  ** @param html The document
+  ** @param length The length of the document
+  ** @param pos The position following the opening tag
+  ** @param name The name of the tag
+  **
+  ** @return The position following the closing tag
+  */
+  size_type
+  HTMLScanner::skipRawText(const char* html, const size_type length,
+			   size_type pos, const std::string& name) const
+  {
+    const std::string closing = "</" + name;
+    for (size_type i = find(html, length, '<', pos); i != std::string::npos;
+	 i = find(html, length, '<', i + 1))
+      if (matchAt(html, length, i, closing))
+      {
+	const size_type end = find(html, length, '>', i);
+	return end == std::string::npos ? length : end + 1;
+      }
+
+    return length;
+  }
+
+  /*!
+  ** Apply the effect of a tag on the text.
+  **
+  ** @param tag The tag found
+  */
+  void
+  HTMLScanner::processTag(const Tag& tag)
+  {
+    const bool heading = tag.name.length() == 2 && tag.name[0] == 'h' &&
+      tag.name[1] >= '1' && tag.name[1] <= '6';
+
+    if (tag.name == "title" || heading)
+    {
+      // The zone is changing, so the current text is finished
+      flush();
+      unsigned int& depth = heading ? _headingDepth : _titleDepth;
+      if (!tag.closing)
+	depth++;
+      else
+	if (depth > 0)
+	  depth--;
+      return;
+    }
+
+    if (tag.name == "meta" && !tag.closing)
+    {
+      std::string name = tag.nameAttr;
+      std::transform(name.begin(), name.end(), name.begin(), toLower);
+      if (name == "keywords")
+	_listener.onText(tag.content, KEYWORDS);
+      else
+	if (name == "description")
+	  _listener.onText(tag.content, DESCRIPTION);
+      return;
+    }
+
+    // Any other tag separates the words around it
+    _text += ' ';
+    if (tag.name == "img" && !tag.alt.empty())
+    {
+      _text += tag.alt;
+      _text += ' ';
+    }
+  }
+
+  /*!
+  ** Give the current text to the listener.
+  */
+  void
+  HTMLScanner::flush()
+  {
+    if (_text.empty())
+      return;
+    _listener.onText(_text, currentZone());
+    _text.clear();
+  }
+
+  /*!
+  ** Get the zone of the current text. A title inside a heading is
+  ** still a title.
+  **
+  ** @return The zone
+  */
+  HTMLScanner::zone
+  HTMLScanner::currentZone() const
+  {
+    if (_titleDepth > 0)
+      return TITLE;
+    if (_headingDepth > 0)
+      return HEADING;
+
+    return BODY;
+  }
+}
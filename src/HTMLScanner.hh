@@ -0,0 +1,75 @@
+#ifndef HTMLSCANNER_HH_
+# define HTMLSCANNER_HH_
+
+# include <iostream>
+# include <string>
+
+namespace Index
+{
+  /*!
+  ** Scan an HTML document in a single pass, and give its text to a
+  ** listener, span by span, with the zone where the text was found.
+  ** Comments, scripts and styles are skipped, entities are decoded, and
+  ** images are replaced by their alt property.
+  */
+  class HTMLScanner
+  {
+  public:
+    enum zone
+      {
+	BODY,
+	TITLE,
+	HEADING,
+	KEYWORDS,
+	DESCRIPTION
+      };
+
+    class Listener
+    {
+    public:
+      virtual ~Listener();
+      virtual void onText(const std::string& text, const zone where) = 0;
+    };
+
+  public:
+    HTMLScanner(Listener& listener);
+    ~HTMLScanner();
+
+  public:
+    void scan(const char* html, const std::string::size_type length);
+
+  private:
+    struct Tag
+    {
+      std::string	name;
+      bool		closing;
+      std::string	nameAttr;
+      std::string	content;
+      std::string	alt;
+    };
+
+  private:
+    std::string::size_type scanMarkup(const char* html,
+				      const std::string::size_type length,
+				      std::string::size_type pos);
+    std::string::size_type scanTag(const char* html,
+				   const std::string::size_type length,
+				   std::string::size_type pos,
+				   Tag& tag) const;
+    std::string::size_type skipRawText(const char* html,
+				       const std::string::size_type length,
+				       std::string::size_type pos,
+				       const std::string& name) const;
+    void processTag(const Tag& tag);
+    void flush();
+    zone currentZone() const;
+
+  private:
+    Listener&		_listener;
+    std::string		_text;
+    unsigned int	_titleDepth;
+    unsigned int	_headingDepth;
+  };
+}
+
+#endif /* !HTMLSCANNER_HH_ */
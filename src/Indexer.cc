@@ -1,10 +1,15 @@
+#include <sys/stat.h>
+#include <cerrno>
 #include <boost/filesystem/operations.hpp>
+#include <boost/timer.hpp>
 #include <algorithm>
 #include "Indexer.hh"
 #include "Utils.hh"
 #include "Sha1.hh"
 #include "StemmerFactory.hh"
 #include "Configuration.hh"
+#include "Pipeline.hh"
+#include "ResultCache.hh"
 
 namespace Index
 {
@@ -12,15 +17,22 @@ namespace Index
   ** Construct an indexer object.
   */
   Indexer::Indexer()
-    : _currentIdDoc(0), _weight(Weight::NO), _stem(0)
+    : _verbose(false), _jobs(1), _stem(0),
+      _normalizer(Configuration::getInstance().getFoldAccents()),
+      _paranoid(Configuration::getInstance().getParanoid())
   {
     Stemmer::StemmerFactory factory;
     Configuration& cfg = Configuration::getInstance();
-    _stem = factory.get(cfg.getStemmerName());
+    _stem = factory.get(cfg.getStemmerName(), cfg.getStemCache());
     loadBlackList();
     loadWhiteList();
-    fs::path full_path(fs::initial_path<fs::path>());
-    loadStopWords(full_path / cfg.getStopwordFilename());
+    if (cfg.getStopwordFilename().empty())
+      loadDefaultStopWords();
+    else
+    {
+      fs::path full_path(fs::initial_path<fs::path>());
+      loadStopWords(full_path / cfg.getStopwordFilename());
+    }
   }
 
   /*!
@@ -33,14 +45,25 @@ namespace Index
     cleanWhiteList();
   }
 
+  /*!
+  ** Load the stop words embedded at build time, without reading any file.
+  ** Without embedded list, there is no stop word.
+  */
+  void
+  Indexer::loadDefaultStopWords() const
+  {
+    _stopWords.loadDefault(_normalizer);
+  }
+
   /*!
   ** List a directory recursively, and apply to each file the processFile method.
   ** Hidden file, ie file beginning with ".", will be ignored.
   **
   ** @param fullPath The full boost path of the directory
+  ** @param unseen Where to forget the files found
   */
   void
-  Indexer::listDirectory(const fs::path& fullPath) const
+  Indexer::listDirectory(const fs::path& fullPath, fileSet& unseen) const
   {
     assert(fs::is_directory(fullPath));
 
@@ -50,13 +73,17 @@ namespace Index
       try
       {
 	// Check if it's a hidden file
-	if (it->leaf()[0] != '.')
+	if (isIndexable(it->leaf()))
 	{
 	  if (fs::is_directory(it->status()))
-	    listDirectory(fullPath / it->leaf());
+	    listDirectory(fullPath / it->leaf(), unseen);
 	  else
 	    if (fs::is_regular(it->status()))
-	      processFile(fullPath / it->leaf());
+	    {
+	      const fs::path file = fullPath / it->leaf();
+	      unseen.erase(file.native_file_string());
+	      processFile(file);
+	    }
 	}
       }
       catch (const std::exception & ex)
@@ -85,8 +112,6 @@ namespace Index
   void
   Indexer::indexDirectory(const std::string& dirname) const
   {
-    Index::Database& db = Index::Database::getInstance();
-    db.clearSearchCache();
     fs::path full_path = fs::system_complete(fs::path(dirname, fs::native));
 
     if (!fs::exists(full_path))
@@ -96,7 +121,24 @@ namespace Index
     }
 
     if (fs::is_directory(full_path))
-      listDirectory(full_path);
+    {
+      // The known files not found by the walk may have been deleted
+      fileSet unseen;
+      loadKnownFiles(full_path, unseen);
+      if (_jobs > 1)
+      {
+	Pipeline pipeline(*this, _jobs);
+	pipeline.run(full_path, unseen);
+      }
+      else
+      {
+	listDirectory(full_path, unseen);
+	const Stemmer::Caching* cache = dynamic_cast<const Stemmer::Caching*>(_stem);
+	if (_verbose && cache)
+	  cache->display();
+      }
+      removeDeletedFiles(unseen);
+    }
     else
       if (fs::is_regular(full_path))
 	processFile(full_path);
@@ -104,6 +146,63 @@ namespace Index
 	std::cerr << "Not a directory or a file: " << full_path.native_file_string() << std::endl;
   }
 
+  /*!
+  ** Load the filenames of all documents indexed under a directory.
+  **
+  ** @param root The full boost path of the directory
+  ** @param files Where to store the filenames
+  */
+  void
+  Indexer::loadKnownFiles(const fs::path& root, fileSet& files) const
+  {
+    Index::Database& db = Index::Database::getInstance();
+    std::string directory = root.native_file_string();
+    if (!directory.empty() && directory[directory.length() - 1] == '/')
+      directory.erase(directory.length() - 1);
+
+    const std::list<Column::Document> docs = db.getDocumentsUnder(directory);
+    for (std::list<Column::Document>::const_iterator i = docs.begin();
+	 i != docs.end(); ++i)
+      files.insert(files.end(), i->filename);
+  }
+
+  /*!
+  ** Delete the documents whose file was not found while walking their
+  ** directory, then the terms they were the last to use, all in a single
+  ** transaction. A file is only considered deleted if it's really gone,
+  ** so a directory which couldn't be listed doesn't lose its documents.
+  **
+  ** @param unseen The filenames of the documents not found
+  */
+  void
+  Indexer::removeDeletedFiles(const fileSet& unseen) const
+  {
+    Index::Database& db = Index::Database::getInstance();
+    boost::timer timer;
+    unsigned int documents = 0;
+
+    db.beginTransaction();
+    for (fileSet::const_iterator i = unseen.begin(); i != unseen.end(); ++i)
+    {
+      struct stat st;
+      if (stat(i->c_str(), &st) == 0 ? S_ISREG(st.st_mode) :
+	  errno != ENOENT && errno != ENOTDIR)
+	continue;
+
+      if (_verbose)
+	std::cout << "Removing : " << *i << std::endl;
+      if (removeFile(*i))
+	documents++;
+    }
+    const unsigned int terms = db.deleteUnusedTerms();
+    db.endTransaction();
+
+    if (_verbose || documents > 0 || terms > 0)
+      std::cout << "Removed " << documents << " deleted documents and "
+		<< terms << " unused terms in " << timer.elapsed()
+		<< " seconds." << std::endl;
+  }
+
   /*!
   ** Process a file, indexing it, ie getting all information needed.
   **
@@ -129,187 +228,335 @@ namespace Index
 
     if (!fs::is_regular(fullPath))
     {
-      Column::Document doc = db.getDocumentByFilename(fullPath);
-      if (Column::docExists(doc))
-	db.deleteDocument(doc, true);
+      removeFile(fullPath);
       return;
     }
 
-    if (!isWhiteListed(fullPath) || isBlackListed(fullPath))
+    // Try to get the document in the database, then parse the file
+    ParsedDocument parsed;
+    parsed.doc = db.getDocumentByFilename(fullPath);
+    if (!parseFile(fullPath, parsed, *_stem))
       return;
 
+    // Then write the whole document at once
+    db.beginTransaction();
+    commitDocument(parsed);
+    db.endTransaction();
+  }
+
+  /*!
+  ** Remove the document of a file from the index, with its words, and
+  ** invalidate the cached searches which depend on it.
+  **
+  ** @param fullPath The full file path
+  **
+  ** @return If the file was indexed
+  */
+  bool
+  Indexer::removeFile(const std::string& fullPath) const
+  {
+    Index::Database& db = Index::Database::getInstance();
+    const Column::Document doc = db.getDocumentByFilename(fullPath);
+    if (!Column::docExists(doc))
+      return false;
+
+    invalidateSearches(doc.id);
+    db.deleteDocument(doc, true);
+
+    return true;
+  }
+
+  /*!
+  ** Read a file and extract all its terms, without any database access,
+  ** so that it can be called from several threads at once.
+  **
+  ** @param fullPath The full file path
+  ** @param parsed The document to fill. On entry, parsed.doc must be the
+  ** document found in database, or a document with an id equal to 0.
+  ** @param stem The stemmer to use, owned by the calling thread
+  **
+  ** @return If the document must be written, ie it is new or was modified,
+  ** or only its size, date or inode changed
+  */
+  bool
+  Indexer::parseFile(const std::string& fullPath,
+		     ParsedDocument& parsed,
+		     Stemmer::Generic& stem) const
+  {
+    if (!isWhiteListed(fullPath) || isBlackListed(fullPath))
+      return false;
+
+    // A file whose size, date and inode didn't change is trusted, unless
+    // we are paranoid. The date is read to the nanosecond, so that a file
+    // modified in the second it was indexed is still seen. A document
+    // without hash has postings which were never written.
+    struct stat st;
+    if (stat(fullPath.c_str(), &st) != 0)
+      return false;
+    const long long mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    const bool same = Column::docExists(parsed.doc) && !parsed.doc.hash.empty() &&
+      parsed.doc.size == st.st_size && parsed.doc.mtime == mtime &&
+      parsed.doc.inode == static_cast<long long>(st.st_ino);
+    if (same && !_paranoid)
+      return false;
+
+    // The file is read once, its SHA1 and its terms come from the same pages
+    DocumentSource source;
+    if (!source.open(fullPath))
+      return false;
+
     // First we get the SHA1 of this file
     Hash::Sha1 sha1;
-    if (!sha1.hashFile(fullPath.c_str()))
-      assert(false);
+    if (source.getLength() > 0)
+      sha1.update(reinterpret_cast<const UINT_8*>(source.getData()),
+		  source.getLength());
+    sha1.final();
     const std::string hash = sha1.getStrHash();
 
-    // Then we try to get the document in the database
-    Column::Document doc = db.getDocumentByFilename(fullPath);
+    // A file truncated while it's read is changing, it's skipped until it's done
+    if (source.isTruncated())
+      return false;
 
-    // If document exists, then delete entry in database to take care of modification
-    if (Column::docExists(doc))
-    {
-      // Check if document can be skipped
-      if (hash == doc.hash)
-	return;
-      db.deleteDocument(doc, false);
-    }
+    // Get the file system date
+    parsed.doc.date = st.st_mtime;
+    parsed.doc.size = st.st_size;
+    parsed.doc.mtime = mtime;
+    parsed.doc.inode = st.st_ino;
+
+    // If document exists and is unchanged, then only its date may be written
+    parsed.changed = !Column::docExists(parsed.doc) || hash != parsed.doc.hash;
+    if (!parsed.changed)
+      return !same;
 
     // Get the file type : TEXT or HTML
     std::string ext = fullPath.substr(fullPath.find_last_of('.') + 1);
     File::type t = ext == "html" || ext == "htm" ? File::HTML : File::TEXT;
 
-    // Get the file system date
-    std::stringstream date;
-    date << fs::last_write_time(fullPath);
-
-    // Add the document without specifies length
-    doc.filename = fullPath;
-    doc.type = t;
-    doc.hash = hash;
-    doc.date = date.str();
-    db.addOrUpdateDocument(doc);
+    // Process file to extract all term in memory, and get the total term count
+    parsed.doc.filename = fullPath;
+    parsed.doc.type = t;
+    parsed.doc.hash = hash;
+    parsed.doc.length = extractAllTerm(source, t, parsed.terms, stem);
 
-    // Get the id of the file, then process file to extract all term,
-    // and get the total term count
-    doc = db.getDocumentByFilename(fullPath);
-    _currentIdDoc = doc.id;
-    unsigned int length = extractAllTerm(fullPath, t);
-    _currentIdDoc = 0;
+    return !source.isTruncated();
+  }
 
-    // Update the previous document, with the length value.
-    doc.length = length;
+  /*!
+  ** Write a parsed document and all its words. If document exists,
+  ** delete its words to take care of modification.
+  ** Only the cached searches sharing a term with the old or the new
+  ** document, or which found it, are invalidated.
+  ** Must be called within a transaction.
+  **
+  ** @param parsed The parsed document
+  */
+  void
+  Indexer::commitDocument(ParsedDocument& parsed) const
+  {
+    Index::Database& db = Index::Database::getInstance();
+    Column::Document& doc = parsed.doc;
+
+    // Same content, so the words and the cached searches are still right
+    if (!parsed.changed)
+    {
+      db.addOrUpdateDocument(doc);
+      return;
+    }
+
+    if (Column::docExists(doc))
+    {
+      invalidateSearches(doc.id);
+      db.deleteDocument(doc, false);
+    }
     db.addOrUpdateDocument(doc);
+    if (!Column::docExists(doc))
+      doc = db.getDocumentByFilename(doc.filename);
+    commitAllWords(doc, parsed.terms);
+    invalidateSearches(doc.id);
+  }
+
+  /*!
+  ** Delete the cached searches depending on the current words of a
+  ** document, in database and in memory.
+  **
+  ** @param idDoc The document id
+  */
+  void
+  Indexer::invalidateSearches(const unsigned int idDoc) const
+  {
+    Index::Database& db = Index::Database::getInstance();
+    db.invalidateSearches(idDoc);
 
-    // Update score, ie divide all score by doc number (length)
-    db.updateTermScore(doc);
+    Search::ResultCache& cache = Search::ResultCache::getInstance();
+    if (cache.empty())
+      return;
+    const std::list<std::string> current = db.getDocumentTerms(idDoc);
+    const Search::ResultCache::termSet terms(current.begin(), current.end());
+    cache.invalidate(idDoc, terms);
   }
 
   /*!
   ** Extract all term of a document.
   **
-  ** @param fullPath The path where the document is
+  ** @param source The content of the document
   ** @param type The type of document
+  ** @param terms Where to accumulate the terms
+  ** @param stem The stemmer to use
   **
   ** @return Number of term in document, including black listed ones.
   */
   unsigned int
-  Indexer::extractAllTerm(const std::string& fullPath, File::type type) const
+  Indexer::extractAllTerm(const DocumentSource& source, File::type type,
+			  DocumentTerms& terms, Stemmer::Generic& stem) const
   {
-    std::stringstream buffer;
-    std::ifstream file(fullPath.c_str());
-    assert(file);
-    buffer << file.rdbuf();
-    file.close();
-
-    Index::Database& db = Index::Database::getInstance();
-    db.beginTransaction();
     unsigned int termCount = 0;
     switch (type)
     {
       case File::TEXT:
-	termCount = extractAllTermFromText(buffer);
+	termCount = extractAllTermFromText(source, terms, stem);
 	break;
       case File::HTML:
-	termCount = extractAllTermFromHTML(buffer);
+	termCount = extractAllTermFromHTML(source, terms, stem);
 	break;
       default:
 	assert(false);
     }
-    db.endTransaction();
 
     return termCount;
   }
 
   /*!
-  ** Extract all term contained in a string stream in simple text format.
+  ** Extract all term of a document in simple text format.
+  ** The whole text is normalized at once, then split into words.
   **
-  ** @param file The text of the file
+  ** @param source The content of the document
+  ** @param terms Where to accumulate the terms
+  ** @param stem The stemmer to use
   **
   ** @return Numbers of term found
   */
   unsigned int
-  Indexer::extractAllTermFromText(std::stringstream& file) const
+  Indexer::extractAllTermFromText(const DocumentSource& source,
+				  DocumentTerms& terms,
+				  Stemmer::Generic& stem) const
   {
-    std::string line;
-    int termCount = 0;
-
-    _weight = Weight::DEFAULT;
-    while (std::getline(file, line))
-      termCount += extractLineTerm(Utils::renarrow(line));
-    _weight = Weight::NO;
+    std::string text;
+    _normalizer.normalize(source.getData(), source.getLength(), text);
 
-    return termCount;
+    return extractLineTerm(text, Weight::DEFAULT, Field::BODY, terms, stem);
   }
 
   /*!
-  ** Extract all term contained in a string stream in HTML format.
+  ** Extract all term of a document in HTML format.
   **
-  ** @param file The text of the file
+  ** @param source The content of the document
+  ** @param terms Where to accumulate the terms
+  ** @param stem The stemmer to use
   **
   ** @return Numbers of term found
   */
   unsigned int
-  Indexer::extractAllTermFromHTML(std::stringstream& file) const
+  Indexer::extractAllTermFromHTML(const DocumentSource& source,
+				  DocumentTerms& terms,
+				  Stemmer::Generic& stem) const
   {
-    std::string line;
-    int termCount = 0;
-    std::string allFile = Utils::renarrow(file.str());
-    std::string extracted;
-
-    // Delete all comment and script
-    deleteExpr(allFile, COMMENT, boost::match_default);
-    deleteExpr(allFile, SCRIPT, boost::match_default);
-
-    //Extract <title> balise
-    _weight = Weight::TITLE;
-    extracted = extractFromBalises(allFile, TITLE);
-    replaceSpecialHTMLChar(extracted);
-    termCount += extractLineTerm(extracted);
-
-    _weight = Weight::H_TITLE;
-    //Extract <h1>, <h2>, etc... balises
-    extracted = extractFromBalises(allFile, HEAD_TITLE);
-    replaceSpecialHTMLChar(extracted);
-    termCount += extractLineTerm(extracted);
-
-    _weight = Weight::KEYWORDS;
-    // Extract a <meta name="keywords"> balise
-    extracted = extractFromExpression(allFile, KWORDS, 1);
-    replaceSpecialHTMLChar(extracted);
-    termCount += extractLineTerm(extracted);
-
-    _weight = Weight::DESCRIPTION;
-    // Extract a <meta name="description"> balise
-    extracted = extractFromExpression(allFile, DESC, 1);
-    replaceSpecialHTMLChar(extracted);
-    termCount += extractLineTerm(extracted);
-
-    // Replace img balise with it alt property
-    replaceImgWithAlt(allFile);
-
-    // Now delete all balises
-    deleteExpr(allFile, HTML_BALISES, boost::match_default);
-    replaceSpecialHTMLChar(allFile);
-    termCount += extractLineTerm(extracted);
-
-    _weight = Weight::DEFAULT;
-    termCount += extractLineTerm(allFile);
-    _weight = Weight::NO;
+    TermCollector collector(*this, terms, stem);
+    HTMLScanner scanner(collector);
+    scanner.scan(source.getData(), source.getLength());
 
-    return termCount;
+    return collector.getTermCount();
+  }
+
+  /*!
+  ** Construct a collector of the terms found by the HTML scanner.
+  **
+  ** @param indexer The indexer which extracts the terms
+  ** @param terms Where to accumulate the terms
+  ** @param stem The stemmer to use
+  */
+  Indexer::TermCollector::TermCollector(const Indexer& indexer,
+					DocumentTerms& terms,
+					Stemmer::Generic& stem)
+    : _indexer(indexer), _terms(terms), _stem(stem), _termCount(0)
+  {
+  }
+
+  /*!
+  ** Destruct a collector of terms.
+  */
+  Indexer::TermCollector::~TermCollector()
+  {
+  }
+
+  /*!
+  ** Extract the terms of a text span, with the weight of its zone. Spans
+  ** are one position apart, so that no phrase is found across zones.
+  **
+  ** @param text The text found
+  ** @param where The zone of the document where the text was found
+  */
+  void
+  Indexer::TermCollector::onText(const std::string& text,
+				 const HTMLScanner::zone where)
+  {
+    double weight = Weight::DEFAULT;
+    Field::type field = Field::BODY;
+    switch (where)
+    {
+      case HTMLScanner::TITLE:
+	weight = Weight::TITLE;
+	field = Field::TITLE;
+	break;
+      case HTMLScanner::HEADING:
+	weight = Weight::H_TITLE;
+	field = Field::HEADING;
+	break;
+      case HTMLScanner::KEYWORDS:
+	weight = Weight::KEYWORDS;
+	field = Field::META;
+	break;
+      case HTMLScanner::DESCRIPTION:
+	weight = Weight::DESCRIPTION;
+	field = Field::META;
+	break;
+      default:
+	break;
+    }
+    _terms.skip();
+    _indexer._normalizer.normalize(text, _text);
+    _termCount += _indexer.extractLineTerm(_text, weight, field, _terms, _stem);
+  }
+
+  /*!
+  ** Get the number of terms found, including black listed ones.
+  **
+  ** @return Number of terms
+  */
+  unsigned int
+  Indexer::TermCollector::getTermCount() const
+  {
+    return _termCount;
   }
 
   /*!
-  ** Extract all term contained within a single line.
+  ** Extract all term contained within a single line. Words which are
+  ** not indexed still take a position, so that the words of a phrase
+  ** keep their distance.
   **
   ** @param line The line where the terms are
+  ** @param weight The weight of the terms of this line
+  ** @param field The field of the document where the line is
+  ** @param terms Where to accumulate the terms
+  ** @param stem The stemmer to use
   **
   ** @return Number of term found including black listed ones.
   */
   unsigned int
-  Indexer::extractLineTerm(const std::string& line) const
+  Indexer::extractLineTerm(const std::string& line,
+			   const double weight,
+			   const Field::type field,
+			   DocumentTerms& terms,
+			   Stemmer::Generic& stem) const
   {
     int termCount = 0;
     tokenizer tokens(line);
@@ -320,79 +567,73 @@ namespace Index
       tmp = *tok_iter;
       if (tmp.length() > 1 && !std::ispunct(tmp[0]) && !isStopWord(tmp))
       {
-	commitWordAndTerm(tmp);
+	commitWordAndTerm(tmp, weight, field, terms, stem);
 	termCount++;
       }
+      else
+	if (!std::ispunct(tmp[0]))
+	  terms.skip();
     }
 
     return termCount;
   }
 
   /*!
-  ** Add the word to the word list, and also update term list.
+  ** Add the word to the in-memory term list of the current document.
+  ** A term is stemmed only the first time it's found in the document.
   **
   ** @param word The word to commit
+  ** @param weight The weight of this occurence
+  ** @param field The field where it was found
+  ** @param terms Where to accumulate the terms
+  ** @param stem The stemmer to use
   */
   void
-  Indexer::commitWordAndTerm(std::string& word) const
+  Indexer::commitWordAndTerm(const std::string& word,
+			     const double weight,
+			     const Field::type field,
+			     DocumentTerms& terms,
+			     Stemmer::Generic& stem) const
   {
-    assert(_currentIdDoc != 0);
-    assert(_weight != Weight::NO);
-
-    // Lowerize the word.
-    // Ugly hack with static_cast, but compiler will failed without it !
-    std::transform(word.begin(), word.end(), word.begin(),
-		   static_cast<int(*)(int)>(std::tolower));
-
-    Column::Term term = commitTerm(word);
-    assert(termExists(term));
+    assert(weight != Weight::NO);
 
-    // If term already exists, then just increments realCount and stemCount.
-    // If term doesn't exists, stem the term and check if another stem was found,
-    // then increments stemCount.
-    Index::Database& db = Index::Database::getInstance();
-    Column::Word w = db.getWordByIds(_currentIdDoc, term.id);
-    if (!Column::wordExists(w))
-    {
-      w.idDocument = _currentIdDoc;
-      w.idTerm = term.id;
-      w.weight = _weight;
-      w.realCount = 1;
-      w.score = (w.weight * (w.realCount * Weight::REAL + w.stemCount * Weight::STEM));
-      db.addWord(w);
-    }
-    else
-    {
-      w.realCount++;
-      w.weight = ((w.weight * w.realCount) + _weight) / (1 + w.realCount);
-      w.score = (w.weight * (w.realCount * Weight::REAL + w.stemCount * Weight::STEM));
-      db.updateWord(w);
-    }
-
-    db.updateAllStemNumber(w, term.stemTerm,  db.getStemNumber(w, term.stemTerm) + 1);
+    DocumentTerms::Entry& entry = terms.add(word, weight, field);
+    if (entry.stemTerm.empty())
+      entry.stemTerm = stem.getStem(word);
   }
 
   /*!
-  ** Add the term if it doesn't exists yet.
-  ** Try to find the stem of this word.
+  ** Write all words accumulated for a document, one row per word.
+  ** Stem count and score are computed here, score being already divided
+  ** by the document length. The counts by field are kept, so that
+  ** documents can also be ranked at search time, and the positions of
+  ** the words, so that phrases can be found.
   **
-  ** @param term The term to add
-  **
-  ** @return The id of the committed term
+  ** @param doc The document where the words are
+  ** @param terms The terms accumulated for this document
   */
-  Column::Term
-  Indexer::commitTerm(const std::string& term) const
+  void
+  Indexer::commitAllWords(const Column::Document& doc, DocumentTerms& terms) const
   {
+    assert(Column::docExists(doc));
+
     Index::Database& db = Index::Database::getInstance();
-    Column::Term t = db.getTermByName(term);
-    if (!Column::termExists(t))
+    terms.countStems();
+    for (DocumentTerms::const_iterator i = terms.begin(); i != terms.end(); ++i)
     {
-      t.realTerm = term;
-      t.stemTerm = _stem->getStem(term);
-      db.addOrUpdateTerm(t);
-      t = db.getTermByName(term);
+      const DocumentTerms::Entry& entry = i->second;
+      Column::Word w;
+      w.idDocument = doc.id;
+      w.idTerm = 0;
+      w.weight = entry.weight;
+      w.realCount = entry.realCount;
+      w.stemCount = terms.getStemCount(entry.stemTerm);
+      w.score = 100 * (w.weight * (w.realCount * Weight::REAL + w.stemCount * Weight::STEM)) /
+	doc.length;
+      std::copy(entry.fieldCounts, entry.fieldCounts + Field::COUNT, w.fieldCounts);
+      Utils::encodePositions(entry.positions, w.positions);
+      db.addWord(i->first, entry.stemTerm, w, doc.length);
     }
-
-    return t;
+    terms.clear();
   }
 }
@@ -8,9 +8,15 @@
 # include <boost/tokenizer.hpp>
 # include <boost/regex.hpp>
 # include <list>
+# include <set>
 # include "Column.hh"
 # include "Stemmer.hh"
 # include "Database.hh"
+# include "DocumentTerms.hh"
+# include "HTMLScanner.hh"
+# include "DocumentSource.hh"
+# include "StopWords.hh"
+# include "Normalizer.hh"
 
 namespace fs = boost::filesystem;
 
@@ -30,33 +36,29 @@ namespace Index
 
   typedef boost::regex regexp;
   typedef boost::wregex wregexp;
-  static const std::string COMMENT = "<!--.*?-->";
-  static const std::string TITLE = "title";
-  static const std::string SCRIPT = "<\\s*(script)[^>]*>\\s*"
-    "([^>]*)"
-    "\\s*<\\s*/\\s*\\1\\s*>";
-  static const std::string HEAD_TITLE = "h[123456]";
-  static const std::string KWORDS = "<\\s*meta\\s*"
-    "name\\s*=\\s*\"keywords\"\\s*"
-    "content\\s*=\\s*\"([^\"]*)\"\\s*>";
-  static const std::string DESC = "<\\s*meta\\s*"
-    "name\\s*=\\s*\"description\"\\s*"
-    "content\\s*=\\s*\"([^\"]*)\"\\s*>";
-  static const std::string HTML_BALISES = "<[^>]*>";
-  static const std::string IMG_TO_ALT = "<\\s*img"
-    "[^>]*alt\\s*=\\s*\"([^\"]*)\"[^>]*>";
-  static const regexp QUOTE_PATTERN("[]?.+*$()\\^|!#{}[-]",
-				    boost::regex::perl |
-				    boost::regex::icase);
+
+  /*!
+  ** A document whose terms were extracted, but which is not yet
+  ** written in database. When its content didn't change, only its
+  ** size, date and inode are written, and its words are kept.
+  */
+  struct ParsedDocument
+  {
+    Column::Document	doc;
+    DocumentTerms	terms;
+    bool		changed;
+  };
 
   class Indexer
   {
     typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
     typedef std::list<regexp*> reglist;
-    typedef std::list<std::string> wordsList;
     typedef std::list<regexp*>::iterator iter;
     typedef std::list<regexp*>::const_iterator citer;
 
+  public:
+    typedef std::set<std::string> fileSet;
+
   public:
     Indexer();
     ~Indexer();
@@ -65,51 +67,85 @@ namespace Index
     void indexDirectory() const;
     void indexDirectory(const std::string& dirname) const;
     void setVerbose(const bool activate);
+    bool getVerbose() const;
+    void setJobs(const unsigned int jobs);
     void processFile(const fs::path& fullPath) const;
     void processFile(const std::string& fullPath) const;
+    bool removeFile(const std::string& fullPath) const;
     void loadBlackList() const;
     void cleanBlackList() const;
     void loadWhiteList() const;
     void cleanWhiteList() const;
     void loadStopWords(const std::string& filename) const;
     void loadStopWords(const fs::path& filename) const;
+    void loadDefaultStopWords() const;
+    bool isIndexable(const std::string& leaf) const;
+    bool parseFile(const std::string& fullPath,
+		   ParsedDocument& parsed,
+		   Stemmer::Generic& stem) const;
+    void commitDocument(ParsedDocument& parsed) const;
 
   private:
-    std::string preg_quote (const std::string& expr) const;
-    std::string extractFromExpression(std::string& text,
-				      const std::string& expression,
-				      const unsigned int capture = 0) const;
-    std::string extractFromTwoSymbols(std::string& text,
-				      const std::string& beginSymbol,
-				      const std::string& expression,
-				      const std::string& endSymbol) const;
-    std::string extractFromBalises(std::string& text, const std::string& balise) const;
-    void deleteExpr(std::string& text,
-		    const std::string& expr,
-		    const boost::match_flag_type flags) const;
-    void replaceImgWithAlt(std::string& text) const;
-    void replaceSpecialHTMLChar(std::string& text) const;
     bool isStopWord(const std::string& word) const;
 
   private:
-    void listDirectory(const fs::path& fullPath) const;
+    void listDirectory(const fs::path& fullPath, fileSet& unseen) const;
+    void loadKnownFiles(const fs::path& root, fileSet& files) const;
+    void removeDeletedFiles(const fileSet& unseen) const;
     bool isBlackListed(const std::string& filename) const;
     bool isWhiteListed(const std::string& filename) const;
-    unsigned int extractAllTerm(const std::string& fullPath, File::type type) const;
-    unsigned int extractAllTermFromText(std::stringstream& file) const;
-    unsigned int extractAllTermFromHTML(std::stringstream& file) const;
-    unsigned int extractLineTerm(const std::string& line) const;
-    void commitWordAndTerm(std::string& word) const;
-    Column::Term commitTerm(const std::string& term) const;
+    unsigned int extractAllTerm(const DocumentSource& source, File::type type,
+				DocumentTerms& terms, Stemmer::Generic& stem) const;
+    unsigned int extractAllTermFromText(const DocumentSource& source,
+					DocumentTerms& terms,
+					Stemmer::Generic& stem) const;
+    unsigned int extractAllTermFromHTML(const DocumentSource& source,
+					DocumentTerms& terms,
+					Stemmer::Generic& stem) const;
+    unsigned int extractLineTerm(const std::string& line,
+				 const double weight,
+				 const Field::type field,
+				 DocumentTerms& terms,
+				 Stemmer::Generic& stem) const;
+    void commitWordAndTerm(const std::string& word,
+			   const double weight,
+			   const Field::type field,
+			   DocumentTerms& terms,
+			   Stemmer::Generic& stem) const;
+    void commitAllWords(const Column::Document& doc, DocumentTerms& terms) const;
+    void invalidateSearches(const unsigned int idDoc) const;
+
+  private:
+    class TermCollector : public HTMLScanner::Listener
+    {
+    public:
+      TermCollector(const Indexer& indexer,
+		    DocumentTerms& terms,
+		    Stemmer::Generic& stem);
+      virtual ~TermCollector();
+
+    public:
+      virtual void onText(const std::string& text, const HTMLScanner::zone where);
+      unsigned int getTermCount() const;
+
+    private:
+      const Indexer&		_indexer;
+      DocumentTerms&		_terms;
+      Stemmer::Generic&		_stem;
+      unsigned int		_termCount;
+      std::string		_text;
+    };
+    friend class TermCollector;
 
   private:
-    mutable unsigned int	_currentIdDoc;
-    mutable double		_weight;
     mutable reglist		_blackList;
     mutable reglist		_whiteList;
-    mutable wordsList		_stopWords;
+    mutable StopWords		_stopWords;
     bool			_verbose;
+    unsigned int		_jobs;
     Stemmer::Generic*		_stem;
+    const Normalizer		_normalizer;
+    const bool			_paranoid;
   };
 }
 
@@ -0,0 +1,169 @@
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+#include "Normalizer.hh"
+
+namespace
+{
+  // Base letter of the lower case Latin-1 letters, from 0xE0 (à) to
+  // 0xFF (ÿ). 0 keeps the letter as is.
+  static const char FOLDED[] = {
+    'a', 'a', 'a', 'a', 'a', 'a', 0, 'c',
+    'e', 'e', 'e', 'e', 'i', 'i', 'i', 'i',
+    0, 'n', 'o', 'o', 'o', 'o', 'o', 0,
+    'o', 'u', 'u', 'u', 'u', 'y', 0, 'y'
+  };
+}
+
+/*!
+** Construct a normalizer, building the table of the Latin-1 characters.
+** Upper case letters are lowered, and symbols, control characters and
+** the non breaking space become spaces, so that they separate words.
+**
+** @param foldAccents If accented letters are replaced by their base letter
+*/
+Normalizer::Normalizer(const bool foldAccents)
+  : _foldAccents(foldAccents)
+{
+  for (unsigned int i = 0; i < 256; i++)
+  {
+    unsigned int code = i;
+    if (code >= 'A' && code <= 'Z')
+      code += 'a' - 'A';
+    else
+      if ((code >= 0x80 && code < 0xC0) || code == 0xD7 || code == 0xF7)
+	code = ' ';
+      else
+	if (code >= 0xC0 && code < 0xDF)
+	  code += 0x20;
+
+    if (foldAccents && code >= 0xE0 && FOLDED[code - 0xE0])
+      code = FOLDED[code - 0xE0];
+
+    Letter& letter = _letters[i];
+    if (code < 0x80)
+    {
+      letter.length = 1;
+      letter.text[0] = static_cast<char>(code);
+      letter.text[1] = 0;
+    }
+    else
+    {
+      letter.length = 2;
+      letter.text[0] = static_cast<char>(0xC0 | (code >> 6));
+      letter.text[1] = static_cast<char>(0x80 | (code & 0x3F));
+    }
+  }
+}
+
+/*!
+** Destruct a normalizer.
+*/
+Normalizer::~Normalizer()
+{
+}
+
+/*!
+** Normalize a text in a single pass. A byte which doesn't begin a valid
+** UTF-8 sequence is read as a Latin-1 character. Punctuation of the
+** U+2000 to U+203F range (typographic quotes, dashes...) separates words
+** like a space.
+**
+** @param text The text to normalize
+** @param length The length of the text
+** @param out Where to write, at least getMaxLength(length) bytes long
+**
+** @return The length of the normalized text
+*/
+unsigned int
+Normalizer::normalize(const char* text, const unsigned int length,
+		      char* out) const
+{
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(text);
+  unsigned int i = 0;
+  unsigned int res = 0;
+
+  while (i < length)
+  {
+#ifdef __SSE2__
+    // Lower 16 ASCII characters at once, until a non ASCII one is found
+    const __m128i before = _mm_set1_epi8('A' - 1);
+    const __m128i after = _mm_set1_epi8('Z' + 1);
+    const __m128i lower = _mm_set1_epi8('a' - 'A');
+    while (i + 16 <= length)
+    {
+      const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+      if (_mm_movemask_epi8(chunk))
+	break;
+      const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chunk, before),
+					  _mm_cmplt_epi8(chunk, after));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + res),
+		       _mm_or_si128(chunk, _mm_and_si128(upper, lower)));
+      i += 16;
+      res += 16;
+    }
+    if (i == length)
+      break;
+#endif
+
+    const unsigned char c = in[i];
+    if (c < 0x80)
+    {
+      out[res++] = _letters[c].text[0];
+      i++;
+      continue;
+    }
+
+    unsigned int size = getSequenceLength(in + i, length - i);
+    if (size == 0)
+    {
+      res += append(c, out + res);
+      size = 1;
+    }
+    else
+      if (size == 2 && c <= 0xC3)
+	res += append(((c & 0x1F) << 6) | (in[i + 1] & 0x3F), out + res);
+      else
+	if (size == 3 && c == 0xE2 && in[i + 1] == 0x80)
+	  out[res++] = ' ';
+	else
+	  for (unsigned int j = 0; j < size; j++)
+	    out[res++] = in[i + j];
+    i += size;
+  }
+
+  return res;
+}
+
+/*!
+** Normalize a text.
+**
+** @param text The text to normalize
+** @param length The length of the text
+** @param out Where to store the normalized text
+*/
+void
+Normalizer::normalize(const char* text, const unsigned int length,
+		      std::string& out) const
+{
+  if (length == 0)
+  {
+    out.clear();
+    return;
+  }
+
+  out.resize(getMaxLength(length));
+  out.resize(normalize(text, length, &out[0]));
+}
+
+/*!
+** Normalize a text.
+**
+** @param text The text to normalize
+** @param out Where to store the normalized text
+*/
+void
+Normalizer::normalize(const std::string& text, std::string& out) const
+{
+  normalize(text.data(), text.length(), out);
+}
@@ -0,0 +1,46 @@
+#ifndef NORMALIZER_HH_
+# define NORMALIZER_HH_
+
+# include <string>
+
+/*!
+** Normalize text before it's split into words: UTF-8 and Latin-1 input
+** are both written in lower case UTF-8, and accents can be folded.
+** Letters of the Latin-1 range are translated by a table built once,
+** other UTF-8 characters are copied as is, and runs of ASCII characters
+** are lowered 16 at a time when SSE2 is available.
+*/
+class Normalizer
+{
+  struct Letter
+  {
+    unsigned char	length;
+    char		text[2];
+  };
+
+public:
+  Normalizer(const bool foldAccents = false);
+  ~Normalizer();
+
+public:
+  static unsigned int getMaxLength(const unsigned int length);
+  unsigned int normalize(const char* text, const unsigned int length,
+			 char* out) const;
+  void normalize(const char* text, const unsigned int length,
+		 std::string& out) const;
+  void normalize(const std::string& text, std::string& out) const;
+  bool getFoldAccents() const;
+
+private:
+  static unsigned int getSequenceLength(const unsigned char* text,
+					const unsigned int length);
+  unsigned int append(const unsigned int code, char* out) const;
+
+private:
+  Letter	_letters[256];
+  const bool	_foldAccents;
+};
+
+# include "Normalizer.hxx"
+
+#endif /* !NORMALIZER_HH_ */
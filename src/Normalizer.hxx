@@ -0,0 +1,73 @@
+/*!
+** Get the size of the buffer needed to normalize a text. A Latin-1
+** letter is the only character which grows, from 1 to 2 bytes.
+**
+** @param length The length of the text
+**
+** @return The maximum length of the normalized text
+*/
+inline unsigned int
+Normalizer::getMaxLength(const unsigned int length)
+{
+  return 2 * length;
+}
+
+/*!
+** Check if accents are folded.
+**
+** @return If accents are folded
+*/
+inline bool
+Normalizer::getFoldAccents() const
+{
+  return _foldAccents;
+}
+
+/*!
+** Get the length of the UTF-8 sequence beginning a text.
+**
+** @param text The text
+** @param length The length of the text
+**
+** @return The length of the sequence, or 0 if it's not valid UTF-8
+*/
+inline unsigned int
+Normalizer::getSequenceLength(const unsigned char* text,
+			      const unsigned int length)
+{
+  unsigned int size = 0;
+  if (text[0] >= 0xC2 && text[0] <= 0xDF)
+    size = 2;
+  else
+    if (text[0] >= 0xE0 && text[0] <= 0xEF)
+      size = 3;
+    else
+      if (text[0] >= 0xF0 && text[0] <= 0xF4)
+	size = 4;
+
+  if (size > length)
+    return 0;
+  for (unsigned int i = 1; i < size; i++)
+    if (text[i] < 0x80 || text[i] > 0xBF)
+      return 0;
+
+  return size;
+}
+
+/*!
+** Write the normalized form of a Latin-1 character.
+**
+** @param code The code point, lower than 256
+** @param out Where to write
+**
+** @return The number of bytes written
+*/
+inline unsigned int
+Normalizer::append(const unsigned int code, char* out) const
+{
+  const Letter& letter = _letters[code];
+  out[0] = letter.text[0];
+  out[1] = letter.text[1];
+
+  return letter.length;
+}
@@ -0,0 +1,262 @@
+#include <memory>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/filesystem/operations.hpp>
+#include "Pipeline.hh"
+#include "StemmerFactory.hh"
+#include "Configuration.hh"
+
+namespace Index
+{
+  namespace
+  {
+    // Number of documents written within a single transaction
+    static const unsigned int BATCH_SIZE = 64;
+
+    // Number of pending items in each queue, per parsing thread
+    static const unsigned int QUEUE_SIZE = 16;
+  }
+
+  /*!
+  ** Construct an indexing pipeline.
+  **
+  ** @param indexer The indexer which parses and writes the documents
+  ** @param jobs The number of parsing threads
+  */
+  Pipeline::Pipeline(const Indexer& indexer, const unsigned int jobs)
+    : _indexer(indexer), _jobs(jobs > 0 ? jobs : 1),
+      _paths(QUEUE_SIZE * _jobs), _parsed(QUEUE_SIZE * _jobs), _running(0)
+  {
+  }
+
+  /*!
+  ** Destruct an indexing pipeline.
+  */
+  Pipeline::~Pipeline()
+  {
+  }
+
+  /*!
+  ** Index all files of a directory, recursively.
+  **
+  ** @param root The full boost path of the directory
+  ** @param unseen The known files, from which the walker removes the
+  ** files it finds. Only read it once run() returns.
+  */
+  void
+  Pipeline::run(const fs::path& root, Indexer::fileSet& unseen)
+  {
+    assert(fs::is_directory(root));
+
+    loadKnownDocuments(root);
+
+    boost::thread_group threads;
+    threads.create_thread(boost::bind(&Pipeline::walk, this, root,
+				      boost::ref(unseen)));
+    _running = _jobs;
+    for (unsigned int i = 0; i < _jobs; i++)
+      threads.create_thread(boost::bind(&Pipeline::parse, this));
+
+    try
+    {
+      write();
+    }
+    catch (...)
+    {
+      abort();
+      threads.join_all();
+      throw;
+    }
+    threads.join_all();
+  }
+
+  /*!
+  ** Load all documents already indexed under the root directory, so that
+  ** the workers can skip unchanged files without reading the database.
+  **
+  ** @param root The full boost path of the directory
+  */
+  void
+  Pipeline::loadKnownDocuments(const fs::path& root)
+  {
+    Index::Database& db = Index::Database::getInstance();
+    std::string directory = root.native_file_string();
+    if (!directory.empty() && directory[directory.length() - 1] == '/')
+      directory.erase(directory.length() - 1);
+
+    const std::list<Column::Document> docs = db.getDocumentsUnder(directory);
+    for (std::list<Column::Document>::const_iterator i = docs.begin();
+	 i != docs.end(); ++i)
+      _known[i->filename] = *i;
+  }
+
+  /*!
+  ** Walker thread: list all files to process, then close the paths queue.
+  **
+  ** @param root The full boost path of the directory
+  ** @param unseen Where to forget the files found
+  */
+  void
+  Pipeline::walk(const fs::path& root, Indexer::fileSet& unseen)
+  {
+    listDirectory(root, unseen);
+    _paths.close();
+  }
+
+  /*!
+  ** List a directory recursively, and push each regular file in the
+  ** paths queue. Hidden files are ignored.
+  **
+  ** @param fullPath The full boost path of the directory
+  ** @param unseen Where to forget the files found
+  */
+  void
+  Pipeline::listDirectory(const fs::path& fullPath, Indexer::fileSet& unseen)
+  {
+    fs::directory_iterator end;
+    for (fs::directory_iterator it(fullPath); it != end; ++it)
+    {
+      try
+      {
+	if (_indexer.isIndexable(it->leaf()))
+	{
+	  if (fs::is_directory(it->status()))
+	    listDirectory(fullPath / it->leaf(), unseen);
+	  else
+	    if (fs::is_regular(it->status()))
+	    {
+	      const std::string filename = (fullPath / it->leaf()).native_file_string();
+	      unseen.erase(filename);
+	      if (!_paths.push(filename))
+		return;
+	    }
+	}
+      }
+      catch (const std::exception & ex)
+      {
+	report(it->leaf(), ex.what());
+      }
+    }
+  }
+
+  /*!
+  ** Worker thread: parse the files with its own stemmer, and push the
+  ** modified documents to the writer. The last worker closes the parsed
+  ** documents queue.
+  */
+  void
+  Pipeline::parse()
+  {
+    Stemmer::StemmerFactory factory;
+    Configuration& cfg = Configuration::getInstance();
+    std::auto_ptr<Stemmer::Generic>
+      stem(factory.get(cfg.getStemmerName(), cfg.getStemCache()));
+    std::string filename;
+
+    while (_paths.pop(filename))
+    {
+      if (_indexer.getVerbose())
+	report(filename, "");
+
+      ParsedDocument* parsed = new ParsedDocument;
+      try
+      {
+	documentsMap::const_iterator known = _known.find(filename);
+	if (known != _known.end())
+	  parsed->doc = known->second;
+	else
+	{
+	  Column::Document doc = {0, "", File::TEXT, "", 0, 0, 0, 0, 0};
+	  parsed->doc = doc;
+	}
+
+	if (_indexer.parseFile(filename, *parsed, *stem) && _parsed.push(parsed))
+	  parsed = 0;
+      }
+      catch (const std::exception & ex)
+      {
+	report(filename, ex.what());
+      }
+      delete parsed;
+    }
+
+    boost::mutex::scoped_lock lock(_mutex);
+    const Stemmer::Caching* cache = dynamic_cast<const Stemmer::Caching*>(stem.get());
+    if (_indexer.getVerbose() && cache)
+      cache->display();
+    if (--_running == 0)
+      _parsed.close();
+  }
+
+  /*!
+  ** Writer, in the calling thread: write all parsed documents, grouping
+  ** them by transactions of BATCH_SIZE documents.
+  */
+  void
+  Pipeline::write()
+  {
+    Index::Database& db = Index::Database::getInstance();
+    ParsedDocument* parsed = 0;
+    unsigned int pending = 0;
+
+    while (_parsed.pop(parsed))
+    {
+      std::auto_ptr<ParsedDocument> guard(parsed);
+
+      // A file unknown at startup may have been indexed since
+      if (!Column::docExists(parsed->doc))
+      {
+	const Column::Document doc = db.getDocumentByFilename(parsed->doc.filename);
+	if (Column::docExists(doc))
+	{
+	  if (doc.hash == parsed->doc.hash)
+	    continue;
+	  parsed->doc.id = doc.id;
+	}
+      }
+
+      if (pending == 0)
+	db.beginTransaction();
+      _indexer.commitDocument(*parsed);
+      if (++pending == BATCH_SIZE)
+      {
+	db.endTransaction();
+	pending = 0;
+      }
+    }
+
+    if (pending > 0)
+      db.endTransaction();
+  }
+
+  /*!
+  ** Stop all threads, and forget the documents not yet written.
+  */
+  void
+  Pipeline::abort()
+  {
+    _paths.close();
+    _parsed.close();
+
+    ParsedDocument* parsed = 0;
+    while (_parsed.pop(parsed))
+      delete parsed;
+  }
+
+  /*!
+  ** Display a message about a file, without mixing the output of
+  ** several threads. Without message, the file is being processed.
+  **
+  ** @param filename The file concerned
+  ** @param message The error message
+  */
+  void
+  Pipeline::report(const std::string& filename, const std::string& message)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    if (message.empty())
+      std::cout << "Processing : " << filename << std::endl;
+    else
+      std::cerr << filename << " : " << message << std::endl;
+  }
+}
@@ -0,0 +1,53 @@
+#ifndef PIPELINE_HH_
+# define PIPELINE_HH_
+
+# include <iostream>
+# include <map>
+# include <boost/filesystem/path.hpp>
+# include <boost/thread/mutex.hpp>
+# include "Column.hh"
+# include "Indexer.hh"
+# include "Queue.hh"
+
+namespace fs = boost::filesystem;
+
+namespace Index
+{
+  /*!
+  ** Index a directory with several threads. A walker thread lists the
+  ** files, several workers read, hash, tokenize and stem them, and the
+  ** calling thread writes the parsed documents in batched transactions.
+  ** Only the calling thread uses the database.
+  */
+  class Pipeline
+  {
+    typedef std::map<std::string, Column::Document> documentsMap;
+
+  public:
+    Pipeline(const Indexer& indexer, const unsigned int jobs);
+    ~Pipeline();
+
+  public:
+    void run(const fs::path& root, Indexer::fileSet& unseen);
+
+  private:
+    void loadKnownDocuments(const fs::path& root);
+    void walk(const fs::path& root, Indexer::fileSet& unseen);
+    void listDirectory(const fs::path& fullPath, Indexer::fileSet& unseen);
+    void parse();
+    void write();
+    void abort();
+    void report(const std::string& filename, const std::string& message);
+
+  private:
+    const Indexer&		_indexer;
+    const unsigned int		_jobs;
+    documentsMap		_known;
+    Queue<std::string>		_paths;
+    Queue<ParsedDocument*>	_parsed;
+    unsigned int		_running;
+    boost::mutex		_mutex;
+  };
+}
+
+#endif /* !PIPELINE_HH_ */
@@ -0,0 +1,3 @@
+#include "Queue.hh"
+
+// See the associated .hxx file
@@ -0,0 +1,36 @@
+#ifndef QUEUE_HH_
+# define QUEUE_HH_
+
+# include <deque>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/condition.hpp>
+
+/*!
+** A bounded blocking queue, shared between producer and consumer threads.
+** Once closed, producers can't push anymore, and consumers get the
+** remaining items, then are released.
+*/
+template<typename T>
+class Queue
+{
+public:
+  Queue(const unsigned int capacity);
+  ~Queue();
+
+public:
+  bool push(const T& item);
+  bool pop(T& item);
+  void close();
+
+private:
+  std::deque<T>		_items;
+  const unsigned int	_capacity;
+  bool			_closed;
+  boost::mutex		_mutex;
+  boost::condition	_notEmpty;
+  boost::condition	_notFull;
+};
+
+# include "Queue.hxx"
+
+#endif /* !QUEUE_HH_ */
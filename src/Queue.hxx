@@ -0,0 +1,78 @@
+/*!
+** Construct a queue.
+**
+** @param capacity Maximum number of items before push blocks
+*/
+template<typename T>
+inline
+Queue<T>::Queue(const unsigned int capacity)
+  : _capacity(capacity > 0 ? capacity : 1), _closed(false)
+{
+}
+
+/*!
+** Destruct a queue.
+*/
+template<typename T>
+inline
+Queue<T>::~Queue()
+{
+}
+
+/*!
+** Push an item, waiting while the queue is full.
+**
+** @param item The item to push
+**
+** @return False if the queue was closed, and item was not pushed
+*/
+template<typename T>
+inline bool
+Queue<T>::push(const T& item)
+{
+  boost::mutex::scoped_lock lock(_mutex);
+  while (!_closed && _items.size() >= _capacity)
+    _notFull.wait(lock);
+  if (_closed)
+    return false;
+  _items.push_back(item);
+  _notEmpty.notify_one();
+
+  return true;
+}
+
+/*!
+** Pop an item, waiting while the queue is empty.
+**
+** @param item Where to store the item
+**
+** @return False if the queue is closed and empty
+*/
+template<typename T>
+inline bool
+Queue<T>::pop(T& item)
+{
+  boost::mutex::scoped_lock lock(_mutex);
+  while (!_closed && _items.empty())
+    _notEmpty.wait(lock);
+  if (_items.empty())
+    return false;
+  item = _items.front();
+  _items.pop_front();
+  _notFull.notify_one();
+
+  return true;
+}
+
+/*!
+** Close the queue, and release all waiting threads.
+*/
+template<typename T>
+inline void
+Queue<T>::close()
+{
+  boost::mutex::scoped_lock lock(_mutex);
+  _closed = true;
+  _notEmpty.notify_all();
+  _notFull.notify_all();
+}
@@ -1,6 +1,9 @@
 #ifndef REQUESTPARSER_HH_
 # define REQUESTPARSER_HH_
 
+// Requests are parsed by several threads of the server at once
+# define BOOST_SPIRIT_THREADSAFE
+
 # include <boost/spirit/utility/chset.hpp>
 # include <boost/spirit/core.hpp>
 # include <boost/spirit/utility/confix.hpp>
@@ -137,11 +140,13 @@ namespace Search
 					 & ~ch_p('&')
 					 & ~ch_p('|')
 					 ))];
-	    escaped_string = leaf_node_d[confix_p('"', *c_escape_ch_p, '"')];
+	    escaped_string = leaf_node_d[confix_p('"', *c_escape_ch_p, '"')
+					 >> !('~' >> +digit_p)];
 
 	    factor
-	      = string_expr
-	      | escaped_string
+	      = escaped_string
+	      | date_expr
+	      | string_expr
 	      | inner_node_d[
 			     '(' >> discard_node_d[*space_p]
 			     >> expression
@@ -149,7 +154,6 @@ namespace Search
 			     ]
 	      | (root_node_d[ch_p('-') | ch_p('+')]
 		 >> discard_node_d[*space_p] >> factor)
-	      | date_expr
 	      ;
  	  }
 
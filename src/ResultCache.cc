@@ -0,0 +1,202 @@
+#include "ResultCache.hh"
+
+namespace Search
+{
+  namespace
+  {
+    // Default number of requests kept in memory
+    static const unsigned int DEFAULT_CAPACITY = 256;
+  }
+
+  /*!
+  ** Construct an empty cache.
+  */
+  ResultCache::ResultCache()
+    : _capacity(DEFAULT_CAPACITY)
+  {
+  }
+
+  /*!
+  ** Destruct the cache.
+  */
+  ResultCache::~ResultCache()
+  {
+  }
+
+  /*!
+  ** Get the results of a request, if cached. The request becomes the
+  ** most recently used one.
+  **
+  ** @param sentence The normalized request
+  ** @param docs Where to store the results
+  **
+  ** @return If the request was cached
+  */
+  bool
+  ResultCache::get(const std::string& sentence, array& docs)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    entriesMap::iterator i = _index.find(sentence);
+    if (i == _index.end())
+      return false;
+
+    _entries.splice(_entries.begin(), _entries, i->second);
+    docs = i->second->docs;
+    return true;
+  }
+
+  /*!
+  ** Cache the results of a request.
+  **
+  ** @param sentence The normalized request
+  ** @param terms The terms of the request
+  ** @param docs The results
+  ** @param idSearch The id of the search saved in database, or 0 if it
+  ** couldn't be saved
+  */
+  void
+  ResultCache::put(const std::string& sentence,
+		   const std::vector<std::string>& terms,
+		   const array& docs, const unsigned int idSearch)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    if (_capacity == 0)
+      return;
+
+    entriesMap::iterator i = _index.find(sentence);
+    if (i != _index.end())
+    {
+      _entries.erase(i->second);
+      _index.erase(i);
+    }
+
+    Entry e;
+    e.sentence = sentence;
+    e.terms = terms;
+    e.docs = docs;
+    e.idSearch = idSearch;
+    _entries.push_front(e);
+    _index[sentence] = _entries.begin();
+    evict();
+  }
+
+  /*!
+  ** Forget the requests whose results may change because a document was
+  ** written or deleted: the ones containing one of its terms, and the ones
+  ** where it was found.
+  **
+  ** @param idDoc The document id
+  ** @param terms The terms of the document, before and after the change
+  */
+  void
+  ResultCache::invalidate(const unsigned int idDoc, const termSet& terms)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    entries::iterator i = _entries.begin();
+    while (i != _entries.end())
+    {
+      bool stale = false;
+      for (std::vector<std::string>::const_iterator t = i->terms.begin();
+	   !stale && t != i->terms.end(); ++t)
+	stale = terms.find(*t) != terms.end();
+      for (array::const_iterator d = i->docs.begin();
+	   !stale && d != i->docs.end(); ++d)
+	stale = d->idDoc == idDoc;
+
+      if (stale)
+      {
+	_index.erase(i->sentence);
+	i = _entries.erase(i);
+      }
+      else
+	++i;
+    }
+  }
+
+  /*!
+  ** Get the ids of the searches saved in database whose results are
+  ** cached.
+  **
+  ** @param searches Where to store the search ids
+  */
+  void
+  ResultCache::getSearches(idSet& searches) const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    searches.clear();
+    for (entries::const_iterator i = _entries.begin(); i != _entries.end(); ++i)
+      if (i->idSearch != 0)
+	searches.insert(i->idSearch);
+  }
+
+  /*!
+  ** Forget the requests whose search isn't saved in database anymore,
+  ** as another process invalidated it. A search saved again has a new
+  ** id, so its older results are forgotten too.
+  **
+  ** @param searches The ids of the searches still saved
+  */
+  void
+  ResultCache::retain(const idSet& searches)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    entries::iterator i = _entries.begin();
+    while (i != _entries.end())
+      if (searches.find(i->idSearch) == searches.end())
+      {
+	_index.erase(i->sentence);
+	i = _entries.erase(i);
+      }
+      else
+	++i;
+  }
+
+  /*!
+  ** Set the maximum number of cached requests.
+  **
+  ** @param capacity The number of requests, 0 disables the cache
+  */
+  void
+  ResultCache::setCapacity(const unsigned int capacity)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    _capacity = capacity;
+    evict();
+  }
+
+  /*!
+  ** Check if no request is cached, so that invalidation can be skipped.
+  **
+  ** @return If the cache is empty
+  */
+  bool
+  ResultCache::empty() const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    return _entries.empty();
+  }
+
+  /*!
+  ** Forget all cached requests.
+  */
+  void
+  ResultCache::clear()
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    _entries.clear();
+    _index.clear();
+  }
+
+  /*!
+  ** Drop the least recently used requests, down to the capacity.
+  */
+  void
+  ResultCache::evict()
+  {
+    while (_entries.size() > _capacity)
+    {
+      _index.erase(_entries.back().sentence);
+      _entries.pop_back();
+    }
+  }
+}
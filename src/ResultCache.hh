@@ -0,0 +1,69 @@
+#ifndef RESULTCACHE_HH_
+# define RESULTCACHE_HH_
+
+# include <iostream>
+# include <list>
+# include <map>
+# include <set>
+# include <vector>
+# include <tr1/unordered_set>
+# include <boost/thread/mutex.hpp>
+# include "Column.hh"
+# include "Singleton.hh"
+
+namespace Search
+{
+  /*!
+  ** In memory cache of the last search results, keyed by the normalized
+  ** request, and evicting the least recently used one when full.
+  ** It sits in front of the Search and Result tables, which keep the
+  ** results between two runs.
+  */
+  class ResultCache : public Singleton<ResultCache>
+  {
+    friend class Singleton<ResultCache>;
+
+  public:
+    typedef std::list< ::Index::Column::DocumentResult> array;
+    typedef std::tr1::unordered_set<std::string> termSet;
+    typedef std::set<unsigned int> idSet;
+
+  private:
+    struct Entry
+    {
+      std::string		sentence;
+      std::vector<std::string>	terms;
+      array			docs;
+      unsigned int		idSearch;
+    };
+    typedef std::list<Entry> entries;
+    typedef std::map<std::string, entries::iterator> entriesMap;
+
+  private:
+    ResultCache();
+    ~ResultCache();
+
+  public:
+    bool get(const std::string& sentence, array& docs);
+    void put(const std::string& sentence,
+	     const std::vector<std::string>& terms,
+	     const array& docs, const unsigned int idSearch);
+    void invalidate(const unsigned int idDoc, const termSet& terms);
+    void getSearches(idSet& searches) const;
+    void retain(const idSet& searches);
+    void setCapacity(const unsigned int capacity);
+    bool empty() const;
+    void clear();
+
+  private:
+    void evict();
+
+  private:
+    entries		_entries;
+    entriesMap		_index;
+    unsigned int	_capacity;
+    mutable boost::mutex	_mutex;
+  };
+}
+
+#endif /* !RESULTCACHE_HH_ */
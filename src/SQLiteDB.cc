@@ -27,10 +27,19 @@ namespace SQLite
     return *this;
   }
 
+  /*!
+  ** Open a database, created if it doesn't exist, unless it's opened
+  ** read-only.
+  **
+  ** @param szFile The database file
+  ** @param readOnly If the database is only read
+  */
   void
-  DB::open(const char* szFile)
+  DB::open(const char* szFile, const bool readOnly)
   {
-    int nRet = sqlite3_open(szFile, &_mpDB);
+    const int flags = readOnly ? SQLITE_OPEN_READONLY :
+      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+    int nRet = sqlite3_open_v2(szFile, &_mpDB, flags, 0);
 
     if (nRet != SQLITE_OK)
     {
@@ -46,6 +55,7 @@ namespace SQLite
   {
     if (_mpDB)
     {
+      clearStatements();
       sqlite3_close(_mpDB);
       _mpDB = 0;
     }
@@ -60,6 +70,43 @@ namespace SQLite
     return Statement(_mpDB, pVM);
   }
 
+  /*!
+  ** Get a compiled statement from the cache, compiling it on first use.
+  ** The statement is reset, so it can be bound and executed again. The
+  ** same SQL must not be used again while a query on it is still alive.
+  **
+  ** @param szSQL The SQL text, with ? for each parameter
+  **
+  ** @return The cached statement, owned by the database
+  */
+  Statement&
+  DB::cachedStatement(const char* szSQL)
+  {
+    checkDB();
+
+    statements::iterator i = _statements.find(szSQL);
+    if (i != _statements.end())
+    {
+      i->second->reset();
+      return *i->second;
+    }
+
+    Statement* stmt = new Statement(_mpDB, compile(szSQL));
+    _statements.insert(std::make_pair(std::string(szSQL), stmt));
+    return *stmt;
+  }
+
+  /*!
+  ** Finalize and forget all cached statements.
+  */
+  void
+  DB::clearStatements()
+  {
+    for (statements::iterator i = _statements.begin(); i != _statements.end(); ++i)
+      delete i->second;
+    _statements.clear();
+  }
+
   bool
   DB::tableExists(const char* szTable)
   {
@@ -170,13 +217,15 @@ namespace SQLite
   {
     checkDB();
 
-    char* szError=0;
     const char* szTail=0;
     sqlite3_stmt* pVM;
 
-    int nRet = sqlite3_prepare(_mpDB, szSQL, -1, &pVM, &szTail);
+    int nRet = sqlite3_prepare_v2(_mpDB, szSQL, -1, &pVM, &szTail);
     if (nRet != SQLITE_OK)
-      throw Exception(nRet, szError);
+    {
+      const char* szError = sqlite3_errmsg(_mpDB);
+      throw Exception(nRet, (char*)szError, DONT_DELETE_MSG);
+    }
 
     return pVM;
   }
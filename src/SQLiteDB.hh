@@ -1,6 +1,8 @@
 #ifndef SQLITEDB_HH_
 # define SQLITEDB_HH_
 
+# include <map>
+# include <string>
 # include "SQLite.hh"
 # include "SQLiteTable.hh"
 # include "SQLiteQuery.hh"
@@ -15,7 +17,7 @@ namespace SQLite
     virtual ~DB();
 
   public:
-    void open(const char* szFile);
+    void open(const char* szFile, const bool readOnly = false);
     void close();
     bool tableExists(const char* szTable);
     int execDML(const char* szSQL);
@@ -23,9 +25,15 @@ namespace SQLite
     int execScalar(const char* szSQL);
     Table getTable(const char* szSQL);
     Statement compileStatement(const char* szSQL);
+    Statement& cachedStatement(const char* szSQL);
     sqlite_int64 lastRowId();
     void setBusyTimeout(int nMillisecs);
 
+    int getBusyTimeout() const
+    {
+      return _mnBusyTimeoutMs;
+    }
+
     void interrupt()
     {
       sqlite3_interrupt(_mpDB);
@@ -35,15 +43,20 @@ namespace SQLite
       return SQLITE_VERSION;
     }
 
+  private:
+    typedef std::map<std::string, Statement*> statements;
+
   private:
     DB(const DB& db);
     DB& operator=(const DB& db);
     sqlite3_stmt* compile(const char* szSQL);
+    void clearStatements();
     void checkDB();
 
   private:
     sqlite3*	_mpDB;
     int		_mnBusyTimeoutMs;
+    statements	_statements;
   };
 }
 #endif /* !SQLITEDB_HH_ */
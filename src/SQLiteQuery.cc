@@ -13,6 +13,7 @@ namespace SQLite
 
   Query::Query(const Query& rQuery)
   {
+    _mpDB = rQuery._mpDB;
     _mpVM = rQuery._mpVM;
     // Only one object can own the VM
     const_cast<Query&>(rQuery)._mpVM = 0;
@@ -54,6 +55,7 @@ namespace SQLite
     catch (...)
     {
     }
+    _mpDB = rQuery._mpDB;
     _mpVM = rQuery._mpVM;
     // Only one object can own the VM
     const_cast<Query&>(rQuery)._mpVM = 0;
@@ -112,6 +114,26 @@ namespace SQLite
     return getIntField(nField, nNullValue);
   }
 
+  sqlite_int64
+  Query::getInt64Field(int nField, sqlite_int64 nNullValue/*=0*/)
+  {
+    if (fieldDataType(nField) == SQLITE_NULL)
+    {
+      return nNullValue;
+    }
+    else
+    {
+      return sqlite3_column_int64(_mpVM, nField);
+    }
+  }
+
+  sqlite_int64
+  Query::getInt64Field(const char* szField, sqlite_int64 nNullValue/*=0*/)
+  {
+    int nField = fieldIndex(szField);
+    return getInt64Field(nField, nNullValue);
+  }
+
   double
   Query::getFloatField(int nField, double fNullValue/*=0.0*/)
   {
@@ -281,7 +303,8 @@ namespace SQLite
     }
     else
     {
-      nRet = sqlite3_finalize(_mpVM);
+      // A VM owned by a statement is only reset, the statement will reuse it
+      nRet = _mbOwnVM ? sqlite3_finalize(_mpVM) : sqlite3_reset(_mpVM);
       _mpVM = 0;
       const char* szError = sqlite3_errmsg(_mpDB);
       throw Exception(nRet,
@@ -303,6 +326,13 @@ namespace SQLite
 	throw Exception(nRet, (char*)szError, DONT_DELETE_MSG);
       }
     }
+    else
+      if (_mpVM)
+      {
+	// Release the statement, so that it doesn't hold a read lock
+	sqlite3_reset(_mpVM);
+	_mpVM = 0;
+      }
   }
 
   void
@@ -28,6 +28,8 @@ namespace SQLite
     const char* fieldValue(const char* szField);
     int getIntField(int nField, int nNullValue=0);
     int getIntField(const char* szField, int nNullValue=0);
+    sqlite_int64 getInt64Field(int nField, sqlite_int64 nNullValue=0);
+    sqlite_int64 getInt64Field(const char* szField, sqlite_int64 nNullValue=0);
     double getFloatField(int nField, double fNullValue=0.0);
     double getFloatField(const char* szField, double fNullValue=0.0);
     const char* getStringField(int nField, const char* szNullValue="");
@@ -130,6 +130,34 @@ namespace SQLite
     }
   }
 
+  void
+  Statement::bind(int nParam, const unsigned int nValue)
+  {
+    checkVM();
+    int nRes = sqlite3_bind_int64(_mpVM, nParam, nValue);
+
+    if (nRes != SQLITE_OK)
+    {
+      throw Exception(nRes,
+		      (char*) "Error binding unsigned int param",
+		      DONT_DELETE_MSG);
+    }
+  }
+
+  void
+  Statement::bind(int nParam, const sqlite_int64 nValue)
+  {
+    checkVM();
+    int nRes = sqlite3_bind_int64(_mpVM, nParam, nValue);
+
+    if (nRes != SQLITE_OK)
+    {
+      throw Exception(nRes,
+		      (char*) "Error binding int64 param",
+		      DONT_DELETE_MSG);
+    }
+  }
+
   void
   Statement::bind(int nParam, const double dValue)
   {
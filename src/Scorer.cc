@@ -0,0 +1,18 @@
+#include "Scorer.hh"
+
+namespace Search
+{
+  /*!
+  ** Construct a scorer.
+  */
+  Scorer::Scorer()
+  {
+  }
+
+  /*!
+  ** Destruct a scorer.
+  */
+  Scorer::~Scorer()
+  {
+  }
+}
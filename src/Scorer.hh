@@ -0,0 +1,30 @@
+#ifndef SCORER_HH_
+# define SCORER_HH_
+
+# include <string>
+# include "Column.hh"
+
+namespace Search
+{
+  /*!
+  ** Rank the documents containing a term of a request. The scorer is
+  ** first given the statistics of the term in the whole collection, then
+  ** scores each posting of the term from its own statistics and the
+  ** length of its document. The score of a document for a request is
+  ** the sum of the scores of its terms.
+  */
+  class Scorer
+  {
+  public:
+    Scorer();
+    virtual ~Scorer();
+    virtual const std::string getName() const = 0;
+    virtual bool isPrecomputed() const = 0;
+    virtual void setTerm(const Index::Column::Collection& collection,
+			 const unsigned int documentCount) = 0;
+    virtual double score(const Index::Column::Word& word,
+			 const unsigned int length) const = 0;
+  };
+}
+
+#endif /* !SCORER_HH_ */
@@ -0,0 +1,94 @@
+#include <cmath>
+#include <algorithm>
+#include "ScorerBM25F.hh"
+
+namespace Search
+{
+  namespace
+  {
+    // Saturation of the term frequency
+    static const double K1 = 1.2;
+
+    // Part of the frequency normalized by the document length
+    static const double B = 0.75;
+
+    // Weight of an occurence in each field, in Index::Field order
+    static const double FIELD_WEIGHTS[Index::Field::COUNT] = { 1, 3, 2, 2.5 };
+  }
+
+  /*!
+  ** Construct a BM25F scorer.
+  */
+  BM25FScorer::BM25FScorer()
+    : _idf(0), _averageLength(0)
+  {
+  }
+
+  /*!
+  ** Destruct a BM25F scorer.
+  */
+  BM25FScorer::~BM25FScorer()
+  {
+  }
+
+  /*!
+  ** Get the name of the scorer, as given on the command line.
+  **
+  ** @return The name
+  */
+  const std::string
+  BM25FScorer::getName() const
+  {
+    return "bm25";
+  }
+
+  /*!
+  ** Check if the scores are the ones stored when indexing.
+  **
+  ** @return Always false, scores depend on the collection
+  */
+  bool
+  BM25FScorer::isPrecomputed() const
+  {
+    return false;
+  }
+
+  /*!
+  ** Compute the inverse document frequency of the next term scored, and
+  ** the average length of the documents.
+  **
+  ** @param collection The number of documents and their total length
+  ** @param documentCount The number of documents containing the term
+  */
+  void
+  BM25FScorer::setTerm(const Index::Column::Collection& collection,
+		       const unsigned int documentCount)
+  {
+    const double n = collection.documents;
+    const double df = std::min(documentCount, collection.documents);
+    _idf = std::log(1 + (n - df + 0.5) / (df + 0.5));
+    _averageLength = collection.documents > 0 ?
+      static_cast<double>(collection.length) / collection.documents : 0;
+  }
+
+  /*!
+  ** Get the score of the term in a document.
+  **
+  ** @param word The word of the term in the document
+  ** @param length The length of the document
+  **
+  ** @return The score
+  */
+  double
+  BM25FScorer::score(const Index::Column::Word& word,
+		     const unsigned int length) const
+  {
+    double tf = 0;
+    for (unsigned int f = 0; f < Index::Field::COUNT; f++)
+      tf += FIELD_WEIGHTS[f] * word.fieldCounts[f];
+    if (_averageLength > 0)
+      tf /= 1 - B + B * length / _averageLength;
+
+    return _idf * tf * (K1 + 1) / (tf + K1);
+  }
+}
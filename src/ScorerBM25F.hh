@@ -0,0 +1,33 @@
+#ifndef SCORERBM25F_HH_
+# define SCORERBM25F_HH_
+
+# include "Scorer.hh"
+
+namespace Search
+{
+  /*!
+  ** Rank documents with BM25F. The occurences of a term in each field
+  ** of a document are weighted, then summed and normalized by the length
+  ** of the document compared to the average one. This frequency is
+  ** saturated, and multiplied by the inverse document frequency of the
+  ** term, so that a common term weighs less than a rare one.
+  */
+  class BM25FScorer : public Scorer
+  {
+  public:
+    BM25FScorer();
+    virtual ~BM25FScorer();
+    virtual const std::string getName() const;
+    virtual bool isPrecomputed() const;
+    virtual void setTerm(const Index::Column::Collection& collection,
+			 const unsigned int documentCount);
+    virtual double score(const Index::Column::Word& word,
+			 const unsigned int length) const;
+
+  private:
+    double	_idf;
+    double	_averageLength;
+  };
+}
+
+#endif /* !SCORERBM25F_HH_ */
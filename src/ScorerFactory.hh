@@ -0,0 +1,20 @@
+#ifndef SCORERFACTORY_HH_
+# define SCORERFACTORY_HH_
+
+# include <cassert>
+# include "Scorer.hh"
+# include "ScorerStatic.hh"
+# include "ScorerBM25F.hh"
+
+namespace Search
+{
+  class ScorerFactory
+  {
+  public:
+    static Scorer* get(const std::string& type);
+  };
+}
+
+# include "ScorerFactory.hxx"
+
+#endif /* !SCORERFACTORY_HH_ */
@@ -0,0 +1,23 @@
+namespace Search
+{
+  /*!
+  ** Instanciate correct scorer depending on given type.
+  **
+  ** @param type The type of scorer to instanciate, "bm25" or "static"
+  **
+  ** @return An instance of correct scorer
+  */
+  inline Scorer*
+  ScorerFactory::get(const std::string& type)
+  {
+    Scorer* scorer = 0;
+    if (type == "bm25")
+      scorer = new Search::BM25FScorer();
+    else
+      if (type == "static")
+	scorer = new Search::StaticScorer();
+
+    assert(scorer);
+    return scorer;
+  }
+}
@@ -0,0 +1,62 @@
+#include "ScorerStatic.hh"
+
+namespace Search
+{
+  /*!
+  ** Construct a static scorer.
+  */
+  StaticScorer::StaticScorer()
+  {
+  }
+
+  /*!
+  ** Destruct a static scorer.
+  */
+  StaticScorer::~StaticScorer()
+  {
+  }
+
+  /*!
+  ** Get the name of the scorer, as given on the command line.
+  **
+  ** @return The name
+  */
+  const std::string
+  StaticScorer::getName() const
+  {
+    return "static";
+  }
+
+  /*!
+  ** Check if the scores are the ones stored when indexing, so that the
+  ** best documents of a term can be read first from the index.
+  **
+  ** @return Always true
+  */
+  bool
+  StaticScorer::isPrecomputed() const
+  {
+    return true;
+  }
+
+  /*!
+  ** Statistics of the collection are not used.
+  */
+  void
+  StaticScorer::setTerm(const Index::Column::Collection&, const unsigned int)
+  {
+  }
+
+  /*!
+  ** Get the score of a term in a document.
+  **
+  ** @param word The word of the term in the document
+  **
+  ** @return The score computed when indexing
+  */
+  double
+  StaticScorer::score(const Index::Column::Word& word, const unsigned int) const
+  {
+    return word.score;
+  }
+}
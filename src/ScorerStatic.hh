@@ -0,0 +1,27 @@
+#ifndef SCORERSTATIC_HH_
+# define SCORERSTATIC_HH_
+
+# include "Scorer.hh"
+
+namespace Search
+{
+  /*!
+  ** Rank documents with the score computed for each word when it was
+  ** indexed, from its weight and its counts, divided by the length of
+  ** its document. It ignores how common a term is.
+  */
+  class StaticScorer : public Scorer
+  {
+  public:
+    StaticScorer();
+    virtual ~StaticScorer();
+    virtual const std::string getName() const;
+    virtual bool isPrecomputed() const;
+    virtual void setTerm(const Index::Column::Collection& collection,
+			 const unsigned int documentCount);
+    virtual double score(const Index::Column::Word& word,
+			 const unsigned int length) const;
+  };
+}
+
+#endif /* !SCORERSTATIC_HH_ */
@@ -1,13 +1,22 @@
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <boost/tokenizer.hpp>
 #include "Searcher.hh"
 #include "ParseException.hh"
 #include "Column.hh"
+#include "ScorerFactory.hh"
 
 namespace Search
 {
   /*!
-  ** Construct a search object.
+  ** Construct a search object, with the configured scorer.
   */
   Searcher::Searcher()
+    : _normalizer(Configuration::getInstance().getFoldAccents()),
+      _scorer(ScorerFactory::get(Configuration::getInstance().getScorerName())),
+      _stopWordsLoaded(false)
   {
   }
 
@@ -41,13 +50,387 @@ namespace Search
 	  " - " << i->rank << "%" << std::endl;
   }
 
+  /*!
+  ** Add a found document.
+  **
+  ** @param id The document id
+  ** @param rank The document score
+  */
+  void
+  Searcher::addDocument(const unsigned int id, const double rank)
+  {
+    Index::Database& db = Index::Database::getInstance();
+    const Index::Column::Document doc = db.getDocumentById(id);
+    if (!Index::Column::docExists(doc))
+      return;
+
+    Index::Column::DocumentResult res;
+    static_cast<Index::Column::Document&>(res) = doc;
+    res.idSearch = 0;
+    res.idDoc = doc.id;
+    res.rank = rank;
+    _docFound.push_back(res);
+  }
+
+  /*!
+  ** Get the documents of a posting list, with their score as rank.
+  **
+  ** @param postings The posting list
+  */
+  void
+  Searcher::fillDocuments(const PostingList& postings)
+  {
+    clean();
+    for (unsigned int i = 0; i < postings.ids.size(); i++)
+      addDocument(postings.ids[i], postings.scores[i]);
+  }
+
+  /*!
+  ** Get the documents selected as the best ones, the best first.
+  **
+  ** @param top The selected documents
+  */
+  void
+  Searcher::fillDocuments(const TopK& top)
+  {
+    const std::vector<TopK::entry> ranked = top.getSorted();
+    clean();
+    for (std::vector<TopK::entry>::const_iterator i = ranked.begin();
+	 i != ranked.end(); ++i)
+      addDocument(i->second, i->first);
+  }
+
+  /*!
+  ** Load the stop words of the indexer, the first time a phrase is
+  ** split: they aren't indexed, but they still take a position.
+  */
+  void
+  Searcher::loadStopWords() const
+  {
+    if (_stopWordsLoaded)
+      return;
+    _stopWordsLoaded = true;
+
+    Configuration& cfg = Configuration::getInstance();
+    if (cfg.getStopwordFilename().empty())
+      _stopWords.loadDefault(_normalizer);
+    else
+      if (!_stopWords.load(cfg.getStopwordFilename(), _normalizer))
+	std::cerr << cfg.getStopwordFilename() << " : Can't read stop words" << std::endl;
+  }
+
+  /*!
+  ** Check that all dates of a request are valid.
+  **
+  ** @param i The iterator of the AST
+  **
+  ** @return If the request has a date
+  */
+  bool
+  Searcher::checkDates(iter_t const& i) const
+  {
+    if (i->value.id() == spirit::parser_id(Request::NodeId::dateID) ||
+	i->value.id() == spirit::parser_id(Request::NodeId::date_exprID))
+    {
+      long long from;
+      long long to;
+      getDateRange(i, from, to);
+      return true;
+    }
+
+    bool found = false;
+    for (iter_t child = i->children.begin(); child != i->children.end(); ++child)
+      found = checkDates(child) || found;
+
+    return found;
+  }
+
+  /*!
+  ** Get the period selected by a date expression. A single date selects
+  ** its day, "<" the days before it, ">" the days after it, and a range
+  ** both of its days and the ones between them.
+  ** Throw a parse error on an invalid date.
+  **
+  ** @param i The iterator of the AST, on a date expression
+  ** @param from Where to store the first second of the period
+  ** @param to Where to store the first second after the period
+  */
+  void
+  Searcher::getDateRange(iter_t const& i, long long& from, long long& to) const
+  {
+    std::string expr(i->value.begin(), i->value.end());
+    expr.erase(std::remove_if(expr.begin(), expr.end(), ::isspace), expr.end());
+    const std::string::size_type open = expr.find('(');
+    const std::string::size_type close = expr.rfind(')');
+    if (open != std::string::npos && close != std::string::npos && close > open)
+      expr = expr.substr(open + 1, close - open - 1);
+
+    from = std::numeric_limits<long long>::min();
+    to = std::numeric_limits<long long>::max();
+    if (!expr.empty() && expr[0] == '<')
+      to = DateUtils::stringDateToTimestamp(expr.substr(1));
+    else
+      if (!expr.empty() && expr[0] == '>')
+	from = DateUtils::nextDay(DateUtils::stringDateToTimestamp(expr.substr(1)));
+      else
+      {
+	const std::string::size_type dash = expr.find('-');
+	from = DateUtils::stringDateToTimestamp(expr.substr(0, dash));
+	if (dash == std::string::npos)
+	  to = DateUtils::nextDay(from);
+	else
+	  to = DateUtils::nextDay(DateUtils::stringDateToTimestamp(expr.substr(dash + 1)));
+      }
+  }
+
+  /*!
+  ** Split a quoted phrase into terms, like the indexer splits a line:
+  ** punctuation is ignored, and words which are not indexed only take
+  ** a position.
+  **
+  ** @param i The iterator of the AST, on an escaped string expression
+  ** @param terms Where to store the terms of the phrase
+  ** @param offsets Where to store the position of each term, relative
+  ** to the first one
+  **
+  ** @return The number of words allowed between the terms, after "~"
+  */
+  unsigned int
+  Searcher::getPhraseTerms(iter_t const& i, std::vector<std::string>& terms,
+			   std::vector<unsigned int>& offsets) const
+  {
+    typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+
+    const std::string value(i->value.begin(), i->value.end());
+    const std::string::size_type end = value.rfind('"');
+    assert(end != std::string::npos && end > 0);
+    unsigned int slop = 0;
+    if (end + 1 < value.length() && value[end + 1] == '~')
+      slop = strtoul(value.c_str() + end + 2, 0, 10);
+
+    loadStopWords();
+    std::string phrase;
+    _normalizer.normalize(value.substr(1, end - 1), phrase);
+    terms.clear();
+    offsets.clear();
+    unsigned int position = 0;
+    tokenizer tokens(phrase);
+    for (tokenizer::iterator tok_iter = tokens.begin();
+	 tok_iter != tokens.end(); ++tok_iter)
+    {
+      const std::string& tmp = *tok_iter;
+      if (std::ispunct(tmp[0]))
+	continue;
+      if (tmp.length() > 1 && !_stopWords.contains(tmp))
+      {
+	if (terms.empty())
+	  position = 0;
+	terms.push_back(tmp);
+	offsets.push_back(position);
+      }
+      position++;
+    }
+
+    return slop;
+  }
+
+  /*!
+  ** Find the documents where the terms of a phrase are at their
+  ** offsets, or close enough with "~N". Documents having all terms are
+  ** found first, then only their positions are read.
+  **
+  ** @param i The iterator of the AST, on an escaped string expression
+  ** @param res Where to store the posting list
+  */
+  void
+  Searcher::evaluatePhrase(iter_t const& i, PostingList& res)
+  {
+    Index::Database& db = Index::Database::getInstance();
+    std::vector<std::string> terms;
+    std::vector<unsigned int> offsets;
+    const unsigned int slop = getPhraseTerms(i, terms, offsets);
+    ArrayUtils::clear(res);
+    if (terms.empty())
+      return;
+
+    PostingList candidates;
+    db.getPostings(terms[0], *_scorer, candidates);
+    for (unsigned int t = 1; t < terms.size() && !candidates.ids.empty(); t++)
+    {
+      PostingList found;
+      db.intersectPostings(terms[t], *_scorer, candidates, found);
+      ArrayUtils::swap(candidates, found);
+    }
+    if (terms.size() == 1)
+    {
+      ArrayUtils::swap(res, candidates);
+      return;
+    }
+
+    // A term repeated in the phrase has its positions read once
+    std::vector<std::vector<std::vector<unsigned int> > > positions(terms.size());
+    std::vector<unsigned int> sources(terms.size());
+    for (unsigned int t = 0; t < terms.size(); t++)
+    {
+      sources[t] = std::find(terms.begin(), terms.end(), terms[t]) - terms.begin();
+      if (sources[t] == t)
+	db.getPositions(terms[t], candidates, positions[t]);
+    }
+
+    std::vector<const std::vector<unsigned int>*> document(terms.size());
+    std::vector<const std::vector<unsigned int>*> distinct;
+    for (unsigned int c = 0; c < candidates.ids.size(); c++)
+    {
+      distinct.clear();
+      for (unsigned int t = 0; t < terms.size(); t++)
+      {
+	document[t] = &positions[sources[t]][c];
+	if (sources[t] == t)
+	  distinct.push_back(document[t]);
+      }
+      if (slop == 0 ? isPhrase(document, offsets) :
+	  isNear(distinct, offsets.back() + slop))
+	ArrayUtils::append(res, candidates.ids[c], candidates.scores[c]);
+    }
+  }
+
+  /*!
+  ** Check if the terms of a phrase follow each other in a document.
+  **
+  ** @param positions The sorted positions of each term in the document
+  ** @param offsets The position of each term in the phrase
+  **
+  ** @return If the terms are found at their offsets
+  */
+  bool
+  Searcher::isPhrase(const std::vector<const std::vector<unsigned int>*>& positions,
+		     const std::vector<unsigned int>& offsets)
+  {
+    const std::vector<unsigned int>& first = *positions[0];
+    for (unsigned int p = 0; p < first.size(); p++)
+    {
+      unsigned int t = 1;
+      while (t < positions.size() &&
+	     std::binary_search(positions[t]->begin(), positions[t]->end(),
+				first[p] + offsets[t]))
+	t++;
+      if (t == positions.size())
+	return true;
+    }
+
+    return false;
+  }
+
+  /*!
+  ** Check if the terms are all found in a small window of a document,
+  ** in any order. The smallest windows are walked by moving forward the
+  ** term at their beginning.
+  **
+  ** @param positions The sorted positions of each distinct term
+  ** @param span The maximum distance between the first and the last term
+  **
+  ** @return If a window is small enough
+  */
+  bool
+  Searcher::isNear(const std::vector<const std::vector<unsigned int>*>& positions,
+		   const unsigned int span)
+  {
+    std::vector<unsigned int> current(positions.size(), 0);
+    for (;;)
+    {
+      unsigned int first = 0;
+      unsigned int last = 0;
+      for (unsigned int t = 0; t < positions.size(); t++)
+      {
+	if (current[t] >= positions[t]->size())
+	  return false;
+	const unsigned int pos = (*positions[t])[current[t]];
+	if (pos < (*positions[first])[current[first]])
+	  first = t;
+	if (pos > (*positions[last])[current[last]])
+	  last = t;
+      }
+      if ((*positions[last])[current[last]] -
+	  (*positions[first])[current[first]] <= span)
+	return true;
+      current[first]++;
+    }
+  }
+
+  /*!
+  ** Find the k best documents matching a request. Only these k
+  ** documents are read from the database.
+  ** A single term is read in score order, and stops after k documents.
+  ** A disjunction of terms skips the documents which can't be kept.
+  ** Any other request is evaluated completely, then selected.
+  **
+  ** @param tree The AST of the request
+  ** @param k The number of documents wanted
+  */
+  void
+  Searcher::selectBest(iter_t const& tree, const unsigned int k)
+  {
+    Index::Database& db = Index::Database::getInstance();
+    std::vector<std::string> terms;
+    TopK top(k);
+
+    if (collectDisjunction(tree, terms))
+    {
+      if (terms.size() == 1)
+	db.getBestDocuments(terms.front(), k, *_scorer, top);
+      else
+      {
+	std::vector<PostingList> lists(terms.size());
+	std::vector<const PostingList*> operands;
+	for (unsigned int i = 0; i < terms.size(); i++)
+	{
+	  db.getPostings(terms[i], *_scorer, lists[i]);
+	  operands.push_back(&lists[i]);
+	}
+	top.addDisjunction(operands);
+      }
+    }
+    else
+    {
+      PostingList postings;
+      if (!evaluateRequest(tree, postings))
+	top.addAll(postings);
+    }
+    fillDocuments(top);
+  }
+
+  /*!
+  ** Find the documents matching a request, without cache.
+  **
+  ** @param tree The AST of the request
+  ** @param k The maximum number of documents wanted, or 0 for no limit
+  */
+  void
+  Searcher::evaluate(iter_t const& tree, const unsigned int k)
+  {
+    clean();
+    if (k > 0)
+      selectBest(tree, k);
+    else
+    {
+      PostingList postings;
+      if (!evaluateRequest(tree, postings))
+	fillDocuments(postings);
+      _docFound.sort();
+    }
+  }
+
   /*!
   ** Find and stock all expression found.
+  ** Without limit, all matching documents are found.
   **
   ** @param request The document search request
+  ** @param k The maximum number of documents wanted, or 0 for no limit
+  ** @param err Where to explain why the request can't be parsed
   */
   void
-  Searcher::search(const std::string& request)
+  Searcher::search(const std::string& request, const unsigned int k,
+		   std::ostream& err)
   {
     //     const std::string dbg = ":date(34/34/34-34/34/34) + "
     //       ":date(> 45/45/45) :date(< 45/45/45) myexpr + rere OR "
@@ -55,11 +438,13 @@ namespace Search
 
     std::string clean = "";
     Request::Parser parser(request);
+    bool dated = false;
     try
     {
       //Request::Parser parser(dbg);
       parser.parseQuery();
       clean = parser.toString();
+      dated = checkDates(parser.getTree());
       Configuration& cfg = Configuration::getInstance();
       if (cfg.getVerbose())
       {
@@ -69,22 +454,56 @@ namespace Search
     }
     catch (const Request::ParseException& ex)
     {
-      std::cerr << "An error occured when parsing request." << std::endl <<
+      _docFound.clear();
+      err << "An error occured when parsing request." << std::endl <<
 	"Last tokens match are : " << ex.what() << std::endl;
       return;
     }
 
-    // Check if a similar search was already done.
-    // If so, just get previous result.
+    // Dates depend on the day of the search, and a document changing of
+    // date doesn't invalidate cached searches, so they are never cached
+    if (dated)
+    {
+      Index::Database::Snapshot snapshot;
+      evaluate(parser.getTree(), k);
+      return;
+    }
+
+    // A limited search only knows the best documents, so it's cached
+    // apart from the complete one. Each scorer ranks them otherwise. With
+    // BM25, cached ranks keep the statistics of the collection they were
+    // computed with, until one of their terms or documents changes.
+    std::ostringstream sentence;
+    sentence << clean;
+    if (k > 0)
+      sentence << " :limit(" << k << ")";
+    sentence << " :scorer(" << _scorer->getName() << ")";
+
+    // Check if a similar search was already done, first in memory, then
+    // in database. If so, just get previous result.
+    ResultCache& cache = ResultCache::getInstance();
+    if (cache.get(sentence.str(), _docFound))
+      return;
+
+    std::vector<std::string> terms;
+    collectTerms(parser.getTree(), terms);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    // The request is read from a single snapshot, which ends before
+    // its results are saved by the writer
     Index::Database& db = Index::Database::getInstance();
-    unsigned int id = db.getSimilarRequest(clean);
-    if (id == 0)
+    unsigned int id;
     {
-      evaluateRequest(parser.getTree());
-      _docFound.sort();
-      db.saveResults(_docFound, clean);
+      Index::Database::Snapshot snapshot;
+      id = db.getSimilarRequest(sentence.str());
+      if (id == 0)
+	evaluate(parser.getTree(), k);
+      else
+	_docFound = db.getCachedSearchResult(id);
     }
-    else
-      _docFound = db.getCachedSearchResult(id);
+    if (id == 0)
+      id = db.saveResults(_docFound, sentence.str(), terms);
+    cache.put(sentence.str(), terms, _docFound, id);
   }
 }
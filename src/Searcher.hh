@@ -3,15 +3,29 @@
 
 # include <iostream>
 # include <list>
+# include <memory>
+# include <vector>
 # include "Column.hh"
 # include "Database.hh"
 # include "Configuration.hh"
 # include "RequestParser.hh"
 # include "DateUtils.hh"
 # include "ArrayUtils.hh"
+# include "TopK.hh"
+# include "ResultCache.hh"
+# include "Normalizer.hh"
+# include "Scorer.hh"
+# include "StopWords.hh"
 
 namespace Search
 {
+  /*!
+  ** Evaluate requests on the index, and rank the documents found with
+  ** the scorer chosen in the configuration. A quoted phrase is found
+  ** from the positions of its words, and "~N" after it allows N more
+  ** words between them, in any order. A date selects the documents
+  ** modified that day, before or after it, or between two dates.
+  */
   class Searcher
   {
     typedef std::list< ::Index::Column::DocumentResult> array;
@@ -23,7 +37,8 @@ namespace Search
     ~Searcher();
 
   public:
-    void search(const std::string& request);
+    void search(const std::string& request, const unsigned int k = 0,
+		std::ostream& err = std::cerr);
     void displayFoundDocument(std::ostream& o = std::cout) const;
 
   public:
@@ -31,10 +46,36 @@ namespace Search
     const array& getDocumentList() const;
 
   private:
-    void evaluateRequest(iter_t const& i);
+    const std::string getTerm(iter_t const& i) const;
+    bool evaluateRequest(iter_t const& i, PostingList& res);
+    void evaluatePhrase(iter_t const& i, PostingList& res);
+    unsigned int getPhraseTerms(iter_t const& i, std::vector<std::string>& terms,
+				std::vector<unsigned int>& offsets) const;
+    void loadStopWords() const;
+    bool checkDates(iter_t const& i) const;
+    void getDateRange(iter_t const& i, long long& from, long long& to) const;
+    static bool isPhrase(const std::vector<const std::vector<unsigned int>*>& positions,
+			 const std::vector<unsigned int>& offsets);
+    static bool isNear(const std::vector<const std::vector<unsigned int>*>& positions,
+		       const unsigned int span);
+    void collectTerms(iter_t const& i, std::vector<std::string>& terms) const;
+    bool collectDisjunction(iter_t const& i, std::vector<std::string>& terms) const;
+    void selectBest(iter_t const& tree, const unsigned int k);
+    void evaluate(iter_t const& tree, const unsigned int k);
+    void addDocument(const unsigned int id, const double rank);
+    void fillDocuments(const PostingList& postings);
+    void fillDocuments(const TopK& top);
 
   private:
-    array		_docFound;
+    Searcher(const Searcher& searcher);
+    Searcher& operator=(const Searcher& searcher);
+
+  private:
+    array			_docFound;
+    const Normalizer		_normalizer;
+    std::auto_ptr<Scorer>	_scorer;
+    mutable ::Index::StopWords	_stopWords;
+    mutable bool		_stopWordsLoaded;
   };
 }
 
@@ -21,47 +21,116 @@ namespace Search
   }
 
   /*!
-  ** Evaluate recursively all node of the AST, getting all needed information.
+  ** Get a term of the request, normalized like the indexed words.
+  **
+  ** @param i The iterator of the AST, on a string expression
+  **
+  ** @return The term
+  */
+  inline const std::string
+  Searcher::getTerm(iter_t const& i) const
+  {
+    std::string term;
+    _normalizer.normalize(std::string(i->value.begin(), i->value.end()), term);
+
+    return term;
+  }
+
+  /*!
+  ** Collect all terms of a request, whatever their operator, to know
+  ** which indexed documents can change its results.
   **
   ** @param i The iterator of the AST
+  ** @param terms Where to add the terms
   */
   inline void
-  Searcher::evaluateRequest(iter_t const& i)
+  Searcher::collectTerms(iter_t const& i, std::vector<std::string>& terms) const
+  {
+    if (i->value.id() == spirit::parser_id(Request::NodeId::string_exprID))
+    {
+      terms.push_back(getTerm(i));
+      return;
+    }
+
+    if (i->value.id() == spirit::parser_id(Request::NodeId::escaped_stringID))
+    {
+      std::vector<std::string> phrase;
+      std::vector<unsigned int> offsets;
+      getPhraseTerms(i, phrase, offsets);
+      terms.insert(terms.end(), phrase.begin(), phrase.end());
+      return;
+    }
+
+    for (iter_t child = i->children.begin(); child != i->children.end(); ++child)
+      collectTerms(child, terms);
+  }
+
+  /*!
+  ** Check if a request is only made of terms separated by "|", and
+  ** collect these terms.
+  **
+  ** @param i The iterator of the AST
+  ** @param terms Where to add the terms
+  **
+  ** @return If the request is a disjunction of terms
+  */
+  inline bool
+  Searcher::collectDisjunction(iter_t const& i, std::vector<std::string>& terms) const
+  {
+    if (i->value.id() == spirit::parser_id(Request::NodeId::string_exprID))
+    {
+      terms.push_back(getTerm(i));
+      return true;
+    }
+
+    if (i->value.id() == spirit::parser_id(Request::NodeId::termID) &&
+	*i->value.begin() == '|')
+      return collectDisjunction(i->children.begin(), terms) &&
+	collectDisjunction(i->children.begin() + 1, terms);
+
+    return false;
+  }
+
+  /*!
+  ** Evaluate recursively all node of the AST, getting the sorted posting
+  ** list of the matching documents. A negated result means all documents
+  ** except the ones of the list: it can only be used to filter another
+  ** list.
+  **
+  ** @param i The iterator of the AST
+  ** @param res Where to store the posting list
+  **
+  ** @return If the result is negated
+  */
+  inline bool
+  Searcher::evaluateRequest(iter_t const& i, PostingList& res)
   {
     Index::Database& db = Index::Database::getInstance();
 
     // Unary operand like "+" or "-"
     if (i->value.id() == spirit::parser_id(Request::NodeId::factorID))
     {
+      const bool negated = evaluateRequest(i->children.begin(), res);
       if (*i->value.begin() == '-')
-      {
-	
-      }
-      if (*i->value.begin() == '+')
-      {
-	
-      }
+	return !negated;
 
-      evaluateRequest(i->children.begin());
-      return;
+      return negated;
     }
 
     // Normal string expression
     if (i->value.id() == spirit::parser_id(Request::NodeId::string_exprID))
     {
-      std::string str(i->value.begin(), i->value.end());
-      _docFound = db.getCompleteDocuments(" real_term = '" + str + "'");
+      db.getPostings(getTerm(i), *_scorer, res);
 
-      return;
+      return false;
     }
 
-    // Escaped string expression with ""
+    // Escaped string expression with "", maybe followed by "~N"
     if (i->value.id() == spirit::parser_id(Request::NodeId::escaped_stringID))
     {
-      // FIXME : delete first and last char (ie the ")
-      std::string str(i->value.begin(), i->value.end());
+      evaluatePhrase(i, res);
 
-      return;
+      return false;
     }
 
     // Or operator, ie "|" symbol
@@ -69,11 +138,23 @@ namespace Search
     {
       if (*i->value.begin() == '|')
       {
-	evaluateRequest(i->children.begin());
-	array tmp = _docFound;
-	evaluateRequest(i->children.begin() + 1);
-	ArrayUtils::arrayMerge(_docFound, tmp);
-	return;
+	PostingList left;
+	PostingList right;
+	const bool leftNegated = evaluateRequest(i->children.begin(), left);
+	const bool rightNegated = evaluateRequest(i->children.begin() + 1, right);
+
+	// Negated operands can't be listed, so they don't add anything
+	if (leftNegated && rightNegated)
+	  ArrayUtils::intersect(left, right, res);
+	else
+	  if (leftNegated)
+	    ArrayUtils::swap(res, right);
+	  else
+	    if (rightNegated)
+	      ArrayUtils::swap(res, left);
+	    else
+	      ArrayUtils::unite(left, right, res);
+	return leftNegated && rightNegated;
       }
       assert(false);
     }
@@ -83,31 +164,49 @@ namespace Search
     {
       if (*i->value.begin() == '&' || *i->value.begin() == ' ')
       {
-	evaluateRequest(i->children.begin());
-	array tmp = _docFound;
-	evaluateRequest(i->children.begin() + 1);
-	ArrayUtils::arrayFilter(_docFound, tmp);
-	return;
-      }
-      assert(false);
-    }
+	PostingList left;
+	PostingList right;
+	const bool leftNegated = evaluateRequest(i->children.begin(), left);
 
-    // Handle simple date like ":date(xx/xx/xx)"
-    if (i->value.id() == spirit::parser_id(Request::NodeId::dateID))
-    {
-      std::string str(i->value.begin(), i->value.end());
+	// A term is only looked for among the documents already found
+	iter_t const last = i->children.begin() + 1;
+	if (!leftNegated &&
+	    last->value.id() == spirit::parser_id(Request::NodeId::string_exprID))
+	{
+	  db.intersectPostings(getTerm(last), *_scorer, left, res);
+	  return false;
+	}
 
-      return;
+	const bool rightNegated = evaluateRequest(last, right);
+	if (leftNegated && rightNegated)
+	  ArrayUtils::unite(left, right, res);
+	else
+	  if (leftNegated)
+	    ArrayUtils::subtract(right, left, res);
+	  else
+	    if (rightNegated)
+	      ArrayUtils::subtract(left, right, res);
+	    else
+	      ArrayUtils::intersect(left, right, res);
+	return leftNegated && rightNegated;
+      }
+      assert(false);
     }
 
-    // Handle complex date like ":date(>xx/xx/xx)" or ":date(xx/xx/xx-xx/xx/xx)"
-    if (i->value.id() == spirit::parser_id(Request::NodeId::date_exprID))
+    // Date like ":date(xx/xx/xx)", ":date(>xx/xx/xx)" or
+    // ":date(xx/xx/xx-xx/xx/xx)", listed like a term
+    if (i->value.id() == spirit::parser_id(Request::NodeId::dateID) ||
+	i->value.id() == spirit::parser_id(Request::NodeId::date_exprID))
     {
-      std::string str(i->value.begin(), i->value.end());
+      long long from;
+      long long to;
+      getDateRange(i, from, to);
+      db.getDocumentsByDate(from, to, res);
 
-      return;
+      return false;
     }
 
     assert(false);
+    return false;
   }
 }
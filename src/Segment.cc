@@ -0,0 +1,347 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <algorithm>
+#include "Segment.hh"
+
+namespace
+{
+  // Live count of a term whose postings were not walked yet
+  static const uint32_t NOT_COUNTED = ~static_cast<uint32_t>(0);
+}
+
+namespace Index
+{
+  const char Segment::MAGIC[8] = { 'M', 'D', 'R', 'S', 'E', 'G', '1', 0 };
+
+  /*!
+  ** Move an iterator to the first live posting of a list.
+  **
+  ** @param segment The segment of the postings
+  ** @param postings The beginning of the postings of the term
+  ** @param count The number of postings
+  */
+  void
+  Segment::Iterator::reset(const Segment* segment, const char* postings,
+			   const unsigned int count)
+  {
+    const PostingsHeader* header = reinterpret_cast<const PostingsHeader*>(postings);
+    _skipCount = header->skipCount;
+    _skips = reinterpret_cast<const Skip*>(postings + sizeof (PostingsHeader));
+    _scores = reinterpret_cast<const double*>(_skips + _skipCount);
+    _fieldCounts = reinterpret_cast<const uint16_t*>(_scores + count);
+    _stemCounts = reinterpret_cast<const uint32_t*>(_fieldCounts + count * Field::COUNT);
+    _positionOffsets = _stemCounts + count;
+    _ids = reinterpret_cast<const unsigned char*>(_positionOffsets + count + 1);
+    _positions = reinterpret_cast<const char*>(_ids + header->idBytes);
+    _segment = segment;
+    _count = count;
+    _index = 0;
+    _offset = 0;
+    _id = 0;
+    if (_count > 0)
+      decode();
+    skipDeleted();
+  }
+
+  /*!
+  ** Get the number of live postings of the term in the segment.
+  **
+  ** @return The number of live postings, including the ones already read
+  */
+  unsigned int
+  Segment::Iterator::getLiveCount() const
+  {
+    return _segment ? _segment->getLiveCount(_term) : _count;
+  }
+
+  /*!
+  ** Go to the first live posting whose id is not lesser than the given
+  ** one. Whole blocks of postings are jumped over with the skip entries,
+  ** then the last block is decoded.
+  **
+  ** @param target The document id to look for
+  */
+  void
+  Segment::Iterator::advance(const unsigned int target)
+  {
+    if (atEnd() || _id >= target)
+      return;
+
+    const unsigned int block = _index / SKIP_INTERVAL;
+    unsigned int to = block;
+    while (to + 1 < _skipCount && _skips[to].lastId < target)
+      to++;
+    if (to > block)
+    {
+      _index = to * SKIP_INTERVAL;
+      _offset = _skips[to].offset;
+      _id = _skips[to - 1].lastId;
+      decode();
+    }
+
+    while (!atEnd() && _id < target)
+      if (++_index < _count)
+	decode();
+    skipDeleted();
+  }
+
+  /*!
+  ** Construct a closed segment.
+  */
+  Segment::Segment()
+    : _map(0), _length(0), _header(0), _docs(0), _lengths(0), _terms(0),
+      _deletedBase(0), _deletedCount(0)
+  {
+  }
+
+  /*!
+  ** Destruct a segment, unmapping its file.
+  */
+  Segment::~Segment()
+  {
+    close();
+  }
+
+  /*!
+  ** Map a segment file. Its pages are only read when queried.
+  **
+  ** @param filename The path of the segment
+  **
+  ** @return If the file is a valid segment
+  */
+  bool
+  Segment::open(const std::string& filename)
+  {
+    close();
+
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat st;
+    void* addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof (Header)))
+      addr = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+      return false;
+
+    _filename = filename;
+    _map = static_cast<const char*>(addr);
+    _length = st.st_size;
+    _header = reinterpret_cast<const Header*>(_map);
+    if (!check())
+    {
+      close();
+      return false;
+    }
+    _docs = reinterpret_cast<const uint32_t*>(_map + sizeof (Header));
+    _lengths = _docs + _header->docCount;
+    _terms = _map + _header->dictionaryOffset +
+      _header->termCount * sizeof (DictionaryEntry);
+
+    return true;
+  }
+
+  /*!
+  ** Check that the header of the mapped file is the one of a segment,
+  ** and that its documents and dictionary are within the file.
+  **
+  ** @return If the header is valid
+  */
+  bool
+  Segment::check() const
+  {
+    if (memcmp(_header->magic, MAGIC, sizeof (MAGIC)) != 0 ||
+	_header->version != VERSION)
+      return false;
+
+    const uint64_t docsEnd = sizeof (Header) +
+      static_cast<uint64_t>(_header->docCount) * 2 * sizeof (uint32_t);
+    const uint64_t dictionaryEnd = _header->dictionaryOffset +
+      static_cast<uint64_t>(_header->termCount) * sizeof (DictionaryEntry);
+
+    return docsEnd <= _header->dictionaryOffset && dictionaryEnd <= _length &&
+      _header->dictionaryOffset % sizeof (uint64_t) == 0;
+  }
+
+  /*!
+  ** Unmap the segment.
+  */
+  void
+  Segment::close()
+  {
+    if (_map)
+      munmap(const_cast<char*>(_map), _length);
+    _filename.clear();
+    _map = 0;
+    _length = 0;
+    _header = 0;
+    _docs = 0;
+    _lengths = 0;
+    _terms = 0;
+    _deleted.clear();
+    _deletedBase = 0;
+    _deletedCount = 0;
+    _liveCounts.clear();
+  }
+
+  /*!
+  ** Get the length of a document held by the segment, by dichotomy in
+  ** its documents.
+  **
+  ** @param idDoc The document id
+  **
+  ** @return The number of terms of the document, or 0 if it's not held
+  */
+  unsigned int
+  Segment::getLength(const unsigned int idDoc) const
+  {
+    const uint32_t* end = _docs + getDocumentCount();
+    const uint32_t* i = std::lower_bound(_docs, end, idDoc);
+    if (i == end || *i != idDoc)
+      return 0;
+
+    return _lengths[i - _docs];
+  }
+
+  /*!
+  ** Delete the documents of the segment which are held by newer ones.
+  ** Only the range of the document ids of the segment is kept. The live
+  ** counts of the terms are kept if the same documents were deleted.
+  **
+  ** @param deleted The bitmap of the documents held by newer segments,
+  ** indexed by document id
+  */
+  void
+  Segment::setDeleted(const bitmap& deleted)
+  {
+    bitmap range;
+    unsigned int base = 0;
+    unsigned int deletedCount = 0;
+
+    const unsigned int count = getDocumentCount();
+    for (unsigned int i = 0; i < count; i++)
+    {
+      const unsigned int id = _docs[i];
+      if (id / 64 < deleted.size() && (deleted[id / 64] >> (id % 64)) & 1)
+	deletedCount++;
+    }
+    if (deletedCount > 0)
+    {
+      const unsigned int first = _docs[0] / 64;
+      const unsigned int last = std::min<unsigned int>(_docs[count - 1] / 64 + 1,
+						       deleted.size());
+      range.assign(deleted.begin() + first, deleted.begin() + last);
+      base = first * 64;
+    }
+
+    if (deletedCount != _deletedCount || base != _deletedBase || range != _deleted)
+      _liveCounts.clear();
+    _deleted.swap(range);
+    _deletedBase = base;
+    _deletedCount = deletedCount;
+  }
+
+  /*!
+  ** Get the number of live postings of a term of the dictionary. With
+  ** deleted documents, they are walked on first call only.
+  **
+  ** @param i The position of the term
+  **
+  ** @return The number of live postings
+  */
+  unsigned int
+  Segment::getLiveCount(const unsigned int i) const
+  {
+    const DictionaryEntry& entry = getEntry(i);
+    if (_deletedCount == 0)
+      return entry.count;
+
+    if (_liveCounts.empty())
+      _liveCounts.resize(getTermCount(), NOT_COUNTED);
+    if (_liveCounts[i] == NOT_COUNTED)
+    {
+      Iterator it;
+      get(i, it);
+      uint32_t count = 0;
+      for (; !it.atEnd(); it.next())
+	count++;
+      _liveCounts[i] = count;
+    }
+
+    return _liveCounts[i];
+  }
+
+  /*!
+  ** Set the documents of the segment in a bitmap.
+  **
+  ** @param documents The bitmap, indexed by document id, grown as needed
+  */
+  void
+  Segment::markDocuments(bitmap& documents) const
+  {
+    const unsigned int count = getDocumentCount();
+    if (count == 0)
+      return;
+
+    if (documents.size() <= _docs[count - 1] / 64)
+      documents.resize(_docs[count - 1] / 64 + 1, 0);
+    for (unsigned int i = 0; i < count; i++)
+      documents[_docs[i] / 64] |= static_cast<uint64_t>(1) << (_docs[i] % 64);
+  }
+
+  /*!
+  ** Find the postings of a term, by dichotomy in the dictionary.
+  **
+  ** @param term The term to look for
+  ** @param it Where to begin walking the live postings of the term
+  **
+  ** @return If the term is in the segment
+  */
+  bool
+  Segment::find(const std::string& term, Iterator& it) const
+  {
+    unsigned int from = 0;
+    unsigned int to = getTermCount();
+    while (from < to)
+    {
+      const unsigned int middle = from + (to - from) / 2;
+      const DictionaryEntry& entry = getEntry(middle);
+      const unsigned int length = std::min<unsigned int>(entry.termLength, term.length());
+      int cmp = memcmp(_terms + entry.termOffset, term.data(), length);
+      if (cmp == 0)
+	cmp = entry.termLength < term.length() ? -1 : entry.termLength > term.length();
+      if (cmp == 0)
+      {
+	get(middle, it);
+	return true;
+      }
+      if (cmp < 0)
+	from = middle + 1;
+      else
+	to = middle;
+    }
+    it = Iterator();
+
+    return false;
+  }
+
+  /*!
+  ** Get the postings of a term of the dictionary.
+  **
+  ** @param i The position of the term
+  ** @param it Where to begin walking the live postings of the term
+  */
+  void
+  Segment::get(const unsigned int i, Iterator& it) const
+  {
+    const DictionaryEntry& entry = getEntry(i);
+    it.reset(this, _map + entry.postingsOffset, entry.count);
+    it._term = i;
+  }
+}
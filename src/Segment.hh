@@ -0,0 +1,164 @@
+#ifndef SEGMENT_HH_
+# define SEGMENT_HH_
+
+# include <stdint.h>
+# include <cassert>
+# include <string>
+# include <vector>
+# include "Column.hh"
+
+namespace Index
+{
+  /*!
+  ** An immutable file of postings, written once by a SegmentWriter,
+  ** then mapped for reading.
+  **
+  ** The file begins with a header, then the sorted ids of the documents
+  ** it holds and their lengths, then the postings of each term, and ends
+  ** with the sorted dictionary of the terms. The postings of a term are
+  ** its document ids as deltas in variable length bytes, preceded by a
+  ** skip entry every SKIP_INTERVAL documents, and its scores, counts by
+  ** field and stem counts in separate fixed size columns. The positions
+  ** of the term in each document follow the ids, delta encoded too, and
+  ** are found by a column of offsets.
+  **
+  ** A document held by a newer segment is deleted from the older ones,
+  ** even when it has no posting anymore, as it was modified or deleted.
+  ** Each segment knows its deleted documents by a bitmap, covering the
+  ** range of its document ids. The number of live postings of a term is
+  ** counted once, then kept while the deleted documents are the same.
+  */
+  class Segment
+  {
+  public:
+    static const char		MAGIC[8];
+    static const uint32_t	VERSION = 3;
+    static const unsigned int	SKIP_INTERVAL = 128;
+
+    struct Header
+    {
+      char	magic[8];
+      uint32_t	version;
+      uint32_t	termCount;
+      uint32_t	docCount;
+      uint32_t	reserved;
+      uint64_t	dictionaryOffset;
+    };
+
+    struct DictionaryEntry
+    {
+      uint64_t	postingsOffset;
+      uint32_t	termOffset;
+      uint32_t	termLength;
+      uint32_t	count;
+      uint32_t	reserved;
+    };
+
+    struct PostingsHeader
+    {
+      uint32_t	skipCount;
+      uint32_t	idBytes;
+      uint32_t	positionBytes;
+      uint32_t	reserved;
+    };
+
+    struct Skip
+    {
+      uint32_t	lastId;
+      uint32_t	offset;
+    };
+
+    typedef std::vector<uint64_t> bitmap;
+
+    /*!
+    ** Walk the live postings of a term, by increasing document id.
+    */
+    class Iterator
+    {
+    public:
+      Iterator();
+
+    public:
+      bool atEnd() const;
+      unsigned int getLiveCount() const;
+      unsigned int getId() const;
+      double getScore() const;
+      unsigned int getFieldCount(const Field::type field) const;
+      unsigned int getStemCount() const;
+      unsigned int getLength() const;
+      const std::string getPositions() const;
+      void getWord(Column::Word& word) const;
+      void next();
+      void advance(const unsigned int target);
+
+    private:
+      friend class Segment;
+      void reset(const Segment* segment, const char* postings,
+		 const unsigned int count);
+      void decode();
+      void skipDeleted();
+
+    private:
+      const Skip*		_skips;
+      const double*		_scores;
+      const uint16_t*		_fieldCounts;
+      const uint32_t*		_stemCounts;
+      const uint32_t*		_positionOffsets;
+      const unsigned char*	_ids;
+      const char*		_positions;
+      const Segment*		_segment;
+      unsigned int		_skipCount;
+      unsigned int		_count;
+      unsigned int		_index;
+      unsigned int		_offset;
+      unsigned int		_id;
+      unsigned int		_term;
+    };
+
+  public:
+    Segment();
+    ~Segment();
+
+  public:
+    bool open(const std::string& filename);
+    void close();
+    const std::string& getFilename() const;
+    unsigned int getDocumentCount() const;
+    unsigned int getDocument(const unsigned int i) const;
+    unsigned int getDocumentLength(const unsigned int i) const;
+    unsigned int getLength(const unsigned int idDoc) const;
+    unsigned int getTermCount() const;
+    const std::string getTerm(const unsigned int i) const;
+    uint64_t getSize() const;
+    void setDeleted(const bitmap& deleted);
+    bool isDeleted(const unsigned int idDoc) const;
+    unsigned int getLiveDocumentCount() const;
+    unsigned int getLiveCount(const unsigned int i) const;
+    void markDocuments(bitmap& documents) const;
+    bool find(const std::string& term, Iterator& it) const;
+    void get(const unsigned int i, Iterator& it) const;
+
+  private:
+    Segment(const Segment& segment);
+    Segment& operator=(const Segment& segment);
+    bool check() const;
+    const DictionaryEntry& getEntry(const unsigned int i) const;
+
+  private:
+    std::string		_filename;
+    const char*		_map;
+    uint64_t		_length;
+    const Header*	_header;
+    const uint32_t*	_docs;
+    const uint32_t*	_lengths;
+    const char*		_terms;
+    bitmap		_deleted;
+    unsigned int	_deletedBase;
+    unsigned int	_deletedCount;
+    mutable std::vector<uint32_t> _liveCounts;
+  };
+}
+
+# include "Segment.hxx"
+
+#endif /* !SEGMENT_HH_ */
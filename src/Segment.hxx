@@ -0,0 +1,298 @@
+namespace Index
+{
+  /*!
+  ** Construct an iterator at the end of an empty list.
+  */
+  inline
+  Segment::Iterator::Iterator()
+    : _skips(0), _scores(0), _fieldCounts(0), _stemCounts(0), _positionOffsets(0),
+      _ids(0), _positions(0), _segment(0), _skipCount(0), _count(0), _index(0), _offset(0), _id(0),
+      _term(0)
+  {
+  }
+
+  /*!
+  ** Check if all postings were read.
+  **
+  ** @return If there is no current posting
+  */
+  inline bool
+  Segment::Iterator::atEnd() const
+  {
+    return _index >= _count;
+  }
+
+  /*!
+  ** Get the document id of the current posting.
+  **
+  ** @return The document id
+  */
+  inline unsigned int
+  Segment::Iterator::getId() const
+  {
+    assert(!atEnd());
+    return _id;
+  }
+
+  /*!
+  ** Get the score of the term in the current document.
+  **
+  ** @return The score
+  */
+  inline double
+  Segment::Iterator::getScore() const
+  {
+    assert(!atEnd());
+    return _scores[_index];
+  }
+
+  /*!
+  ** Get the number of occurences of the term in a field of the current
+  ** document. Counts are saturated to 65535.
+  **
+  ** @param field The field
+  **
+  ** @return The number of occurences
+  */
+  inline unsigned int
+  Segment::Iterator::getFieldCount(const Field::type field) const
+  {
+    assert(!atEnd());
+    return _fieldCounts[_index * Field::COUNT + field];
+  }
+
+  /*!
+  ** Get the number of words sharing the stem of the term in the current
+  ** document.
+  **
+  ** @return The stem count
+  */
+  inline unsigned int
+  Segment::Iterator::getStemCount() const
+  {
+    assert(!atEnd());
+    return _stemCounts[_index];
+  }
+
+  /*!
+  ** Get the length of the current document.
+  **
+  ** @return The number of terms of the document
+  */
+  inline unsigned int
+  Segment::Iterator::getLength() const
+  {
+    assert(!atEnd());
+    return _segment->getLength(_id);
+  }
+
+  /*!
+  ** Get the positions of the term in the current document.
+  **
+  ** @return The positions, delta encoded
+  */
+  inline const std::string
+  Segment::Iterator::getPositions() const
+  {
+    assert(!atEnd());
+    return std::string(_positions + _positionOffsets[_index],
+		       _positionOffsets[_index + 1] - _positionOffsets[_index]);
+  }
+
+  /*!
+  ** Get the word of the term in the current document. Its term id and
+  ** its weight are not kept in segments, and are left to 0.
+  **
+  ** @param word The word to fill
+  */
+  inline void
+  Segment::Iterator::getWord(Column::Word& word) const
+  {
+    assert(!atEnd());
+    word.idDocument = _id;
+    word.idTerm = 0;
+    word.weight = 0;
+    word.realCount = 0;
+    word.stemCount = _stemCounts[_index];
+    word.score = _scores[_index];
+    word.positions = getPositions();
+    for (unsigned int f = 0; f < Field::COUNT; f++)
+    {
+      word.fieldCounts[f] = _fieldCounts[_index * Field::COUNT + f];
+      word.realCount += word.fieldCounts[f];
+    }
+  }
+
+  /*!
+  ** Go to the next live posting.
+  */
+  inline void
+  Segment::Iterator::next()
+  {
+    assert(!atEnd());
+    if (++_index < _count)
+      decode();
+    skipDeleted();
+  }
+
+  /*!
+  ** Read the delta of the current posting, whose bytes begin at the
+  ** current offset: 7 bits per byte, the high bit set on all bytes but
+  ** the last one.
+  */
+  inline void
+  Segment::Iterator::decode()
+  {
+    unsigned int delta = 0;
+    unsigned int shift = 0;
+    unsigned char byte;
+    do
+    {
+      byte = _ids[_offset++];
+      delta |= (byte & 0x7F) << shift;
+      shift += 7;
+    }
+    while (byte & 0x80);
+    _id += delta;
+  }
+
+  /*!
+  ** Skip the postings of the deleted documents.
+  */
+  inline void
+  Segment::Iterator::skipDeleted()
+  {
+    while (!atEnd() && _segment->isDeleted(_id))
+      if (++_index < _count)
+	decode();
+  }
+
+  /*!
+  ** Get the number of documents held by the segment.
+  **
+  ** @return The number of documents
+  */
+  inline unsigned int
+  Segment::getDocumentCount() const
+  {
+    return _header ? _header->docCount : 0;
+  }
+
+  /*!
+  ** Get a document held by the segment. Documents are sorted by id.
+  **
+  ** @param i The position of the document
+  **
+  ** @return The document id
+  */
+  inline unsigned int
+  Segment::getDocument(const unsigned int i) const
+  {
+    assert(i < getDocumentCount());
+    return _docs[i];
+  }
+
+  /*!
+  ** Get the length of a document held by the segment.
+  **
+  ** @param i The position of the document
+  **
+  ** @return The number of terms of the document
+  */
+  inline unsigned int
+  Segment::getDocumentLength(const unsigned int i) const
+  {
+    assert(i < getDocumentCount());
+    return _lengths[i];
+  }
+
+  /*!
+  ** Get the number of terms of the dictionary.
+  **
+  ** @return The number of terms
+  */
+  inline unsigned int
+  Segment::getTermCount() const
+  {
+    return _header ? _header->termCount : 0;
+  }
+
+  /*!
+  ** Get an entry of the dictionary.
+  **
+  ** @param i The position of the term
+  **
+  ** @return The entry
+  */
+  inline const Segment::DictionaryEntry&
+  Segment::getEntry(const unsigned int i) const
+  {
+    assert(i < getTermCount());
+    return reinterpret_cast<const DictionaryEntry*>(_map + _header->dictionaryOffset)[i];
+  }
+
+  /*!
+  ** Get a term of the dictionary. Terms are sorted.
+  **
+  ** @param i The position of the term
+  **
+  ** @return The term
+  */
+  inline const std::string
+  Segment::getTerm(const unsigned int i) const
+  {
+    const DictionaryEntry& entry = getEntry(i);
+    return std::string(_terms + entry.termOffset, entry.termLength);
+  }
+
+  /*!
+  ** Get the path of the mapped file.
+  **
+  ** @return The path, empty if the segment is closed
+  */
+  inline const std::string&
+  Segment::getFilename() const
+  {
+    return _filename;
+  }
+
+  /*!
+  ** Get the size of the segment file.
+  **
+  ** @return The size in bytes
+  */
+  inline uint64_t
+  Segment::getSize() const
+  {
+    return _length;
+  }
+
+  /*!
+  ** Check if a document of the segment is deleted, ie held by a newer
+  ** segment.
+  **
+  ** @param idDoc The document id
+  **
+  ** @return If the document is deleted
+  */
+  inline bool
+  Segment::isDeleted(const unsigned int idDoc) const
+  {
+    if (_deletedCount == 0 || idDoc < _deletedBase)
+      return false;
+    const unsigned int i = idDoc - _deletedBase;
+
+    return i / 64 < _deleted.size() && (_deleted[i / 64] >> (i % 64)) & 1;
+  }
+
+  /*!
+  ** Get the number of documents of the segment which are not deleted.
+  **
+  ** @return The number of live documents
+  */
+  inline unsigned int
+  Segment::getLiveDocumentCount() const
+  {
+    return getDocumentCount() - _deletedCount;
+  }
+}
@@ -0,0 +1,401 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include "SegmentManifest.hh"
+#include "Utils.hh"
+
+namespace Index
+{
+  /*!
+  ** Construct the manifest of a segment directory, creating the
+  ** directory if needed.
+  **
+  ** @param directory The directory of the segments
+  */
+  SegmentManifest::SegmentManifest(const std::string& directory)
+    : _directory(directory), _filename(directory + "/MANIFEST"),
+      _lockFilename(directory + "/LOCK"),
+      _nextId(1), _version(0), _inode(-1), _mtime(-1)
+  {
+    if (mkdir(_directory.c_str(), 0755) != 0 && errno != EEXIST)
+      std::cerr << _directory << " : " << strerror(errno) << std::endl;
+    refresh();
+  }
+
+  /*!
+  ** Destruct a manifest.
+  */
+  SegmentManifest::~SegmentManifest()
+  {
+  }
+
+  /*!
+  ** Lock the segment directory, waiting for the other threads and
+  ** processes to release it, then read the manifest again. If the lock
+  ** file can't be opened, the manifest is still read, but not locked.
+  **
+  ** @param manifest The manifest of the directory
+  */
+  SegmentManifest::Lock::Lock(SegmentManifest& manifest)
+    : _fd(::open(manifest._lockFilename.c_str(), O_RDWR | O_CREAT, 0644))
+  {
+    if (_fd < 0)
+      std::cerr << manifest._lockFilename << " : " << strerror(errno) << std::endl;
+    else
+      while (flock(_fd, LOCK_EX) != 0 && errno == EINTR)
+	;
+    manifest.refresh();
+  }
+
+  /*!
+  ** Unlock the segment directory.
+  */
+  SegmentManifest::Lock::~Lock()
+  {
+    if (_fd >= 0)
+      ::close(_fd);
+  }
+
+  /*!
+  ** Read the manifest again if another process replaced it. A directory
+  ** without manifest lists its segments by increasing id.
+  */
+  void
+  SegmentManifest::refresh()
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    long long inode;
+    long long mtime;
+    getState(inode, mtime);
+    if (_version > 0 && inode == _inode && mtime == _mtime)
+      return;
+
+    idArray files;
+    list(files);
+    if (!read(_ids))
+      _ids = files;
+    _inode = inode;
+    _mtime = mtime;
+    _version++;
+
+    if (!files.empty())
+      _nextId = std::max(_nextId, files.back() + 1);
+    for (idArray::const_iterator i = _ids.begin(); i != _ids.end(); ++i)
+      _nextId = std::max(_nextId, *i + 1);
+  }
+
+  /*!
+  ** Get the live segments.
+  **
+  ** @param ids Where to store the segment ids, from the oldest to the newest
+  **
+  ** @return The version of the list, which changes each time it changes
+  */
+  unsigned int
+  SegmentManifest::getSegments(idArray& ids) const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    ids = _ids;
+
+    return _version;
+  }
+
+  /*!
+  ** Get the version of the list, which changes each time it changes.
+  **
+  ** @return The version
+  */
+  unsigned int
+  SegmentManifest::getVersion() const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    return _version;
+  }
+
+  /*!
+  ** Get the id of a new segment, greater than all the existing ones,
+  ** even those written by other processes. The caller holds a Lock.
+  **
+  ** @return The segment id
+  */
+  unsigned int
+  SegmentManifest::allocate()
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    idArray files;
+    list(files);
+    if (!files.empty())
+      _nextId = std::max(_nextId, files.back() + 1);
+
+    return _nextId++;
+  }
+
+  /*!
+  ** Get the path of a segment file.
+  **
+  ** @param id The segment id
+  **
+  ** @return The path
+  */
+  const std::string
+  SegmentManifest::getFilename(const unsigned int id) const
+  {
+    std::ostringstream filename;
+    filename << _directory << "/" << std::setw(8) << std::setfill('0')
+	     << id << ".seg";
+
+    return filename.str();
+  }
+
+  /*!
+  ** Add a new segment, as the newest one. The caller holds a Lock.
+  **
+  ** @param id The id of the written segment
+  **
+  ** @return If the manifest was written
+  */
+  bool
+  SegmentManifest::append(const unsigned int id)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    idArray ids = _ids;
+    ids.push_back(id);
+    if (!write(ids))
+      return false;
+
+    _ids.swap(ids);
+    _version++;
+    getState(_inode, _mtime);
+
+    return true;
+  }
+
+  /*!
+  ** Replace consecutive segments by the one they were merged in, then
+  ** remove their files. Segments appended meanwhile are kept. The caller
+  ** holds a Lock.
+  **
+  ** @param merged The merged segments, from the oldest to the newest
+  ** @param id The id of the segment written, or 0 if nothing was left
+  **
+  ** @return If the merged segments were still listed, and were replaced
+  */
+  bool
+  SegmentManifest::replace(const idArray& merged, const unsigned int id)
+  {
+    assert(!merged.empty());
+    boost::mutex::scoped_lock lock(_mutex);
+    const idArray::iterator first = std::search(_ids.begin(), _ids.end(),
+						merged.begin(), merged.end());
+    if (first == _ids.end())
+      return false;
+
+    idArray ids(_ids.begin(), first);
+    if (id != 0)
+      ids.push_back(id);
+    ids.insert(ids.end(), first + merged.size(), _ids.end());
+    if (!write(ids))
+      return false;
+
+    _ids.swap(ids);
+    _version++;
+    getState(_inode, _mtime);
+    for (idArray::const_iterator i = merged.begin(); i != merged.end(); ++i)
+      unlink(getFilename(*i).c_str());
+
+    return true;
+  }
+
+  /*!
+  ** Remove the segment files which are not listed, left by an
+  ** interrupted indexation or merge. The caller holds a Lock, so that
+  ** the segments being written are listed already.
+  **
+  ** @return The number of removed files
+  */
+  unsigned int
+  SegmentManifest::removeUnlisted()
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    idArray files;
+    list(files);
+
+    unsigned int removed = 0;
+    for (idArray::const_iterator i = files.begin(); i != files.end(); ++i)
+      if (std::find(_ids.begin(), _ids.end(), *i) == _ids.end() &&
+	  unlink(getFilename(*i).c_str()) == 0)
+	removed++;
+
+    return removed;
+  }
+
+  /*!
+  ** Map some segments, the newest first. The documents held by a segment
+  ** are deleted from all the older ones. The segments already mapped are
+  ** reused, so that they keep what they learnt about their terms.
+  **
+  ** @param ids The segment ids, from the oldest to the newest
+  ** @param segments The segments mapped before, unmapped if not given
+  ** again. Where to store the segments, from the newest to the oldest.
+  ** The caller owns them.
+  **
+  ** @return If all segments could be mapped. Else none is given.
+  */
+  bool
+  SegmentManifest::open(const idArray& ids, std::vector<Segment*>& segments) const
+  {
+    std::map<std::string, Segment*> mapped;
+    for (std::vector<Segment*>::const_iterator s = segments.begin();
+	 s != segments.end(); ++s)
+      mapped[(*s)->getFilename()] = *s;
+    segments.clear();
+
+    Segment::bitmap documents;
+    bool opened = true;
+    for (idArray::const_reverse_iterator i = ids.rbegin(); i != ids.rend(); ++i)
+    {
+      const std::string filename = getFilename(*i);
+      Segment* segment = 0;
+      const std::map<std::string, Segment*>::iterator m = mapped.find(filename);
+      if (m != mapped.end())
+      {
+	segment = m->second;
+	mapped.erase(m);
+      }
+      else
+      {
+	segment = new Segment;
+	if (!segment->open(filename))
+	{
+	  delete segment;
+	  opened = false;
+	  break;
+	}
+      }
+      segment->setDeleted(documents);
+      segment->markDocuments(documents);
+      segments.push_back(segment);
+    }
+
+    for (std::map<std::string, Segment*>::iterator m = mapped.begin();
+	 m != mapped.end(); ++m)
+      delete m->second;
+    if (!opened)
+    {
+      for (std::vector<Segment*>::iterator s = segments.begin();
+	   s != segments.end(); ++s)
+	delete *s;
+      segments.clear();
+    }
+
+    return opened;
+  }
+
+  /*!
+  ** Read the manifest file: one segment id per line, from the oldest
+  ** to the newest.
+  **
+  ** @param ids Where to store the segment ids
+  **
+  ** @return If there is a manifest
+  */
+  bool
+  SegmentManifest::read(idArray& ids) const
+  {
+    std::ifstream file(_filename.c_str());
+    if (!file)
+      return false;
+
+    ids.clear();
+    std::string line;
+    while (std::getline(file, line))
+      if (!line.empty() && line[0] != '#')
+	ids.push_back(strtoul(line.c_str(), 0, 10));
+
+    return true;
+  }
+
+  /*!
+  ** Write the manifest file, replacing the previous one at once.
+  **
+  ** @param ids The segment ids, from the oldest to the newest
+  **
+  ** @return If the manifest was written
+  */
+  bool
+  SegmentManifest::write(const idArray& ids)
+  {
+    std::ostringstream content;
+    content << "# Live segments, from the oldest to the newest" << std::endl;
+    for (idArray::const_iterator i = ids.begin(); i != ids.end(); ++i)
+      content << *i << std::endl;
+
+    if (!Utils::writeFile(_filename, content.str()))
+    {
+      std::cerr << _filename << " : " << strerror(errno) << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  /*!
+  ** Get the ids of all segment files, named after their id.
+  **
+  ** @param ids Where to store the ids, in increasing order
+  */
+  void
+  SegmentManifest::list(idArray& ids) const
+  {
+    ids.clear();
+    DIR* dir = opendir(_directory.c_str());
+    if (!dir)
+      return;
+
+    static const std::string suffix = ".seg";
+    while (const struct dirent* entry = readdir(dir))
+    {
+      const std::string name = entry->d_name;
+      if (name.length() <= suffix.length() ||
+	  name.compare(name.length() - suffix.length(), suffix.length(), suffix) != 0 ||
+	  name.find_first_not_of("0123456789") != name.length() - suffix.length())
+	continue;
+      ids.push_back(strtoul(name.c_str(), 0, 10));
+    }
+    closedir(dir);
+    std::sort(ids.begin(), ids.end());
+  }
+
+  /*!
+  ** Get what identifies the current manifest file: as it's replaced by
+  ** renaming, a new file has a new inode.
+  **
+  ** @param inode Where to store the inode, or -1 without manifest
+  ** @param mtime Where to store the modification time, or -1
+  */
+  void
+  SegmentManifest::getState(long long& inode, long long& mtime) const
+  {
+    struct stat st;
+    if (::stat(_filename.c_str(), &st) != 0)
+    {
+      inode = -1;
+      mtime = -1;
+      return;
+    }
+    inode = st.st_ino;
+    mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+  }
+}
@@ -0,0 +1,84 @@
+#ifndef SEGMENTMANIFEST_HH_
+# define SEGMENTMANIFEST_HH_
+
+# include <string>
+# include <vector>
+# include <boost/thread/mutex.hpp>
+# include "Segment.hh"
+
+namespace Index
+{
+  /*!
+  ** The list of the live segments of an index, from the oldest to the
+  ** newest, kept in the MANIFEST file of their directory. The file is
+  ** rewritten and renamed at each change, so readers always see a
+  ** complete list: a new segment or a merge appears at once. A segment
+  ** not listed is not searched, and may be removed.
+  **
+  ** The list is shared between the indexer and the merging thread, and
+  ** between processes: a change is made under a Lock of the directory.
+  */
+  class SegmentManifest
+  {
+  public:
+    typedef std::vector<unsigned int> idArray;
+
+    /*!
+    ** An exclusive lock of the segment directory, held from the
+    ** allocation of a segment id until the segment is listed, so that no
+    ** other thread or process takes the same id, writes back an older
+    ** list, or removes the segment before it's listed. The manifest is
+    ** read again once locked.
+    */
+    class Lock
+    {
+    public:
+      Lock(SegmentManifest& manifest);
+      ~Lock();
+
+    private:
+      Lock(const Lock& lock);
+      Lock& operator=(const Lock& lock);
+
+    private:
+      int			_fd;
+    };
+    friend class Lock;
+
+  public:
+    SegmentManifest(const std::string& directory);
+    ~SegmentManifest();
+
+  public:
+    void refresh();
+    unsigned int getSegments(idArray& ids) const;
+    unsigned int getVersion() const;
+    unsigned int allocate();
+    const std::string getFilename(const unsigned int id) const;
+    bool append(const unsigned int id);
+    bool replace(const idArray& merged, const unsigned int id);
+    unsigned int removeUnlisted();
+    bool open(const idArray& ids, std::vector<Segment*>& segments) const;
+
+  private:
+    SegmentManifest(const SegmentManifest& manifest);
+    SegmentManifest& operator=(const SegmentManifest& manifest);
+    bool read(idArray& ids) const;
+    bool write(const idArray& ids);
+    void list(idArray& ids) const;
+    void getState(long long& inode, long long& mtime) const;
+
+  private:
+    const std::string		_directory;
+    const std::string		_filename;
+    const std::string		_lockFilename;
+    idArray			_ids;
+    unsigned int		_nextId;
+    unsigned int		_version;
+    long long			_inode;
+    long long			_mtime;
+    mutable boost::mutex	_mutex;
+  };
+}
+
+#endif /* !SEGMENTMANIFEST_HH_ */
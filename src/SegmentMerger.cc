@@ -0,0 +1,259 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <boost/bind.hpp>
+#include "SegmentMerger.hh"
+#include "SegmentWriter.hh"
+
+namespace Index
+{
+  namespace
+  {
+    // Number of segments of a tier merged at once, and size ratio between tiers
+    static const unsigned int MERGE_FACTOR = 4;
+
+    // Size below which segments are all in the first tier, in bytes
+    static const unsigned long long TIER_SIZE = 256 * 1024;
+  }
+
+  /*!
+  ** Construct a merger. Its thread is only started once a merge is
+  ** scheduled.
+  **
+  ** @param manifest The manifest of the segments to merge
+  */
+  SegmentMerger::SegmentMerger(SegmentManifest& manifest)
+    : _manifest(manifest), _scheduled(false), _stopped(false)
+  {
+  }
+
+  /*!
+  ** Destruct a merger, stopping its thread.
+  */
+  SegmentMerger::~SegmentMerger()
+  {
+    stop();
+  }
+
+  /*!
+  ** Ask the thread to look for segments to merge, as new ones were
+  ** written.
+  */
+  void
+  SegmentMerger::schedule()
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    if (_stopped)
+      return;
+    if (!_thread.get())
+      _thread.reset(new boost::thread(boost::bind(&SegmentMerger::run, this)));
+    _scheduled = true;
+    _wake.notify_one();
+  }
+
+  /*!
+  ** Stop the thread, once the merges already due are done.
+  */
+  void
+  SegmentMerger::stop()
+  {
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      _stopped = true;
+      _wake.notify_one();
+    }
+    if (_thread.get())
+      _thread->join();
+    _thread.reset();
+  }
+
+  /*!
+  ** Merge all segments into a single one, in the calling thread. The
+  ** documents deleted or held by no segment anymore are all dropped, and
+  ** the segment files left by an interrupted run are removed.
+  **
+  ** @return The number of segments merged
+  */
+  unsigned int
+  SegmentMerger::mergeAll()
+  {
+    boost::mutex::scoped_lock lock(_merging);
+    _manifest.refresh();
+    idArray ids;
+    _manifest.getSegments(ids);
+    if (!ids.empty() && !merge(ids))
+      return 0;
+    SegmentManifest::Lock locked(_manifest);
+    _manifest.removeUnlisted();
+
+    return ids.size();
+  }
+
+  /*!
+  ** Thread: wait for merges to be scheduled, then merge until no tier
+  ** is full.
+  */
+  void
+  SegmentMerger::run()
+  {
+    for (;;)
+    {
+      bool stopped;
+      {
+	boost::mutex::scoped_lock lock(_mutex);
+	while (!_scheduled && !_stopped)
+	  _wake.wait(lock);
+	_scheduled = false;
+	stopped = _stopped;
+      }
+
+      try
+      {
+	boost::mutex::scoped_lock lock(_merging);
+	idArray merged;
+	while (select(merged) && merge(merged))
+	  ;
+      }
+      catch (const std::exception& ex)
+      {
+	std::cerr << "Can't merge segments : " << ex.what() << std::endl;
+      }
+
+      if (stopped)
+	return;
+    }
+  }
+
+  /*!
+  ** Find MERGE_FACTOR consecutive segments of the same tier, the oldest
+  ** first.
+  **
+  ** @param merged Where to store the segments to merge
+  **
+  ** @return If segments must be merged
+  */
+  bool
+  SegmentMerger::select(idArray& merged) const
+  {
+    idArray ids;
+    _manifest.getSegments(ids);
+
+    std::vector<unsigned int> tiers;
+    for (idArray::const_iterator i = ids.begin(); i != ids.end(); ++i)
+    {
+      struct stat st;
+      if (stat(_manifest.getFilename(*i).c_str(), &st) != 0)
+	return false;
+      tiers.push_back(getTier(st.st_size));
+    }
+
+    unsigned int first = 0;
+    for (unsigned int i = 0; i < tiers.size(); i++)
+    {
+      if (tiers[i] != tiers[first])
+	first = i;
+      if (i + 1 - first == MERGE_FACTOR)
+      {
+	merged.assign(ids.begin() + first, ids.begin() + i + 1);
+	return true;
+      }
+    }
+
+    return false;
+  }
+
+  /*!
+  ** Merge consecutive segments into a new one, then replace them in the
+  ** manifest. Only the live postings are kept. A document without
+  ** posting is kept too, as it's deleted from the older segments,
+  ** unless the oldest segment is merged. The directory is locked all
+  ** along, so that the merged segments are still the listed ones when
+  ** they are replaced.
+  **
+  ** @param merged The segments to merge, from the oldest to the newest
+  **
+  ** @return If the segments were merged
+  */
+  bool
+  SegmentMerger::merge(const idArray& merged)
+  {
+    SegmentManifest::Lock locked(_manifest);
+    idArray ids;
+    _manifest.getSegments(ids);
+    const idArray::iterator first = std::search(ids.begin(), ids.end(),
+						merged.begin(), merged.end());
+    if (first == ids.end())
+      return false;
+
+    // Newer segments are needed too, to know the deleted documents
+    const idArray live(first, ids.end());
+    std::vector<Segment*> segments;
+    if (!_manifest.open(live, segments))
+      return false;
+
+    // Segments are opened from the newest, so the merged ones are the last
+    SegmentWriter writer;
+    const std::vector<Segment*>::const_iterator begin = segments.end() - merged.size();
+    if (first != ids.begin())
+      for (std::vector<Segment*>::const_iterator s = begin; s != segments.end(); ++s)
+	for (unsigned int i = 0; i < (*s)->getDocumentCount(); i++)
+	  if (!(*s)->isDeleted((*s)->getDocument(i)))
+	    writer.remove((*s)->getDocument(i));
+
+    Segment::Iterator it;
+    Column::Word word;
+    for (std::vector<Segment*>::const_iterator s = begin; s != segments.end(); ++s)
+      for (unsigned int i = 0; i < (*s)->getTermCount(); i++)
+      {
+	const std::string term = (*s)->getTerm(i);
+	for ((*s)->get(i, it); !it.atEnd(); it.next())
+	{
+	  it.getWord(word);
+	  writer.add(term, word, it.getLength());
+	}
+      }
+    for (std::vector<Segment*>::iterator s = segments.begin(); s != segments.end(); ++s)
+      delete *s;
+
+    unsigned int id = 0;
+    if (!writer.empty())
+    {
+      id = _manifest.allocate();
+      if (!writer.write(_manifest.getFilename(id)))
+      {
+	std::cerr << _manifest.getFilename(id) << " : " << strerror(errno) << std::endl;
+	return false;
+      }
+    }
+    if (!_manifest.replace(merged, id))
+    {
+      if (id != 0)
+	unlink(_manifest.getFilename(id).c_str());
+      return false;
+    }
+
+    return true;
+  }
+
+  /*!
+  ** Get the tier of a segment: how many times its size can be divided
+  ** by MERGE_FACTOR before getting lower than the first tier.
+  **
+  ** @param size The size of the segment file, in bytes
+  **
+  ** @return The tier
+  */
+  unsigned int
+  SegmentMerger::getTier(unsigned long long size)
+  {
+    unsigned int tier = 0;
+    for (size /= TIER_SIZE; size > 0; size /= MERGE_FACTOR)
+      tier++;
+
+    return tier;
+  }
+}
@@ -0,0 +1,54 @@
+#ifndef SEGMENTMERGER_HH_
+# define SEGMENTMERGER_HH_
+
+# include <memory>
+# include <boost/thread/thread.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/condition.hpp>
+# include "SegmentManifest.hh"
+
+namespace Index
+{
+  /*!
+  ** Merge segments in a background thread, so that their number stays
+  ** logarithmic in the size of the index, however often new ones are
+  ** written. Segments are sorted in tiers by size, each tier being
+  ** MERGE_FACTOR times larger than the previous one, and MERGE_FACTOR
+  ** consecutive segments of the same tier are merged into one of the
+  ** next tier. Postings of deleted documents are dropped while merging.
+  ** Merged segments are replaced in the manifest at once, so searches
+  ** never see them twice nor miss them.
+  */
+  class SegmentMerger
+  {
+    typedef SegmentManifest::idArray idArray;
+
+  public:
+    SegmentMerger(SegmentManifest& manifest);
+    ~SegmentMerger();
+
+  public:
+    void schedule();
+    void stop();
+    unsigned int mergeAll();
+
+  private:
+    SegmentMerger(const SegmentMerger& merger);
+    SegmentMerger& operator=(const SegmentMerger& merger);
+    void run();
+    bool select(idArray& merged) const;
+    bool merge(const idArray& merged);
+    static unsigned int getTier(unsigned long long size);
+
+  private:
+    SegmentManifest&			_manifest;
+    std::auto_ptr<boost::thread>	_thread;
+    bool				_scheduled;
+    bool				_stopped;
+    boost::mutex			_mutex;
+    boost::mutex			_merging;
+    boost::condition			_wake;
+  };
+}
+
+#endif /* !SEGMENTMERGER_HH_ */
@@ -0,0 +1,309 @@
+#include <cstring>
+#include <algorithm>
+#include "SegmentWriter.hh"
+#include "Utils.hh"
+
+namespace Index
+{
+  /*!
+  ** Order postings by document id.
+  **
+  ** @param posting The posting to compare with
+  **
+  ** @return If this posting comes first
+  */
+  bool
+  SegmentWriter::Posting::operator<(const Posting& posting) const
+  {
+    return id < posting.id;
+  }
+
+  /*!
+  ** Construct an empty segment writer.
+  */
+  SegmentWriter::SegmentWriter()
+    : _size(0)
+  {
+  }
+
+  /*!
+  ** Destruct a segment writer, forgetting what was not written.
+  */
+  SegmentWriter::~SegmentWriter()
+  {
+  }
+
+  /*!
+  ** Add the posting of a term in a document. The document becomes held
+  ** by the segment. Counts by field are saturated to 65535.
+  **
+  ** @param term The term
+  ** @param word The word of the term in the document
+  ** @param length The length of the document
+  */
+  void
+  SegmentWriter::add(const std::string& term, const Column::Word& word,
+		     const unsigned int length)
+  {
+    Document& doc = _documents[word.idDocument];
+    doc.length = length;
+
+    Posting posting;
+    posting.id = word.idDocument;
+    posting.generation = doc.generation;
+    posting.score = word.score;
+    for (unsigned int f = 0; f < Field::COUNT; f++)
+      posting.fieldCounts[f] = std::min<unsigned int>(word.fieldCounts[f], 0xFFFF);
+    posting.stemCount = word.stemCount;
+    posting.positionOffset = _positions.length();
+    posting.positionLength = word.positions.length();
+    _positions += word.positions;
+    _terms[term].push_back(posting);
+    _size++;
+  }
+
+  /*!
+  ** Forget the postings of a document added until now. The document is
+  ** still held by the segment, so that its postings of the older segments
+  ** are dead.
+  **
+  ** @param idDoc The document id
+  */
+  void
+  SegmentWriter::remove(const unsigned int idDoc)
+  {
+    _documents[idDoc].generation++;
+  }
+
+  /*!
+  ** Check if a term was added, even if its postings were forgotten since.
+  **
+  ** @param term The term
+  **
+  ** @return If the term is buffered
+  */
+  bool
+  SegmentWriter::hasTerm(const std::string& term) const
+  {
+    return _terms.find(term) != _terms.end();
+  }
+
+  /*!
+  ** Get the documents added or removed, ie held by the segment.
+  **
+  ** @param ids Where to store the sorted document ids
+  */
+  void
+  SegmentWriter::getDocuments(std::vector<unsigned int>& ids) const
+  {
+    ids.clear();
+    ids.reserve(_documents.size());
+    for (documentMap::const_iterator i = _documents.begin(); i != _documents.end(); ++i)
+      ids.push_back(i->first);
+  }
+
+  /*!
+  ** Get the number of postings added, including the forgotten ones.
+  **
+  ** @return The number of postings
+  */
+  unsigned int
+  SegmentWriter::size() const
+  {
+    return _size;
+  }
+
+  /*!
+  ** Check if no document was added or removed.
+  **
+  ** @return If there is nothing to write
+  */
+  bool
+  SegmentWriter::empty() const
+  {
+    return _documents.empty();
+  }
+
+  /*!
+  ** Forget everything.
+  */
+  void
+  SegmentWriter::clear()
+  {
+    _terms.clear();
+    _documents.clear();
+    _positions.clear();
+    _size = 0;
+  }
+
+  /*!
+  ** Write the segment. It's written at once, so a segment file is
+  ** always complete.
+  **
+  ** @param filename The path of the segment
+  **
+  ** @return If the segment was written
+  */
+  bool
+  SegmentWriter::write(const std::string& filename) const
+  {
+    std::string out(sizeof (Segment::Header), '\0');
+
+    // Documents held by the segment, then their lengths
+    for (documentMap::const_iterator i = _documents.begin();
+	 i != _documents.end(); ++i)
+      append<uint32_t>(out, i->first);
+    for (documentMap::const_iterator i = _documents.begin();
+	 i != _documents.end(); ++i)
+      append<uint32_t>(out, i->second.length);
+    align(out);
+
+    // Postings of each term, only from the last generation of each document
+    std::vector<Segment::DictionaryEntry> dictionary;
+    std::string pool;
+    std::vector<Posting> postings;
+    for (termMap::const_iterator i = _terms.begin(); i != _terms.end(); ++i)
+    {
+      postings.clear();
+      for (std::vector<Posting>::const_iterator p = i->second.begin();
+	   p != i->second.end(); ++p)
+	if (p->generation == _documents.find(p->id)->second.generation)
+	  postings.push_back(*p);
+      if (postings.empty())
+	continue;
+
+      Segment::DictionaryEntry entry;
+      entry.postingsOffset = out.length();
+      entry.termOffset = pool.length();
+      entry.termLength = i->first.length();
+      entry.count = postings.size();
+      entry.reserved = 0;
+      dictionary.push_back(entry);
+      pool += i->first;
+      writePostings(postings, out);
+    }
+
+    // Dictionary, then the terms it points to
+    Segment::Header header;
+    memcpy(header.magic, Segment::MAGIC, sizeof (header.magic));
+    header.version = Segment::VERSION;
+    header.termCount = dictionary.size();
+    header.docCount = _documents.size();
+    header.reserved = 0;
+    header.dictionaryOffset = out.length();
+    for (std::vector<Segment::DictionaryEntry>::const_iterator i = dictionary.begin();
+	 i != dictionary.end(); ++i)
+      append(out, *i);
+    out += pool;
+    memcpy(&out[0], &header, sizeof (header));
+
+    return Utils::writeFile(filename, out);
+  }
+
+  /*!
+  ** Write the postings of a term: skip entries, scores, counts by field,
+  ** stem counts, offsets of the positions, then document ids as deltas,
+  ** then positions. The first id of each block is relative to the last
+  ** id of the previous block, which is its skip entry.
+  **
+  ** @param postings The postings of the term
+  ** @param out Where to write, aligned on 8 bytes
+  */
+  void
+  SegmentWriter::writePostings(std::vector<Posting>& postings,
+			       std::string& out) const
+  {
+    std::sort(postings.begin(), postings.end());
+
+    std::string ids;
+    std::string positions;
+    std::vector<Segment::Skip> skips;
+    unsigned int last = 0;
+    for (unsigned int i = 0; i < postings.size(); i++)
+    {
+      if (i % Segment::SKIP_INTERVAL == 0)
+      {
+	Segment::Skip skip = { 0, static_cast<uint32_t>(ids.length()) };
+	skips.push_back(skip);
+      }
+      appendVarint(ids, postings[i].id - last);
+      last = postings[i].id;
+      skips.back().lastId = last;
+      positions.append(_positions, postings[i].positionOffset,
+		       postings[i].positionLength);
+    }
+
+    Segment::PostingsHeader header;
+    header.skipCount = skips.size();
+    header.idBytes = ids.length();
+    header.positionBytes = positions.length();
+    header.reserved = 0;
+    append(out, header);
+    for (std::vector<Segment::Skip>::const_iterator i = skips.begin();
+	 i != skips.end(); ++i)
+      append(out, *i);
+    for (std::vector<Posting>::const_iterator i = postings.begin();
+	 i != postings.end(); ++i)
+      append<double>(out, i->score);
+    for (std::vector<Posting>::const_iterator i = postings.begin();
+	 i != postings.end(); ++i)
+      for (unsigned int f = 0; f < Field::COUNT; f++)
+	append<uint16_t>(out, i->fieldCounts[f]);
+    for (std::vector<Posting>::const_iterator i = postings.begin();
+	 i != postings.end(); ++i)
+      append<uint32_t>(out, i->stemCount);
+    uint32_t offset = 0;
+    for (std::vector<Posting>::const_iterator i = postings.begin();
+	 i != postings.end(); ++i)
+    {
+      append<uint32_t>(out, offset);
+      offset += i->positionLength;
+    }
+    append<uint32_t>(out, offset);
+    out += ids;
+    out += positions;
+    align(out);
+  }
+
+  /*!
+  ** Pad with zeros up to a multiple of 8 bytes.
+  **
+  ** @param out Where to write
+  */
+  void
+  SegmentWriter::align(std::string& out)
+  {
+    out.resize((out.length() + 7) & ~static_cast<std::string::size_type>(7), '\0');
+  }
+
+  /*!
+  ** Write an integer with 7 bits per byte, the high bit set on all bytes
+  ** but the last one.
+  **
+  ** @param out Where to write
+  ** @param value The integer
+  */
+  void
+  SegmentWriter::appendVarint(std::string& out, unsigned int value)
+  {
+    while (value >= 0x80)
+    {
+      out += static_cast<char>((value & 0x7F) | 0x80);
+      value >>= 7;
+    }
+    out += static_cast<char>(value);
+  }
+
+  /*!
+  ** Write a value as its bytes.
+  **
+  ** @param out Where to write
+  ** @param value The value
+  */
+  template <typename T>
+  void
+  SegmentWriter::append(std::string& out, const T& value)
+  {
+    out.append(reinterpret_cast<const char*>(&value), sizeof (T));
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef SEGMENTWRITER_HH_
+# define SEGMENTWRITER_HH_
+
+# include <map>
+# include <string>
+# include <vector>
+# include "Segment.hh"
+
+namespace Index
+{
+  /*!
+  ** Accumulate postings in memory, then write them as a new segment.
+  ** A document rewritten or deleted before the segment is written loses
+  ** its previous postings: each posting keeps the generation of its
+  ** document, and only the ones of the current generation are written.
+  ** Positions are kept apart, in a single buffer.
+  */
+  class SegmentWriter
+  {
+    struct Posting
+    {
+      unsigned int	id;
+      unsigned int	generation;
+      double		score;
+      uint16_t		fieldCounts[Field::COUNT];
+      unsigned int	stemCount;
+      unsigned int	positionOffset;
+      unsigned int	positionLength;
+
+      bool operator<(const Posting& posting) const;
+    };
+
+    struct Document
+    {
+      unsigned int	generation;
+      unsigned int	length;
+    };
+
+    typedef std::map<std::string, std::vector<Posting> > termMap;
+    typedef std::map<unsigned int, Document> documentMap;
+
+  public:
+    SegmentWriter();
+    ~SegmentWriter();
+
+  public:
+    void add(const std::string& term, const Column::Word& word,
+	     const unsigned int length);
+    void remove(const unsigned int idDoc);
+    bool hasTerm(const std::string& term) const;
+    void getDocuments(std::vector<unsigned int>& ids) const;
+    unsigned int size() const;
+    bool empty() const;
+    void clear();
+    bool write(const std::string& filename) const;
+
+  private:
+    SegmentWriter(const SegmentWriter& writer);
+    SegmentWriter& operator=(const SegmentWriter& writer);
+    void writePostings(std::vector<Posting>& postings, std::string& out) const;
+    static void align(std::string& out);
+    static void appendVarint(std::string& out, unsigned int value);
+    template <typename T>
+    static void append(std::string& out, const T& value);
+
+  private:
+    termMap		_terms;
+    documentMap		_documents;
+    std::string		_positions;
+    unsigned int	_size;
+  };
+}
+
+#endif /* !SEGMENTWRITER_HH_ */
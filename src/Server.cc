@@ -0,0 +1,338 @@
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include "Server.hh"
+#include "Searcher.hh"
+#include "ResultCache.hh"
+#include "SQLiteException.hh"
+
+namespace Search
+{
+  namespace
+  {
+    // Time between two checks of a stop request, in milliseconds
+    static const int POLL_DELAY = 500;
+
+    // Number of accepted connections waiting for a worker, per worker
+    static const unsigned int QUEUE_SIZE = 16;
+
+    // Longest request accepted, in bytes
+    static const unsigned int MAX_REQUEST = 64 * 1024;
+
+    // Set when the server is asked to stop
+    static volatile sig_atomic_t stopped = 0;
+
+    void
+    stop(int)
+    {
+      stopped = 1;
+    }
+  }
+
+  /*!
+  ** Construct a server.
+  **
+  ** @param socketName The path of the Unix socket, or the TCP port
+  ** @param jobs The number of workers
+  */
+  Server::Server(const std::string& socketName, const unsigned int jobs)
+    : _socketName(socketName), _jobs(jobs > 0 ? jobs : 1), _fd(-1),
+      _unix(false), _clients(QUEUE_SIZE * _jobs), _dataVersion(0)
+  {
+  }
+
+  /*!
+  ** Destruct a server, removing its Unix socket.
+  */
+  Server::~Server()
+  {
+    if (_fd < 0)
+      return;
+    close(_fd);
+    if (_unix)
+      unlink(_socketName.c_str());
+  }
+
+  /*!
+  ** Answer requests until SIGINT or SIGTERM is received. The requests
+  ** already received are answered before returning.
+  **
+  ** @return If the socket could be listened
+  */
+  bool
+  Server::run()
+  {
+    if (!listen())
+      return false;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof (action));
+    action.sa_handler = stop;
+    sigaction(SIGINT, &action, 0);
+    sigaction(SIGTERM, &action, 0);
+
+    _dataVersion = Index::Database::getInstance().getDataVersion();
+    boost::thread_group threads;
+    for (unsigned int i = 0; i < _jobs; i++)
+      threads.create_thread(boost::bind(&Server::serve, this));
+
+    while (!stopped)
+    {
+      struct pollfd fd = { _fd, POLLIN, 0 };
+      const int res = poll(&fd, 1, POLL_DELAY);
+      if (res < 0 && errno != EINTR)
+	break;
+      if (res <= 0)
+	continue;
+      const int client = accept(_fd, 0, 0);
+      if (client >= 0 && !_clients.push(client))
+	close(client);
+    }
+
+    _clients.close();
+    threads.join_all();
+
+    return true;
+  }
+
+  /*!
+  ** Get the address of a socket name: a port on localhost if it's a
+  ** number, else the path of a Unix socket.
+  **
+  ** @param socketName The socket name
+  ** @param address Where to store the address
+  ** @param length Where to store the length of the address
+  **
+  ** @return The family of the address, or AF_UNSPEC if the path is too long
+  */
+  int
+  Server::getAddress(const std::string& socketName,
+		     struct sockaddr_storage& address, socklen_t& length)
+  {
+    memset(&address, 0, sizeof (address));
+    if (!socketName.empty() &&
+	socketName.find_first_not_of("0123456789") == std::string::npos)
+    {
+      struct sockaddr_in& in = reinterpret_cast<struct sockaddr_in&>(address);
+      in.sin_family = AF_INET;
+      in.sin_port = htons(atoi(socketName.c_str()));
+      in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      length = sizeof (in);
+      return AF_INET;
+    }
+
+    struct sockaddr_un& un = reinterpret_cast<struct sockaddr_un&>(address);
+    if (socketName.empty() || socketName.length() >= sizeof (un.sun_path))
+      return AF_UNSPEC;
+    un.sun_family = AF_UNIX;
+    strcpy(un.sun_path, socketName.c_str());
+    length = sizeof (un);
+
+    return AF_UNIX;
+  }
+
+  /*!
+  ** Write all bytes of a buffer, without being killed if the other side
+  ** closed the connection.
+  **
+  ** @param fd The socket
+  ** @param data The bytes to write
+  **
+  ** @return If all bytes were written
+  */
+  bool
+  Server::writeAll(const int fd, const std::string& data)
+  {
+    std::string::size_type written = 0;
+    while (written < data.length())
+    {
+      const ssize_t res = send(fd, data.data() + written, data.length() - written,
+			       MSG_NOSIGNAL);
+      if (res < 0 && errno == EINTR)
+	continue;
+      if (res <= 0)
+	return false;
+      written += res;
+    }
+
+    return true;
+  }
+
+  /*!
+  ** Open the listening socket. A Unix socket left by a server which
+  ** didn't stop is replaced, unless a server still answers on it.
+  **
+  ** @return If the socket is listened
+  */
+  bool
+  Server::listen()
+  {
+    struct sockaddr_storage address;
+    socklen_t length;
+    const int family = getAddress(_socketName, address, length);
+    if (family == AF_UNSPEC)
+    {
+      std::cerr << _socketName << " : Invalid socket name" << std::endl;
+      return false;
+    }
+
+    _fd = socket(family, SOCK_STREAM, 0);
+    if (_fd < 0)
+    {
+      std::cerr << _socketName << " : " << strerror(errno) << std::endl;
+      return false;
+    }
+
+    if (family == AF_UNIX)
+    {
+      struct stat st;
+      if (stat(_socketName.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+      {
+	if (connect(_fd, reinterpret_cast<struct sockaddr*>(&address), length) == 0)
+	{
+	  std::cerr << _socketName << " : A server is already running" << std::endl;
+	  close(_fd);
+	  _fd = -1;
+	  return false;
+	}
+	close(_fd);
+	unlink(_socketName.c_str());
+	_fd = socket(family, SOCK_STREAM, 0);
+      }
+    }
+    else
+    {
+      const int reuse = 1;
+      setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof (reuse));
+    }
+
+    if (_fd < 0 ||
+	bind(_fd, reinterpret_cast<struct sockaddr*>(&address), length) != 0 ||
+	::listen(_fd, SOMAXCONN) != 0)
+    {
+      std::cerr << _socketName << " : " << strerror(errno) << std::endl;
+      if (_fd >= 0)
+	close(_fd);
+      _fd = -1;
+      return false;
+    }
+    _unix = family == AF_UNIX;
+
+    return true;
+  }
+
+  /*!
+  ** Worker thread: answer the requests of the accepted connections, one
+  ** connection at a time, until the client closes it or the server stops.
+  */
+  void
+  Server::serve()
+  {
+    Searcher searcher;
+    int fd;
+
+    while (_clients.pop(fd))
+    {
+      std::string buffer;
+      bool open = true;
+      while (open && !stopped)
+      {
+	std::string::size_type end;
+	while (open && (end = buffer.find('\n')) != std::string::npos)
+	{
+	  open = answer(fd, buffer.substr(0, end), searcher);
+	  buffer.erase(0, end + 1);
+	}
+	if (!open || buffer.length() > MAX_REQUEST)
+	  break;
+
+	struct pollfd client = { fd, POLLIN, 0 };
+	const int res = poll(&client, 1, POLL_DELAY);
+	if (res < 0 && errno != EINTR)
+	  break;
+	if (res <= 0)
+	  continue;
+	char chunk[4096];
+	const ssize_t read = recv(fd, chunk, sizeof (chunk), 0);
+	if (read < 0 && errno == EINTR)
+	  continue;
+	if (read <= 0)
+	  break;
+	buffer.append(chunk, read);
+      }
+      close(fd);
+    }
+  }
+
+  /*!
+  ** Answer a request. When another process changed the index, the
+  ** results cached in memory are only kept if their search is still
+  ** saved in database, as that process deleted the ones it invalidated.
+  **
+  ** @param fd The socket of the client
+  ** @param line The request line, without its end
+  ** @param searcher The searcher of the worker
+  **
+  ** @return If the answer was sent
+  */
+  bool
+  Server::answer(const int fd, const std::string& line, Searcher& searcher)
+  {
+    std::string request = line;
+    if (!request.empty() && request[request.length() - 1] == '\r')
+      request.erase(request.length() - 1);
+
+    std::ostringstream out;
+    std::ostringstream err;
+    const std::string::size_type space = request.find(' ');
+    if (space == 0 || space == std::string::npos ||
+	request.find_first_not_of("0123456789") != space)
+      err << "Invalid request, expected a limit and a request" << std::endl;
+    else
+    {
+      const unsigned int k = strtoul(request.c_str(), 0, 10);
+      try
+      {
+	{
+	  boost::mutex::scoped_lock lock(_version);
+	  const unsigned int version = Index::Database::getInstance().getDataVersion();
+	  if (version != _dataVersion)
+	  {
+	    // Writers delete the searches they invalidate from the database
+	    ResultCache& cache = ResultCache::getInstance();
+	    ResultCache::idSet searches;
+	    ResultCache::idSet live;
+	    cache.getSearches(searches);
+	    Index::Database::getInstance().getLiveSearches(searches, live);
+	    cache.retain(live);
+	    _dataVersion = version;
+	  }
+	}
+	searcher.search(request.substr(space + 1), k, err);
+      }
+      catch (SQLite::Exception& ex)
+      {
+	err << ex.errorMessage() << std::endl;
+      }
+      if (err.str().empty())
+	searcher.displayFoundDocument(out);
+    }
+
+    const bool failed = !err.str().empty();
+    const std::string text = failed ? err.str() : out.str();
+    std::ostringstream answer;
+    answer << (failed ? 1 : 0) << ' ' << text.length() << '\n' << text;
+
+    return writeAll(fd, answer.str());
+  }
+}
@@ -0,0 +1,59 @@
+#ifndef SERVER_HH_
+# define SERVER_HH_
+
+# include <sys/types.h>
+# include <sys/socket.h>
+# include <string>
+# include <boost/thread/mutex.hpp>
+# include "Queue.hh"
+# include "Searcher.hh"
+
+namespace Search
+{
+  /*!
+  ** Answer search requests on a socket, with the database kept open, so
+  ** that its pages, the compiled statements, the mapped segments and the
+  ** cached results stay warm between requests. The socket is a Unix
+  ** socket, or a TCP port on localhost when its name is a number.
+  **
+  ** Accepted connections are queued to a pool of workers, each with its
+  ** own searcher. A connection sends one request per line, as the
+  ** maximum number of documents wanted, a space, and the request. Each
+  ** answer is a line with a status, 0 or 1 on error, a space and the
+  ** length of the text which follows it: the documents found, or the
+  ** error.
+  **
+  ** Each worker searches with its own read-only connection, so searches
+  ** run at the same time, even while another process indexes.
+  */
+  class Server
+  {
+  public:
+    Server(const std::string& socketName, const unsigned int jobs);
+    ~Server();
+
+  public:
+    bool run();
+    static int getAddress(const std::string& socketName,
+			  struct sockaddr_storage& address, socklen_t& length);
+    static bool writeAll(const int fd, const std::string& data);
+
+  private:
+    Server(const Server& server);
+    Server& operator=(const Server& server);
+    bool listen();
+    void serve();
+    bool answer(const int fd, const std::string& line, Searcher& searcher);
+
+  private:
+    const std::string	_socketName;
+    const unsigned int	_jobs;
+    int			_fd;
+    bool		_unix;
+    Queue<int>		_clients;
+    unsigned int	_dataVersion;
+    boost::mutex	_version;
+  };
+}
+
+#endif /* !SERVER_HH_ */
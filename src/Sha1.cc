@@ -58,7 +58,7 @@ namespace Hash
   }
 
   void
-  Sha1::transform(UINT_32 *state, UINT_8 *buffer)
+  Sha1::transform(UINT_32 *state, const UINT_8 *buffer)
   {
     // Copy state[] to working vars
     UINT_32 a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
@@ -102,7 +102,7 @@ namespace Hash
 
   // Use this function to hash in binary data and strings
   void
-  Sha1::update(UINT_8 *data, UINT_32 len)
+  Sha1::update(const UINT_8 *data, UINT_32 len)
   {
     UINT_32 i, j;
 
@@ -70,7 +70,7 @@ namespace Hash
   public:
     void reset();
     // Update the hash value
-    void update(UINT_8 *data, UINT_32 len);
+    void update(const UINT_8 *data, UINT_32 len);
 #ifdef SHA1_UTILITY_FUNCTIONS
     bool hashFile(const char* szFileName);
 #endif
@@ -85,7 +85,7 @@ namespace Hash
 
   private:
     // Private SHA-1 transformation
-    void transform(UINT_32 *state, UINT_8 *buffer);
+    void transform(UINT_32 *state, const UINT_8 *buffer);
 
   private:
     // Member variables
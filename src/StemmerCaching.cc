@@ -0,0 +1,97 @@
+#include <cassert>
+#include <algorithm>
+#include "StemmerCaching.hh"
+#include "Utils.hh"
+
+namespace Stemmer
+{
+  /*!
+  ** Construct a caching stemmer. The table has at least twice as many
+  ** slots as stems, so that a lookup usually compares a single hash.
+  **
+  ** @param stemmer The stemmer to call on a miss, owned by this object
+  ** @param capacity The maximum number of stems kept
+  */
+  Caching::Caching(Generic* stemmer, const unsigned int capacity)
+    : _stemmer(stemmer), _capacity(capacity), _mask(0),
+      _size(0), _hits(0), _misses(0)
+  {
+    assert(stemmer);
+    assert(capacity > 0);
+
+    unsigned int slots = 16;
+    while (slots < 2 * capacity)
+      slots *= 2;
+    _words.resize(slots);
+    _stems.resize(slots);
+    _hashes.resize(slots, 0);
+    _mask = slots - 1;
+  }
+
+  /*!
+  ** Destruct a caching stemmer, and the stemmer it wraps.
+  */
+  Caching::~Caching()
+  {
+    delete _stemmer;
+  }
+
+  /*!
+  ** Stem the given word, asking the real stemmer only the first time.
+  **
+  ** @param word The word to stem
+  **
+  ** @return The stemmed word
+  */
+  const std::string
+  Caching::getStem(const std::string& word)
+  {
+    const unsigned int h = Utils::hash(word);
+    unsigned int i = findSlot(word, h);
+    if (_hashes[i] != 0)
+    {
+      _hits++;
+      return _stems[i];
+    }
+
+    _misses++;
+    const std::string stem = _stemmer->getStem(word);
+    if (_size == _capacity)
+    {
+      clear();
+      i = findSlot(word, h);
+    }
+    // Assignments reuse the memory of the strings previously there
+    _words[i] = word;
+    _stems[i] = stem;
+    _hashes[i] = h;
+    _size++;
+
+    return stem;
+  }
+
+  /*!
+  ** Forget all stems. Counters are kept.
+  */
+  void
+  Caching::clear()
+  {
+    std::fill(_hashes.begin(), _hashes.end(), 0);
+    _size = 0;
+  }
+
+  /*!
+  ** Display the counters.
+  **
+  ** @param o The stream where to display
+  */
+  void
+  Caching::display(std::ostream& o) const
+  {
+    const unsigned int total = _hits + _misses;
+    o << "Stem cache : " << _hits << " hits, " << _misses << " misses";
+    if (total > 0)
+      o << " (" << 100.0 * _hits / total << "% hits)";
+    o << ", " << _size << "/" << _capacity << " stems kept" << std::endl;
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef STEMMERCACHING_HH_
+# define STEMMERCACHING_HH_
+
+# include "Stemmer.hh"
+# include <iostream>
+# include <string>
+# include <vector>
+
+namespace Stemmer
+{
+  /*!
+  ** Remember the stems given by another stemmer, as the same words are
+  ** found again in every document. Stems are kept in an open addressing
+  ** hash table of bounded capacity, which is emptied when full: the
+  ** frequent words come back at once, and there is no list to maintain
+  ** on every hit as with a LRU.
+  ** Like any stemmer, it must be used by a single thread.
+  */
+  class Caching : public Generic
+  {
+  public:
+    Caching(Generic* stemmer, const unsigned int capacity);
+    virtual ~Caching();
+    virtual const std::string getStem(const std::string& word);
+
+  public:
+    unsigned int getCapacity() const;
+    unsigned int getSize() const;
+    unsigned int getHits() const;
+    unsigned int getMisses() const;
+    void clear();
+    void display(std::ostream& o = std::cout) const;
+
+  private:
+    unsigned int findSlot(const std::string& word, const unsigned int h) const;
+
+  private:
+    Generic*			_stemmer;
+    std::vector<std::string>	_words;
+    std::vector<std::string>	_stems;
+    std::vector<unsigned int>	_hashes;
+    const unsigned int		_capacity;
+    unsigned int		_mask;
+    unsigned int		_size;
+    unsigned int		_hits;
+    unsigned int		_misses;
+  };
+}
+
+# include "StemmerCaching.hxx"
+
+#endif /* !STEMMERCACHING_HH_ */
@@ -0,0 +1,64 @@
+namespace Stemmer
+{
+  /*!
+  ** Find the slot of a word, or the empty slot where it would be.
+  **
+  ** @param word The word to look for
+  ** @param h The hash of the word
+  **
+  ** @return The index of the slot
+  */
+  inline unsigned int
+  Caching::findSlot(const std::string& word, const unsigned int h) const
+  {
+    unsigned int i = h & _mask;
+    while (_hashes[i] != 0 && (_hashes[i] != h || _words[i] != word))
+      i = (i + 1) & _mask;
+
+    return i;
+  }
+
+  /*!
+  ** Get the maximum number of stems kept.
+  **
+  ** @return The capacity
+  */
+  inline unsigned int
+  Caching::getCapacity() const
+  {
+    return _capacity;
+  }
+
+  /*!
+  ** Get the number of stems kept.
+  **
+  ** @return The number of stems
+  */
+  inline unsigned int
+  Caching::getSize() const
+  {
+    return _size;
+  }
+
+  /*!
+  ** Get the number of words found in the cache.
+  **
+  ** @return The number of hits
+  */
+  inline unsigned int
+  Caching::getHits() const
+  {
+    return _hits;
+  }
+
+  /*!
+  ** Get the number of words given to the real stemmer.
+  **
+  ** @return The number of misses
+  */
+  inline unsigned int
+  Caching::getMisses() const
+  {
+    return _misses;
+  }
+}
@@ -4,13 +4,15 @@
 # include "Stemmer.hh"
 # include "StemmerFrench.hh"
 # include "StemmerFrenchQuick.hh"
+# include "StemmerCaching.hh"
 
 namespace Stemmer
 {
   class StemmerFactory
   {
   public:
-    static Generic* get(const std::string& type);
+    static Generic* get(const std::string& type,
+			const unsigned int cacheCapacity = 0);
   };
 }
 
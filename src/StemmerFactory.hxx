@@ -2,21 +2,28 @@ namespace Stemmer
 {
   /*!
   ** Instanciate correct stemmer depending on given type.
+  ** With a cache capacity, the stemmer remembers its last stems.
   **
   ** @param type The type of stemmer to instanciate
+  ** @param cacheCapacity The number of stems remembered, 0 for none
   **
   ** @return An instance of correct stemmer
   */
   inline Generic*
-  StemmerFactory::get(const std::string& type)
+  StemmerFactory::get(const std::string& type,
+		      const unsigned int cacheCapacity)
   {
+    Generic* stemmer = 0;
     if (type == "french")
-      return new Stemmer::French();
+      stemmer = new Stemmer::French();
+    else
+      if (type == "frenchquick")
+	stemmer = new Stemmer::FrenchQuick();
 
-    if (type == "frenchquick")
-      return new Stemmer::FrenchQuick();
+    assert(stemmer);
+    if (cacheCapacity > 0)
+      return new Stemmer::Caching(stemmer, cacheCapacity);
 
-    assert(false);
-    return 0;
+    return stemmer;
   }
 }
@@ -1,8 +1,17 @@
+#include <vector>
 #include "StemmerFrench.hh"
-#include "Utils.hh"
 
 namespace Stemmer
 {
+  namespace
+  {
+    // Longest word stemmed without allocation
+    static const unsigned int BUFFER_SIZE = 64;
+
+    // Letters a replacement can add to a word, ie "ic" replaced by "iqU"
+    static const unsigned int MAX_GROWTH = 4;
+  }
+
   /*!
   ** Construct a french stemmer.
   */
@@ -19,6 +28,7 @@ namespace Stemmer
 
   /*!
   ** Stem the given word, using french language.
+  ** Words longer than BUFFER_SIZE are copied in the heap.
   **
   ** @param word The word to stem
   **
@@ -27,41 +37,121 @@ namespace Stemmer
   const std::string
   French::getStem(const std::string& word)
   {
-    reset();
-    std::wstring _original = Utils::my_widen(boost::to_lower_copy(word));
-    _stem = _original;
-    applyConsonance();
-    /* FIXME : delete this debug line*/std::wstring accent = _stem;
-    computeRV();
-    computeR1();
-    computeR2();
-
-    bool altered = step1StandardSuffixRemoval();
+    wchar_t wordBuffer[BUFFER_SIZE];
+    wchar_t stemBuffer[BUFFER_SIZE + MAX_GROWTH];
+    std::vector<wchar_t> heap;
+    Context c;
+
+    if (word.size() <= BUFFER_SIZE)
+    {
+      c.word = wordBuffer;
+      c.stem = stemBuffer;
+    }
+    else
+    {
+      heap.resize(2 * word.size() + MAX_GROWTH);
+      c.word = &heap[0];
+      c.stem = &heap[word.size()];
+    }
+
+    wchar_t* w = const_cast<wchar_t*>(c.word);
+    c.length = decode(word, w);
+    if (c.length == 0)
+      return "";
+    applyConsonance(w, c.length);
+    for (uint i = 0; i < c.length; i++)
+      c.stem[i] = c.word[i];
+    c.stemLength = c.length;
+    computeRV(c);
+    computeR1(c);
+    computeR2(c);
+
+    bool altered = step1StandardSuffixRemoval(c);
     // FIXME : check this
     if (!altered)
     {
-      altered = step2aDeleteVerbSuffixesBeginningWithI();
+      altered = step2aDeleteVerbSuffixesBeginningWithI(c);
       if (!altered)
-	altered = step2bDeleteOtherVerbSuffixes();
+	altered = step2bDeleteOtherVerbSuffixes(c);
     }
     if (altered)
-      altered = step3ReplaceResidualLetters();
+      altered = step3ReplaceResidualLetters(c);
     if (!altered)
-      step4ReplaceResidualSuffixes();
+      step4ReplaceResidualSuffixes(c);
+
+    step5UnDouble(c);
+    step6UnAccent(c);
+
+    std::string res;
+    encode(c.stem, c.stemLength, res);
+    return res;
+  }
 
-    step5UnDouble();
-    step6UnAccent();
-    boost::to_lower(_stem);
+  /*!
+  ** Decode a lowercased UTF-8 word, one letter per wchar_t.
+  ** Accented french letters are decoded, other two bytes letters
+  ** starting with 0xC3 are dropped, and other bytes are kept as is.
+  **
+  ** @param word The word to decode
+  ** @param buffer Where to decode, at least as long as the word
+  **
+  ** @return The number of letters
+  */
+  French::uint
+  French::decode(const std::string& word, wchar_t* buffer)
+  {
+    const uint length = word.size();
+    uint res = 0;
+    for (uint i = 0; i < length; i++)
+    {
+      char c = word[i];
+      if (c >= 'A' && c <= 'Z')
+	c += 'a' - 'A';
 
-//     std::cout << "Original is : " << Utils::my_narrow(_original) << std::endl;
-//     std::cout << "Accent   is : " << Utils::my_narrow(accent) << std::endl;
-//     std::cout << "Stem     is : " << Utils::my_narrow(_stem) << std::endl;
-//     std::cout << "RV       is : " << Utils::my_narrow(_rv) << std::endl;
-//     std::cout << "R1       is : " << Utils::my_narrow(_r1) << std::endl;
-//     std::cout << "R2       is : " << Utils::my_narrow(_r2) << std::endl;
-//     std::cout << std::endl;
+      if (i + 1 < length && c == '\xC3')
+      {
+	switch (static_cast<unsigned char>(word[++i]))
+	{
+	  case 0xA2: case 0xA0: case 0xA7: case 0xAB: case 0xA9: case 0xAA:
+	  case 0xA8: case 0xAF: case 0xAE: case 0xB4: case 0xBB: case 0xB9:
+	    buffer[res++] = static_cast<unsigned char>(word[i]) + 0x40;
+	    break;
+	  default:
+	    break;
+	}
+      }
+      else
+	buffer[res++] = static_cast<wchar_t>(c);
+    }
 
-    return Utils::my_narrow(_stem);
+    return res;
+  }
+
+  /*!
+  ** Encode a stem in lowercase UTF-8.
+  **
+  ** @param stem The stem
+  ** @param length The number of letters
+  ** @param res Where to encode
+  */
+  void
+  French::encode(const wchar_t* stem, const uint length, std::string& res)
+  {
+    res.reserve(2 * length);
+    for (uint i = 0; i < length; i++)
+    {
+      const wchar_t c = stem[i];
+      if (c >= L'A' && c <= L'Z')
+	res += static_cast<char>(c - L'A' + L'a');
+      else
+	if (c >= 0xC0 && c <= 0xFF)
+	{
+	  res += '\xC3';
+	  res += static_cast<char>(c - 0x40);
+	}
+	else
+	  res += static_cast<char>(c);
+    }
   }
 
   /*!
@@ -75,30 +165,32 @@ namespace Stemmer
   **    yeux 	-> Yeux
   **    quand 	-> qUand
   **
-  ** @return If a modification occured
+  ** @param word The word
+  ** @param length The length of the word
   */
   void
-  French::applyConsonance()
+  French::applyConsonance(wchar_t* word, const uint length)
   {
-    const uint length = _stem.length();
     for (uint i = 0; i < length; i++)
     {
-      switch (_stem[i])
+      const bool before = i > 0 && isVowel(word[i - 1]);
+      const bool after = i + 1 < length && isVowel(word[i + 1]);
+      switch (word[i])
       {
-	case 'u':
-	  if (i > 0 && _stem[i - 1] == 'q')
+	case L'u':
+	  if (i > 0 && word[i - 1] == L'q')
 	  {
-	    _stem[i] = 'U';
+	    word[i] = L'U';
 	    break;
 	  }
 	  /* No break here */
-	case 'i':
-	  if (i > 0 && i < length && isVowel(_stem[i - 1]) && isVowel(_stem[i + 1]))
-	    _stem[i] = std::toupper(_stem[i]);
+	case L'i':
+	  if (before && after)
+	    word[i] = word[i] == L'u' ? L'U' : L'I';
 	  break;
-	case 'y':
-	  if ((i > 0 && isVowel(_stem[i - 1])) || (i < length && isVowel(_stem[i + 1])))
-	    _stem[i] = 'Y';
+	case L'y':
+	  if (before || after)
+	    word[i] = L'Y';
 	  break;
 	default:
 	  /* We don't care of other character, so we do nothing */
@@ -109,24 +201,31 @@ namespace Stemmer
 
   /*!
   ** Delete suffixes, when it's necessary
+  **
+  ** @param c The word being stemmed
+  **
+  ** @return If a suffix was found
   */
   bool
-  French::step1StandardSuffixRemoval()
+  French::step1StandardSuffixRemoval(Context& c)
   {
-    bool res = isSuffixe(L"amment") || isSuffixe(L"emment") ||
-      isSuffixe(L"ments") || isSuffixe(L"ment");
+    bool res = isSuffixe(c, L"amment") || isSuffixe(c, L"emment") ||
+      isSuffixe(c, L"ments") || isSuffixe(c, L"ment");
+
+    // Suffixes are checked before regions: both tests have no side
+    // effect, and most words are rejected by the last letter.
 
     // Just delete if in R2
     {
-      static const std::wstring tab1[] = {L"ances", L"ance",
-					  L"ismes", L"isme",
-					  L"ables", L"able",
-					  L"iqUes", L"iqUe",
-					  L"istes", L"iste",
-					  L"eux",
-					  L""};
-      for (uint i = 0; tab1[i] != L""; i++)
-	if (deleteIfInR2(tab1[i]))
+      static const Suffix tab1[] = {{L"ances", 5}, {L"ance", 4},
+				    {L"ismes", 5}, {L"isme", 4},
+				    {L"ables", 5}, {L"able", 4},
+				    {L"iqUes", 5}, {L"iqUe", 4},
+				    {L"istes", 5}, {L"iste", 4},
+				    {L"eux", 3},
+				    {0, 0}};
+      for (uint i = 0; tab1[i].str; i++)
+	if (isSuffixe(c, tab1[i]) && deleteIfInR2(c, tab1[i].str))
 	  return true;
     }
 
@@ -134,19 +233,22 @@ namespace Stemmer
     // If preceded by ic, try to delete if in R2.
     // If we can't delete, else replace by iqU.
     {
-      static const std::wstring tab2[] = {L"atrices", L"atrice",
-					  L"ateurs", L"ateur",
-					  L"ations", L"ation",
-					  L""};
-      for (uint i = 0; tab2[i] != L""; i++)
-	if (deleteIfInR2(tab2[i]))
+      static const Suffix tab2[] = {{L"atrices", 7}, {L"atrice", 6},
+				    {L"ateurs", 6}, {L"ateur", 5},
+				    {L"ations", 6}, {L"ation", 5},
+				    {0, 0}};
+      for (uint i = 0; tab2[i].str; i++)
+	if (isSuffixe(c, tab2[i]) && deleteIfInR2(c, tab2[i].str))
 	{
-	  uint length = _stem.length();
-	  if (length > 2 && _stem[length - 2] == L'i' && _stem[length - 1] == L'c')
+	  const uint length = c.stemLength;
+	  if (length > 2 && c.stem[length - 2] == L'i' && c.stem[length - 1] == L'c')
 	  {
-	    _stem = _stem.substr(0, length - 2);
-	    if (!isInR2(std::wstring(L"ic") + tab2[i]))
-	      _stem += L"iqU";
+	    c.stemLength -= 2;
+	    wchar_t ic[16] = L"ic";
+	    for (uint j = 0; j < tab2[i].length; j++)
+	      ic[j + 2] = tab2[i].str[j];
+	    if (!isInR2(c, ic))
+	      replaceSuffixWith(c, L"", L"iqU");
 	  }
 	  return true;
 	}
@@ -154,34 +256,42 @@ namespace Stemmer
 
     // Replace with log if in R2
     {
-      static const std::wstring tab3[] = {L"logies", L"logie", L""};
-      for (uint i = 0; tab3[i] != L""; i++)
+      static const Suffix tab3[] = {{L"logies", 6}, {L"logie", 5}, {0, 0}};
+      for (uint i = 0; tab3[i].str; i++)
 	// FIXME : check if isInRv or isInR2 (doc indcates R2, but I found RV better)
-	if (isInRV(tab3[i]) && replaceSuffixWith(tab3[i], L"log"))
+	if (isSuffixe(c, tab3[i]) && isInRV(c, tab3[i].str) &&
+	    replaceSuffixWith(c, tab3[i].str, L"log"))
 	  return true;
     }
 
     // Replace with u if in R2
     {
-      static const std::wstring tab4[] = {L"usions", L"usion", L"utions", L"ution", L""};
-      for (uint i = 0; tab4[i] != L""; i++)
-	if (isInR2(tab4[i]) && replaceSuffixWith(tab4[i], L"u"))
+      static const Suffix tab4[] = {{L"usions", 6}, {L"usion", 5},
+				    {L"utions", 6}, {L"ution", 5},
+				    {0, 0}};
+      for (uint i = 0; tab4[i].str; i++)
+	if (isSuffixe(c, tab4[i]) && isInR2(c, tab4[i].str) &&
+	    replaceSuffixWith(c, tab4[i].str, L"u"))
 	  return true;
     }
 
     // Replace with ent if in R2
     {
-      static const std::wstring tab5[] = {L"ences", L"ence", L""};
-      for (uint i = 0; tab5[i] != L""; i++)
-	if (isInR2(tab5[i]) && replaceSuffixWith(tab5[i], L"ent"))
+      static const Suffix tab5[] = {{L"ences", 5}, {L"ence", 4}, {0, 0}};
+      for (uint i = 0; tab5[i].str; i++)
+	if (isSuffixe(c, tab5[i]) && isInR2(c, tab5[i].str) &&
+	    replaceSuffixWith(c, tab5[i].str, L"ent"))
 	  return true;
     }
 
     // Delete if in R1 and preceded by a non-vowel
     {
-      static const std::wstring tab10[] = {L"issements", L"issement", L""};
-      for (uint i = 0; tab10[i] != L""; i++)
-	if (!isVowel(_stem[_stem.length() - 1 - tab10[i].length()]) && deleteIfInR1(tab10[i]))
+      static const Suffix tab10[] = {{L"issements", 9}, {L"issement", 8},
+				     {0, 0}};
+      for (uint i = 0; tab10[i].str; i++)
+	if (isSuffixe(c, tab10[i]) && c.stemLength > tab10[i].length &&
+	    !isVowel(c.stem[c.stemLength - 1 - tab10[i].length]) &&
+	    deleteIfInR1(c, tab10[i].str))
 	  return true;
     }
 
@@ -192,30 +302,33 @@ namespace Stemmer
     // If preceded by abl or iqU, delete if in R2, otherwise,
     // If preceded by ièr or Ièr, replace by i if in RV
     {
-      static const std::wstring tab6[] = {L"ements", L"ement", L""};
-      for (uint i = 0; tab6[i] != L""; i++)
+      static const Suffix tab6[] = {{L"ements", 6}, {L"ement", 5}, {0, 0}};
+      for (uint i = 0; tab6[i].str; i++)
       {
-	deleteIfInRV(tab6[i]);
-	if ((isSuffixe(L"ativ") && deleteIfInR2(L"ativ")) ||
-	    (isSuffixe(L"iv") && deleteIfInR2(L"iv")))
+	if (isSuffixe(c, tab6[i]))
+	  deleteIfInRV(c, tab6[i].str);
+	if ((isSuffixe(c, L"ativ") && deleteIfInR2(c, L"ativ")) ||
+	    (isSuffixe(c, L"iv") && deleteIfInR2(c, L"iv")))
 	  return true;
 
-	if ((isSuffixe(L"eus")))
+	if (isSuffixe(c, L"eus"))
 	{
-	  if (deleteIfInR2(L"eus"))
+	  if (deleteIfInR2(c, L"eus"))
 	    return true;
 
-	  if (isInR1(L"eus") && replaceSuffixWith(L"eus", L"eux"))
+	  if (isInR1(c, L"eus") && replaceSuffixWith(c, L"eus", L"eux"))
 	    return true;
 	}
-	if ((isSuffixe(L"abl") && deleteIfInR2(L"abl")) ||
-	    (isSuffixe(L"iqU") && deleteIfInR2(L"iqU")))
+	if ((isSuffixe(c, L"abl") && deleteIfInR2(c, L"abl")) ||
+	    (isSuffixe(c, L"iqU") && deleteIfInR2(c, L"iqU")))
 	  return true;
 
-	if (isInRV(L"ièr") && replaceSuffixWith(L"ièr", L"i"))
+	if (isSuffixe(c, L"ièr") && isInRV(c, L"ièr") &&
+	    replaceSuffixWith(c, L"ièr", L"i"))
 	  return true;
 
-	if (isInRV(L"Ièr") && replaceSuffixWith(L"Ièr", L"i"))
+	if (isSuffixe(c, L"Ièr") && isInRV(c, L"Ièr") &&
+	    replaceSuffixWith(c, L"Ièr", L"i"))
 	  return true;
       }
     }
@@ -225,25 +338,25 @@ namespace Stemmer
     // If preceded by ic, delete if in R2, else replace by iqU, otherwise,
     // If preceded by iv, delete if in R2
     {
-      static const std::wstring tab7[] = {L"ités", L"ité", L""};
-      for (uint i = 0; tab7[i] != L""; i++)
+      static const Suffix tab7[] = {{L"ités", 4}, {L"ité", 3}, {0, 0}};
+      for (uint i = 0; tab7[i].str; i++)
       {
-	bool res = deleteIfInR2(tab7[i]);
-	if (isSuffixe(L"abil"))
+	bool res = isSuffixe(c, tab7[i]) && deleteIfInR2(c, tab7[i].str);
+	if (isSuffixe(c, L"abil"))
 	{
-	  if (deleteIfInR2(L"abil"))
+	  if (deleteIfInR2(c, L"abil"))
 	    return true;
-	  if (replaceSuffixWith(L"abil", L"abl"))
+	  if (replaceSuffixWith(c, L"abil", L"abl"))
 	    return true;
 	}
-	if (isSuffixe(L"ic"))
+	if (isSuffixe(c, L"ic"))
 	{
-	  if (deleteIfInR2(L"ic"))
+	  if (deleteIfInR2(c, L"ic"))
 	    return true;
-	  if (replaceSuffixWith(L"ic", L"iqU"))
+	  if (replaceSuffixWith(c, L"ic", L"iqU"))
 	    return true;
 	}
-	if (isSuffixe(L"iv") && deleteIfInR2(L"iv"))
+	if (isSuffixe(c, L"iv") && deleteIfInR2(c, L"iv"))
 	  return true;
 	if (res)
 	  return true;
@@ -254,18 +367,21 @@ namespace Stemmer
     // If preceded by at, delete if in R2 (and if further preceded by ic,
     // delete if in R2, else replace by iqU)
     {
-      static const std::wstring tab8[] = {L"ives", L"ifs", L"ive", L"if", L""};
-      for (uint i = 0; tab8[i] != L""; i++)
+      static const Suffix tab8[] = {{L"ives", 4}, {L"ifs", 3},
+				    {L"ive", 3}, {L"if", 2},
+				    {0, 0}};
+      for (uint i = 0; tab8[i].str; i++)
       {
-	deleteIfInR2(tab8[i]);
-	if (isSuffixe(L"at"))
+	if (isSuffixe(c, tab8[i]))
+	  deleteIfInR2(c, tab8[i].str);
+	if (isSuffixe(c, L"at"))
 	{
-	  deleteIfInR2(L"at");
-	  if (isSuffixe(L"ic"))
+	  deleteIfInR2(c, L"at");
+	  if (isSuffixe(c, L"ic"))
 	  {
-	    if (deleteIfInR2(L"ic"))
+	    if (deleteIfInR2(c, L"ic"))
 	      return true;
-	    replaceSuffixWith(L"ic", L"iqU");
+	    replaceSuffixWith(c, L"ic", L"iqU");
 	  }
 	  return true;
 	}
@@ -274,27 +390,27 @@ namespace Stemmer
 
     // Replace with eau
     {
-      if (isSuffixe(L"eaux"))
-	return replaceSuffixWith(L"eaux", L"eau");
+      if (isSuffixe(c, L"eaux"))
+	return replaceSuffixWith(c, L"eaux", L"eau");
     }
 
     // Replace with al if in R1
     {
-      if (isSuffixe(L"aux"))
-	if (isInR1(L"aux") && replaceSuffixWith(L"aux", L"al"))
+      if (isSuffixe(c, L"aux"))
+	if (isInR1(c, L"aux") && replaceSuffixWith(c, L"aux", L"al"))
 	  return true;
     }
 
     // Delete if in R2, else replace by eux if in R1
     {
-      static const std::wstring tab9[] = {L"euses", L"euse", L""};
-      for (uint i = 0; tab9[i] != L""; i++)
+      static const Suffix tab9[] = {{L"euses", 5}, {L"euse", 4}, {0, 0}};
+      for (uint i = 0; tab9[i].str; i++)
       {
-	if (deleteIfInR2(tab9[i]))
+	if (isSuffixe(c, tab9[i]) && deleteIfInR2(c, tab9[i].str))
 	  return true;
-	if (isInR1(tab9[i]))
+	if (isInR1(c, tab9[i].str))
 	{
-	  replaceSuffixWith(tab9[i], L"eux");
+	  replaceSuffixWith(c, tab9[i].str, L"eux");
 	  return true;
 	}
       }
@@ -303,32 +419,34 @@ namespace Stemmer
     // Replace with ant if in RV
     {
       // FIXME : this
-      if (/*isInRV(L"amment")*/ _rv == L"amment" && replaceSuffixWith(L"amment", L"ant"))
+      if (/*isInRV(c, L"amment")*/ isRV(c, L"amment") && replaceSuffixWith(c, L"amment", L"ant"))
 	return true;
-      if (isInRV(L"amment") && replaceSuffixWith(L"amment", L""))
+      if (isSuffixe(c, L"amment") && isInRV(c, L"amment") &&
+	  replaceSuffixWith(c, L"amment", L""))
 	return true;
     }
 
     // Replace with ent if in RV
     {
-      if (isInRV(L"emment") && replaceSuffixWith(L"emment", L"ent"))
+      if (isSuffixe(c, L"emment") && isInRV(c, L"emment") &&
+	  replaceSuffixWith(c, L"emment", L"ent"))
 	return true;
     }
 
     // Delete if preceded by a vowel in RV
     // FIXME : I don't understand everything, so check this
     {
-      static const std::wstring tab11[] = {L"ments", L"ment", L""};
-      for (uint i = 0; tab11[i] != L""; i++)
+      static const Suffix tab11[] = {{L"ments", 5}, {L"ment", 4}, {0, 0}};
+      for (uint i = 0; tab11[i].str; i++)
       {
-	if (_rv.length() - 1 >= tab11[i].length())
+	const uint len = tab11[i].length;
+	const uint rvLength = c.length - c.rv;
+	if (rvLength > len && isSuffixeInRV(c, tab11[i].str) &&
+	    isVowel(c.word[c.rv + rvLength - 1 - len]))
 	{
-	  int pos = _rv.length() - 1 - tab11[i].length();
-	  if (isSuffixeInRV(tab11[i]) && isVowel(_rv[pos]))
-	  {
-	    _stem = _stem.substr(0, getSuffixPos(tab11[i]));
-	    return true;
-	  }
+	  if (isSuffixe(c, tab11[i]))
+	    c.stemLength -= len;
+	  return true;
 	}
       }
     }
@@ -342,30 +460,29 @@ namespace Stemmer
   ** Search for the longest among the following suffixes and if found,
   ** delete if preceded by a non-vowel.
   **
+  ** @param c The word being stemmed
+  **
   ** @return If at least one suffix has been removed
   */
   bool
-  French::step2aDeleteVerbSuffixesBeginningWithI()
+  French::step2aDeleteVerbSuffixesBeginningWithI(Context& c)
   {
-    static const std::wstring tab[] = {
-      L"issaIent", L"issantes",
-      L"issions", L"issante", L"issants", L"iraIent",
-      L"issons", L"irions", L"issiez", L"issant", L"issent", L"issais", L"issait",
-      L"irais", L"isses", L"issez", L"irent", L"irons", L"iront", L"iriez", L"irait",
-      L"isse", L"îmes", L"îtes", L"irai", L"iras", L"irez",
-      L"ies", L"ira",
-      L"it", L"is", L"ie", L"ir", L"ît",
-      L"i",
-      L""};
-    for (uint i = 0; tab[i] != L""; i++)
-    {
-      if (_rv.length() - 1 >= tab[i].length())
-      {
-	uint pos = _rv.length() - 1 - tab[i].length();
-	if (!isVowel(_rv[pos]) && deleteIfInRV(tab[i]))
-	  return true;
-      }
-    }
+    static const Suffix tab[] = {
+      {L"issaIent", 8}, {L"issantes", 8},
+      {L"issions", 7}, {L"issante", 7}, {L"issants", 7}, {L"iraIent", 7},
+      {L"issons", 6}, {L"irions", 6}, {L"issiez", 6}, {L"issant", 6}, {L"issent", 6}, {L"issais", 6}, {L"issait", 6},
+      {L"irais", 5}, {L"isses", 5}, {L"issez", 5}, {L"irent", 5}, {L"irons", 5}, {L"iront", 5}, {L"iriez", 5}, {L"irait", 5},
+      {L"isse", 4}, {L"îmes", 4}, {L"îtes", 4}, {L"irai", 4}, {L"iras", 4}, {L"irez", 4},
+      {L"ies", 3}, {L"ira", 3},
+      {L"it", 2}, {L"is", 2}, {L"ie", 2}, {L"ir", 2}, {L"ît", 2},
+      {L"i", 1},
+      {0, 0}};
+    const uint rvLength = c.length - c.rv;
+    for (uint i = 0; tab[i].str; i++)
+      if (isSuffixe(c, tab[i]) && rvLength > tab[i].length &&
+	  !isVowel(c.word[c.rv + rvLength - 1 - tab[i].length]) &&
+	  deleteIfInRV(c, tab[i].str))
+	return true;
 
     // Arrived here, we assume that no modification has affected the stem
     return false;
@@ -375,58 +492,54 @@ namespace Stemmer
   ** Search for the longest among the following suffixes,
   ** and perform different actions.
   **
+  ** @param c The word being stemmed
+  **
   ** @return If at least one suffix has been removed
   */
   bool
-  French::step2bDeleteOtherVerbSuffixes()
+  French::step2bDeleteOtherVerbSuffixes(Context& c)
   {
     // Delete ions if in R2
-    if (deleteIfInR2(L"ions"))
+    if (deleteIfInR2(c, L"ions"))
       return true;
 
     // Delete if in RV
     {
-      static const std::wstring tab[] = {
-	L"eraIent",
-	L"erions",
-	L"erais", L"erait", L"eriez", L"erons", L"eront", L"èrent",
-	L"eras", L"erai", L"erez",
-	L"iez", L"ées", L"era",
-	L"és", L"ez", L"ée", L"er",
-	L"é",
-	L""};
-
-      for (uint i = 0; tab[i] != L""; i++)
-	if (isSuffixe(tab[i]) && deleteIfInRV(tab[i]))
+      static const Suffix tab[] = {
+	{L"eraIent", 7},
+	{L"erions", 6},
+	{L"erais", 5}, {L"erait", 5}, {L"eriez", 5}, {L"erons", 5}, {L"eront", 5}, {L"èrent", 5},
+	{L"eras", 4}, {L"erai", 4}, {L"erez", 4},
+	{L"iez", 3}, {L"ées", 3}, {L"era", 3},
+	{L"és", 2}, {L"ez", 2}, {L"ée", 2}, {L"er", 2},
+	{L"é", 1},
+	{0, 0}};
+
+      for (uint i = 0; tab[i].str; i++)
+	if (isSuffixe(c, tab[i]) && deleteIfInRV(c, tab[i].str))
 	  return true;
     }
 
     // Delete if in RV
     // If an e precede, and e his in RV, delete it too
     {
-      static const std::wstring tab[] = {
-	L"assions",
-	L"assent", L"assiez",
-	L"antes", L"asses", L"aIent",
-	L"âtes", L"ante", L"ants", L"asse", L"âmes",
-	L"ais", L"ait", L"ant",
-	L"ât", L"as", L"ai",
-	L"a",
-	L""};
-      for (uint i = 0; tab[i] != L""; i++)
+      static const Suffix tab[] = {
+	{L"assions", 7},
+	{L"assent", 6}, {L"assiez", 6},
+	{L"antes", 5}, {L"asses", 5}, {L"aIent", 5},
+	{L"âtes", 4}, {L"ante", 4}, {L"ants", 4}, {L"asse", 4}, {L"âmes", 4},
+	{L"ais", 3}, {L"ait", 3}, {L"ant", 3},
+	{L"ât", 2}, {L"as", 2}, {L"ai", 2},
+	{L"a", 1},
+	{0, 0}};
+      const uint rvLength = c.length - c.rv;
+      for (uint i = 0; tab[i].str; i++)
       {
-	bool res = isSuffixe(tab[i]) && deleteIfInRV(tab[i]);
-	if (res)
+	if (isSuffixe(c, tab[i]) && deleteIfInRV(c, tab[i].str))
 	{
-	  if (_rv.length() - 1 >= tab[i].length())
-	  {
-	    uint pos = _rv.length() - 1 - tab[i].length();
-	    if ((_rv[pos] == L'e'))
-	    {
-	      _stem = _stem.substr(0, _stem.length() - 1);
-	      res = true;
-	    }
-	  }
+	  const uint len = tab[i].length;
+	  if (rvLength > len && c.word[c.rv + rvLength - 1 - len] == L'e')
+	    c.stemLength--;
 	  return true;
 	}
       }
@@ -439,22 +552,26 @@ namespace Stemmer
   /*!
   ** Replace final Y with i or final ç with c
   **
+  ** @param c The word being stemmed
+  **
   ** @return If at least one suffix has been removed
   */
   bool
-  French::step3ReplaceResidualLetters()
+  French::step3ReplaceResidualLetters(Context& c)
   {
-    uint last = _stem.length() - 1;
+    if (c.stemLength == 0)
+      return false;
 
-    if (_stem[last] == L'Y')
+    wchar_t& last = c.stem[c.stemLength - 1];
+    if (last == L'Y')
     {
-      _stem[last] = L'i';
+      last = L'i';
       return true;
     }
 
-    if (_stem[last] == L'ç')
+    if (last == L'ç')
     {
-      _stem[last] = L'c';
+      last = L'c';
       return true;
     }
 
@@ -467,90 +584,93 @@ namespace Stemmer
   ** In the rest of step 4, all tests are confined to the RV region.
   ** Search for the longest among the following suffixes, and perform
   ** the action indicated.
+  **
+  ** @param c The word being stemmed
   */
   void
-  French::step4ReplaceResidualSuffixes()
+  French::step4ReplaceResidualSuffixes(Context& c)
   {
-    if (_stem.length() < 1)
+    if (c.stemLength < 1)
       return;
 
     // If the word ends s, not preceded by a, i, o, u, è or s, delete it.
     {
-      uint length = _stem.length();
-      uint pos = length - 2;
-      if (_stem[length - 1] == L's' &&
-	  _stem[pos] != L'a' && _stem[pos] != L'i' &&
-	  _stem[pos] != L'o' && _stem[pos] != L'u' &&
-	  _stem[pos] != L'è' && _stem[pos] != L's')
-	_stem = _stem.substr(0, length - 1);
+      const uint length = c.stemLength;
+      const wchar_t before = length > 1 ? c.stem[length - 2] : 0;
+      if (c.stem[length - 1] == L's' &&
+	  before != L'a' && before != L'i' &&
+	  before != L'o' && before != L'u' &&
+	  before != L'è' && before != L's')
+	c.stemLength--;
     }
 
     // Delete if in R2 and preceded by s or t
     {
-      if (_rv.length() - 1 > 3)
+      const uint rvLength = c.length - c.rv;
+      if (rvLength > 4 && isSuffixeInRV(c, L"ion"))
       {
-	uint pos = _rv.length() - 1 - 3;
-	if (pos != 0 && isSuffixeInRV(L"ion") &&
-	    (_rv[pos] == L's' || _rv[pos] == L't'))
-	  deleteIfInR2(L"ion");
+	const wchar_t before = c.word[c.rv + rvLength - 4];
+	if (before == L's' || before == L't')
+	  deleteIfInR2(c, L"ion");
       }
     }
 
     // Replace with i
     {
-      static const std::wstring tab[] = {
+      static const wchar_t* const tab[] = {
 	L"Ière", L"ière", L"Ier", L"ier",
-	L""};
-      for (uint i = 0; tab[i] != L""; i++)
-	if (isSuffixeInRV(tab[i]))
-	  replaceSuffixWith(tab[i], L"i");
+	0};
+      for (uint i = 0; tab[i]; i++)
+	if (isSuffixeInRV(c, tab[i]))
+	  replaceSuffixWith(c, tab[i], L"i");
     }
 
     // Delete e
     {
-      uint length = _stem.length();
-      if (/*isSuffixeInRV(L"e") &&*/ isSuffixe(L"e"))
-	_stem = _stem.substr(0, length - 1);
+      if (/*isSuffixeInRV(c, L"e") &&*/ isSuffixe(c, L"e"))
+	c.stemLength--;
     }
 
     // Delete ë if preceded by gu
     {
-      uint length = _stem.length();
-      if (isSuffixeInRV(L"guë"))
-	_stem = _stem.substr(0, length - 1);
-      //replaceSuffixWith("ë", "");
-      // FIXME : check line above, _stem = _stem.substr(0, length - 1);
+      if (isSuffixeInRV(c, L"guë") && c.stemLength > 0)
+	c.stemLength--;
+      // FIXME : check if the last letter of the stem is really ë
     }
   }
 
   /*!
   ** If the word ends enn, onn, ett, ell or eill, delete the last letter.
+  **
+  ** @param c The word being stemmed
   */
   void
-  French::step5UnDouble()
+  French::step5UnDouble(Context& c)
   {
-    uint length = _stem.length();
-    static const std::wstring tab[] = {
+    const uint length = c.stemLength;
+    static const wchar_t* const tab[] = {
       L"enn", L"onn", L"ett", L"ell", L"eill",
-      L""};
-    for (uint i = 0; tab[i] != L""; i++)
-      if (isSuffixe(tab[i]))
-	_stem = _stem.substr(0, length - 1);
+      0};
+    for (uint i = 0; tab[i]; i++)
+      if (isSuffixe(c, tab[i]))
+	c.stemLength = length - 1;
   }
 
   /*!
   ** If the words ends é or è followed by at least one non-vowel, remove
   ** the accent from the e.
+  **
+  ** @param c The word being stemmed
   */
   void
-  French::step6UnAccent()
+  French::step6UnAccent(Context& c)
   {
-    uint length = _stem.length();
+    const uint length = c.stemLength;
     if (length < 2)
       return;
 
-    if ((_stem[length - 2] == L'é' || _stem[length - 2] == L'è') &&
-	!isVowel(_stem[length - 1]))
-      _stem[length - 2] = L'e';
+    if ((c.stem[length - 2] == L'é' || c.stem[length - 2] == L'è') &&
+	!isVowel(c.stem[length - 1]))
+      c.stem[length - 2] = L'e';
   }
 }
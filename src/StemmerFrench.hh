@@ -3,61 +3,84 @@
 
 # include "Stemmer.hh"
 # include <iostream>
-# include <boost/algorithm/string.hpp>
 # include <string>
 
 namespace Stemmer
 {
-  static const std::wstring VOWELS = L"aeiouyâàëéêèïîôûù";
-
+  /*!
+  ** French stemmer, following the Snowball algorithm.
+  ** The word is decoded in a stack buffer, one wchar_t per letter, and
+  ** RV, R1 and R2 are offsets in it rather than copies: a word is stemmed
+  ** without any allocation but the returned string.
+  */
   class French : public Generic
   {
-    typedef std::wstring::const_iterator citer;
-    typedef std::wstring::iterator iter;
     typedef unsigned int uint;
 
+    /*!
+    ** The word being stemmed. Regions are computed once, so they refer
+    ** to the word as it was before any suffix was removed, while the
+    ** stem is modified in place.
+    */
+    struct Context
+    {
+      const wchar_t*	word;
+      uint		length;
+      uint		rv;
+      uint		r1;
+      uint		r2;
+      wchar_t*		stem;
+      uint		stemLength;
+    };
+
+    /*!
+    ** A suffix of a table, with its precomputed length.
+    */
+    struct Suffix
+    {
+      const wchar_t*	str;
+      uint		length;
+    };
+
   public:
     French();
     virtual ~French();
     virtual const std::string getStem(const std::string& word);
 
   private:
-    void reset();
-    uint getFirstVowelPos(const std::wstring& word);
-    uint getLastVowelPos(const std::wstring& word);
-    bool isVowel(const wchar_t c);
-    void computeRV();
-    void computeR1();
-    void computeR2();
-    bool isInR1(const std::wstring& suffix);
-    bool isInR2(const std::wstring& suffix);
-    bool isInRV(const std::wstring& suffix);
-    uint getSuffixPos(const std::wstring& suffix);
-    bool isSuffixe(const std::wstring& suffix);
-    uint getSuffixPosInRV(const std::wstring& suffix);
-    bool isSuffixeInRV(const std::wstring& suffix);
-    bool replaceSuffixWith(const std::wstring& suffix, const std::wstring& with);
-    bool deleteIfInR1(const std::wstring& suffix);
-    bool deleteIfInR2(const std::wstring& suffix);
-    bool deleteIfInRV(const std::wstring& suffix);
-
-  private:
-    void applyConsonance();
-    bool step1StandardSuffixRemoval();
-    bool step2aDeleteVerbSuffixesBeginningWithI();
-    bool step2bDeleteOtherVerbSuffixes();
-    bool step3ReplaceResidualLetters();
-    void step4ReplaceResidualSuffixes();
-    void step5UnDouble();
-    void step6UnAccent();
-
+    static uint decode(const std::string& word, wchar_t* buffer);
+    static void encode(const wchar_t* stem, const uint length, std::string& res);
+    static uint length(const wchar_t* str);
+    static bool isVowel(const wchar_t c);
+    static uint getFirstVowelPos(const wchar_t* word, const uint length);
+    static uint getLastVowelPos(const wchar_t* word, const uint length);
+    static bool endsWith(const wchar_t* str, const uint length, const wchar_t* suffix);
+    static bool contains(const wchar_t* str, const uint length, const wchar_t* sub);
+    static void computeRV(Context& c);
+    static void computeR1(Context& c);
+    static void computeR2(Context& c);
+    static bool isInR1(const Context& c, const wchar_t* suffix);
+    static bool isInR2(const Context& c, const wchar_t* suffix);
+    static bool isInRV(const Context& c, const wchar_t* suffix);
+    static bool isRV(const Context& c, const wchar_t* str);
+    static bool isStem(const Context& c, const wchar_t* str);
+    static bool isSuffixe(const Context& c, const wchar_t* suffix);
+    static bool isSuffixe(const Context& c, const Suffix& suffix);
+    static bool isSuffixeInRV(const Context& c, const wchar_t* suffix);
+    static bool replaceSuffixWith(Context& c, const wchar_t* suffix, const wchar_t* with);
+    static bool deleteIfInR1(Context& c, const wchar_t* suffix);
+    static bool deleteIfInR2(Context& c, const wchar_t* suffix);
+    static bool deleteIfInRV(Context& c, const wchar_t* suffix);
 
   private:
-    std::wstring	_original;
-    std::wstring	_stem;
-    std::wstring	_rv;
-    std::wstring	_r1;
-    std::wstring	_r2;
+    static void applyConsonance(wchar_t* word, const uint length);
+    static bool step1StandardSuffixRemoval(Context& c);
+    static bool step2aDeleteVerbSuffixesBeginningWithI(Context& c);
+    static bool step2bDeleteOtherVerbSuffixes(Context& c);
+    static bool step3ReplaceResidualLetters(Context& c);
+    static void step4ReplaceResidualSuffixes(Context& c);
+    static void step5UnDouble(Context& c);
+    static void step6UnAccent(Context& c);
   };
 }
 
@@ -1,17 +1,55 @@
 namespace Stemmer
 {
+  /*!
+  ** Get the length of a suffix.
+  **
+  ** @param str The suffix
+  **
+  ** @return Its number of letters
+  */
+  inline French::uint
+  French::length(const wchar_t* str)
+  {
+    uint i = 0;
+    while (str[i])
+      i++;
+
+    return i;
+  }
+
+  /*!
+  ** Check if given character is a french vowel.
+  ** Uppercase is not consider as a vowel.
+  **
+  ** @param c The chararacter to test
+  **
+  ** @return If given character is a french vowel
+  */
+  inline bool
+  French::isVowel(const wchar_t c)
+  {
+    switch (c)
+    {
+      case L'a': case L'e': case L'i': case L'o': case L'u': case L'y':
+      case L'â': case L'à': case L'ë': case L'é': case L'ê': case L'è':
+      case L'ï': case L'î': case L'ô': case L'û': case L'ù':
+	return true;
+      default:
+	return false;
+    }
+  }
+
   /*!
   ** Get the position of the very first vowel of a word.
   **
   ** @param word The given word
+  ** @param length The length of the word
   **
-  ** @return Last vowel position
+  ** @return First vowel position, or the last letter if none
   */
-  inline uint
-  French::getFirstVowelPos(const std::wstring& word)
+  inline French::uint
+  French::getFirstVowelPos(const wchar_t* word, const uint length)
   {
-    uint length = word.length();
-
     for (uint i = 0; i < length; i++)
       if (isVowel(word[i]))
 	return i;
@@ -20,18 +58,18 @@ namespace Stemmer
   }
 
   /*!
-  ** Get the position of the very last vowel of a word.
+  ** Get the position of the very last vowel of a word, the first
+  ** letter excepted.
   **
   ** @param word The given word
+  ** @param length The length of the word
   **
-  ** @return Last vowel position
+  ** @return Last vowel position, or the last letter if none
   */
-  inline uint
-  French::getLastVowelPos(const std::wstring& word)
+  inline French::uint
+  French::getLastVowelPos(const wchar_t* word, const uint length)
   {
-    uint length = word.length();
-
-    for (uint i = length - 1; i != 0; i--)
+    for (uint i = length - 1; i > 0; i--)
       if (isVowel(word[i]))
 	return i;
 
@@ -39,28 +77,53 @@ namespace Stemmer
   }
 
   /*!
-  ** Clean all values.
+  ** Check if a string ends with a suffix.
+  **
+  ** @param str The string
+  ** @param length The length of the string
+  ** @param suffix The suffix
+  **
+  ** @return If the string ends with the suffix
   */
-  inline void
-  French::reset()
+  inline bool
+  French::endsWith(const wchar_t* str, const uint length, const wchar_t* suffix)
   {
-    _rv = L"";
-    _r1 = L"";
-    _r2 = L"";
+    const uint len = French::length(suffix);
+    if (len > length)
+      return false;
+
+    // Compare from the end, where words differ the most
+    str += length - len;
+    for (uint i = len; i > 0; i--)
+      if (str[i - 1] != suffix[i - 1])
+	return false;
+
+    return true;
   }
 
   /*!
-  ** Check if given character is a french vowel.
-  ** Uppercase is not consider as a vowel.
+  ** Check if a string contains another one.
   **
-  ** @param c The chararacter to test
+  ** @param str The string
+  ** @param length The length of the string
+  ** @param sub The string to search
   **
-  ** @return If given character is a french vowel
+  ** @return If the string was found
   */
   inline bool
-  French::isVowel(const wchar_t c)
+  French::contains(const wchar_t* str, const uint length, const wchar_t* sub)
   {
-    return VOWELS.find_first_of(c) != std::wstring::npos;
+    const uint len = French::length(sub);
+    for (uint i = 0; i + len <= length; i++)
+    {
+      uint j = 0;
+      while (j < len && str[i + j] == sub[j])
+	j++;
+      if (j == len)
+	return true;
+    }
+
+    return false;
   }
 
   /*!
@@ -77,38 +140,41 @@ namespace Stemmer
   **         |...|         |.....|       |.....|        |...|
   */
   inline void
-  French::computeRV()
+  French::computeRV(Context& c)
   {
-    uint length = _stem.length();
+    const wchar_t* w = c.word;
+    const uint length = c.length;
 
     // Handle par, col and tap exception
-    const std::wstring prefix = _stem.substr(0, 3);
-    if (prefix == L"par" || prefix == L"col" || prefix == L"tap")
+    if (length >= 3 &&
+	((w[0] == L'p' && w[1] == L'a' && w[2] == L'r') ||
+	 (w[0] == L'c' && w[1] == L'o' && w[2] == L'l') ||
+	 (w[0] == L't' && w[1] == L'a' && w[2] == L'p')))
     {
-      _rv = _stem.substr(3);
+      c.rv = 3;
       return;
     }
 
     // First 2 letters are vowels
-    if (length >= 3 && isVowel(_stem[0]) && isVowel(_stem[1]))
+    if (length >= 3 && isVowel(w[0]) && isVowel(w[1]))
     {
-      _rv = _stem.substr(2);
+      c.rv = 2;
       return;
     }
 
     // Search for rv region, finding second vowel if exists
-    uint first_vowels_pos = getFirstVowelPos(_stem);
-    uint last_vowels_pos = getLastVowelPos(_stem);
+    const uint first_vowels_pos = getFirstVowelPos(w, length);
+    const uint last_vowels_pos = getLastVowelPos(w, length);
     for (uint i = first_vowels_pos + 1; i < length; i++)
     {
-      if (isVowel(_stem[i]) && i != last_vowels_pos)
+      if (isVowel(w[i]) && i != last_vowels_pos)
       {
-	_rv = _stem.substr(i + 1);
+	c.rv = i + 1;
 	return;
       }
     }
 
-    _rv = _stem;
+    c.rv = 0;
   }
 
   /*!
@@ -122,19 +188,16 @@ namespace Stemmer
   **
   */
   inline void
-  French::computeR1()
+  French::computeR1(Context& c)
   {
-    uint length = _stem.length();
-    uint pos = getFirstVowelPos(_stem);
-    uint resPos = pos + 1;
-    for (uint i = pos + 1; i < length; i++)
-      if (!isVowel(_stem[i]))
+    const uint pos = getFirstVowelPos(c.word, c.length);
+    c.r1 = pos + 1;
+    for (uint i = pos + 1; i < c.length; i++)
+      if (!isVowel(c.word[i]))
       {
-	resPos = i + 1;
+	c.r1 = i + 1;
 	break;
       }
-
-    _r1 = _stem.substr(resPos);
   }
 
   /*!
@@ -148,161 +211,189 @@ namespace Stemmer
   **
   */
   inline void
-  French::computeR2()
+  French::computeR2(Context& c)
   {
-    uint length = _r1.length();
-    uint pos = getFirstVowelPos(_r1);
-    uint resPos = pos + 1;
+    const wchar_t* r1 = c.word + c.r1;
+    const uint length = c.length - c.r1;
+    if (length == 0)
+    {
+      c.r2 = c.length;
+      return;
+    }
+
+    const uint pos = getFirstVowelPos(r1, length);
+    c.r2 = c.r1 + pos + 1;
     for (uint i = pos + 1; i < length; i++)
-      if (!isVowel(_r1[i]))
+      if (!isVowel(r1[i]))
       {
-	resPos = i + 1;
+	c.r2 = c.r1 + i + 1;
 	break;
       }
-
-    _r2 = _r1.substr(resPos);
   }
 
   /*!
-  ** Try to get the given suffix position in the stem.
+  ** Check if a suffix lies in R1.
   **
-  ** @param suffix The suffix to search
+  ** @param c The word being stemmed
+  ** @param suffix The suffix to check
   **
-  ** @return Position of the suffix, ie last occurence of
-  ** given string, or std::wstring::npos if not found
+  ** @return If given suffix lies in R1
   */
-  inline uint
-  French::getSuffixPos(const std::wstring& suffix)
+  inline bool
+  French::isInR1(const Context& c, const wchar_t* suffix)
   {
-    uint pos = _stem.rfind(suffix);
-    return (_stem.length() - pos == suffix.length()) ? pos : std::wstring::npos;
+    return contains(c.word + c.r1, c.length - c.r1, suffix);
   }
 
   /*!
-  ** Try to get the given suffix position in RV.
+  ** Check if a suffix lies in R2.
   **
-  ** @param suffix The suffix to search
+  ** @param c The word being stemmed
+  ** @param suffix The suffix to check
   **
-  ** @return Position of the suffix, ie last occurence of
-  ** given string, or std::wstring::npos if not found
+  ** @return If given suffix lies in R2
   */
-  inline uint
-  French::getSuffixPosInRV(const std::wstring& suffix)
+  inline bool
+  French::isInR2(const Context& c, const wchar_t* suffix)
   {
-    uint pos = _rv.rfind(suffix);
-    return (_rv.length() - pos == suffix.length()) ? pos : std::wstring::npos;
+    return contains(c.word + c.r2, c.length - c.r2, suffix);
   }
 
   /*!
-  ** Check if given string can be a suffix for the current stem.
+  ** Check if a suffix lies in RV.
   **
-  ** @param suffix The word to check
+  ** @param c The word being stemmed
+  ** @param suffix The suffix to check
   **
-  ** @return If the given string can be a suffix
+  ** @return If given suffix lies in RV
   */
   inline bool
-  French::isSuffixe(const std::wstring& suffix)
+  French::isInRV(const Context& c, const wchar_t* suffix)
   {
-    return getSuffixPos(suffix) != std::wstring::npos;
+    return contains(c.word + c.rv, c.length - c.rv, suffix);
   }
 
   /*!
-  ** Check if given string can be a suffix in RV.
+  ** Check if RV is exactly the given string.
   **
-  ** @param suffix The word to check
+  ** @param c The word being stemmed
+  ** @param str The string to compare
   **
-  ** @return If the given string can be a suffix
+  ** @return If RV is equal to the string
   */
   inline bool
-  French::isSuffixeInRV(const std::wstring& suffix)
+  French::isRV(const Context& c, const wchar_t* str)
   {
-    return getSuffixPosInRV(suffix) != std::wstring::npos;
+    return c.length - c.rv == length(str) && endsWith(c.word, c.length, str);
   }
 
   /*!
-  ** Replace a suffix with the given string.
+  ** Check if the current stem is exactly the given string.
   **
-  ** @param suffix The suffix to search
-  ** @param with The string for replacement
+  ** @param c The word being stemmed
+  ** @param str The string to compare
   **
-  ** @return If a replacement occured
+  ** @return If the stem is equal to the string
   */
   inline bool
-  French::replaceSuffixWith(const std::wstring& suffix, const std::wstring& with)
+  French::isStem(const Context& c, const wchar_t* str)
   {
-    uint pos = getSuffixPos(suffix);
-    if (pos != std::wstring::npos)
-    {
-      _stem = _stem.substr(0, pos);
-      _stem += with;
-      return true;
-    }
+    return c.stemLength == length(str) && endsWith(c.stem, c.stemLength, str);
+  }
 
-    return false;
+  /*!
+  ** Check if given string can be a suffix for the current stem.
+  **
+  ** @param c The word being stemmed
+  ** @param suffix The word to check
+  **
+  ** @return If the given string can be a suffix
+  */
+  inline bool
+  French::isSuffixe(const Context& c, const wchar_t* suffix)
+  {
+    return endsWith(c.stem, c.stemLength, suffix);
   }
 
   /*!
-  ** Check if a suffix lies in R1.
+  ** Check if a suffix of a table can be a suffix for the current
+  ** stem. Letters are compared from the last one, so most tables
+  ** are skipped without reading their strings twice.
   **
+  ** @param c The word being stemmed
   ** @param suffix The suffix to check
   **
-  ** @return If given suffix lies in R1
+  ** @return If the given suffix can be a suffix
   */
   inline bool
-  French::isInR1(const std::wstring& suffix)
+  French::isSuffixe(const Context& c, const Suffix& suffix)
   {
-    return _r1.find(suffix) != std::wstring::npos;
+    if (suffix.length > c.stemLength)
+      return false;
+
+    const wchar_t* str = c.stem + c.stemLength - suffix.length;
+    for (uint i = suffix.length; i > 0; i--)
+      if (str[i - 1] != suffix.str[i - 1])
+	return false;
+
+    return true;
   }
 
   /*!
-  ** Check if a suffix lies in R2.
+  ** Check if given string can be a suffix in RV.
   **
-  ** @param suffix The suffix to check
+  ** @param c The word being stemmed
+  ** @param suffix The word to check
   **
-  ** @return If given suffix lies in R2
+  ** @return If the given string can be a suffix
   */
   inline bool
-  French::isInR2(const std::wstring& suffix)
+  French::isSuffixeInRV(const Context& c, const wchar_t* suffix)
   {
-    return _r2.find(suffix) != std::wstring::npos;
+    return endsWith(c.word + c.rv, c.length - c.rv, suffix);
   }
 
   /*!
-  ** Check if a suffix lies in RV.
+  ** Replace a suffix with the given string.
+  ** The stem buffer has room for a replacement longer than the suffix.
   **
-  ** @param suffix The suffix to check
+  ** @param c The word being stemmed
+  ** @param suffix The suffix to search
+  ** @param with The string for replacement
   **
-  ** @return If given suffix lies in RvV
+  ** @return If a replacement occured
   */
   inline bool
-  French::isInRV(const std::wstring& suffix)
+  French::replaceSuffixWith(Context& c, const wchar_t* suffix, const wchar_t* with)
   {
-    return _rv.find(suffix) != std::wstring::npos;
+    if (!isSuffixe(c, suffix))
+      return false;
+
+    c.stemLength -= length(suffix);
+    while (*with)
+      c.stem[c.stemLength++] = *with++;
+
+    return true;
   }
 
   /*!
-  ** Delete if in R2 means that a found suffix should be removed
-  ** if it lies entirely in R2, but not if it overlaps R2 and
+  ** Delete if in R1 means that a found suffix should be removed
+  ** if it lies entirely in R1, but not if it overlaps R1 and
   ** the rest of the word.
   **
+  ** @param c The word being stemmed
   ** @param suffix The suffix of the term to delete
   **
   ** @return If deletion occured or not
   */
   inline bool
-  French::deleteIfInR1(const std::wstring& suffix)
+  French::deleteIfInR1(Context& c, const wchar_t* suffix)
   {
-    uint pos = getSuffixPos(suffix);
-    if (pos == std::wstring::npos)
+    if (!isSuffixe(c, suffix) || !isInR1(c, suffix) || isStem(c, suffix))
       return false;
 
-    if (isInR1(suffix) && _stem != suffix)
-    {
-      _stem = _stem.substr(0, pos);
-      return true;
-    }
-
-    return false;
+    c.stemLength -= length(suffix);
+    return true;
   }
 
   /*!
@@ -310,24 +401,19 @@ namespace Stemmer
   ** if it lies entirely in R2, but not if it overlaps R2 and
   ** the rest of the word.
   **
+  ** @param c The word being stemmed
   ** @param suffix The suffix of the term to delete
   **
   ** @return If deletion occured or not
   */
   inline bool
-  French::deleteIfInR2(const std::wstring& suffix)
+  French::deleteIfInR2(Context& c, const wchar_t* suffix)
   {
-    uint pos = getSuffixPos(suffix);
-    if (pos == std::wstring::npos)
+    if (!isSuffixe(c, suffix) || !isInR2(c, suffix) || isStem(c, suffix))
       return false;
 
-    if (isInR2(suffix) && _stem != suffix)
-    {
-      _stem = _stem.substr(0, pos);
-      return true;
-    }
-
-    return false;
+    c.stemLength -= length(suffix);
+    return true;
   }
 
   /*!
@@ -335,23 +421,18 @@ namespace Stemmer
   ** if it lies entirely in RV, but not if it overlaps RV and
   ** the rest of the word.
   **
+  ** @param c The word being stemmed
   ** @param suffix The suffix of the term to delete
   **
   ** @return If deletion occured or not
   */
   inline bool
-  French::deleteIfInRV(const std::wstring& suffix)
+  French::deleteIfInRV(Context& c, const wchar_t* suffix)
   {
-    uint pos = getSuffixPos(suffix);
-    if (pos == std::wstring::npos)
+    if (!isSuffixe(c, suffix) || !isInRV(c, suffix) || isStem(c, suffix))
       return false;
 
-    if (isInRV(suffix) && _stem != suffix)
-    {
-      _stem = _stem.substr(0, pos);
-      return true;
-    }
-
-    return false;
+    c.stemLength -= length(suffix);
+    return true;
   }
 }
@@ -0,0 +1,143 @@
+#include <fstream>
+#include <sstream>
+#include <boost/tokenizer.hpp>
+#include "StopWords.hh"
+#ifdef EMBEDDED_STOPWORDS
+# include "DefaultStopWords.hh"
+#endif
+
+namespace Index
+{
+  namespace
+  {
+    // Initial number of slots, must be a power of two
+    static const unsigned int INITIAL_CAPACITY = 16;
+  }
+
+  /*!
+  ** Construct an empty set of stop words.
+  */
+  StopWords::StopWords()
+    : _size(0), _mask(0)
+  {
+    resize(INITIAL_CAPACITY);
+  }
+
+  /*!
+  ** Destruct a set of stop words.
+  */
+  StopWords::~StopWords()
+  {
+  }
+
+  /*!
+  ** Add a stop word. The table is doubled when it becomes half full.
+  **
+  ** @param word The word to add
+  */
+  void
+  StopWords::insert(const std::string& word)
+  {
+    const unsigned int h = Utils::hash(word);
+    unsigned int i = findSlot(word, h);
+    if (_hashes[i] != 0)
+      return;
+
+    if (2 * (_size + 1) > _hashes.size())
+    {
+      resize(2 * _hashes.size());
+      i = findSlot(word, h);
+    }
+    _words[i] = word;
+    _hashes[i] = h;
+    _size++;
+  }
+
+  /*!
+  ** Forget all stop words.
+  */
+  void
+  StopWords::clear()
+  {
+    _words.clear();
+    _hashes.clear();
+    _size = 0;
+    resize(INITIAL_CAPACITY);
+  }
+
+  /*!
+  ** Replace the stop words by the ones of a file, separated by spaces.
+  **
+  ** @param filename The file of stop words
+  ** @param normalizer The normalizer of the indexed words
+  **
+  ** @return If the file could be read. Else the set is left empty.
+  */
+  bool
+  StopWords::load(const std::string& filename, const Normalizer& normalizer)
+  {
+    typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+
+    clear();
+    std::ifstream file(filename.c_str());
+    if (!file)
+      return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    file.close();
+    std::string buf;
+    normalizer.normalize(buffer.str(), buf);
+
+    tokenizer tokens(buf);
+    for (tokenizer::iterator tok_iter = tokens.begin();
+	 tok_iter != tokens.end(); ++tok_iter)
+      insert(*tok_iter);
+
+    return true;
+  }
+
+  /*!
+  ** Replace the stop words by the ones embedded at build time, without
+  ** reading any file. Without embedded list, there is no stop word.
+  **
+  ** @param normalizer The normalizer of the indexed words
+  */
+  void
+  StopWords::loadDefault(const Normalizer& normalizer)
+  {
+    clear();
+#ifdef EMBEDDED_STOPWORDS
+    std::string word;
+    for (unsigned int i = 0; DEFAULT_STOPWORDS[i]; i++)
+    {
+      normalizer.normalize(DEFAULT_STOPWORDS[i], word);
+      insert(word);
+    }
+#else
+    (void) normalizer;
+#endif
+  }
+
+  /*!
+  ** Rebuild the table with the given number of slots.
+  **
+  ** @param capacity The new number of slots, a power of two
+  */
+  void
+  StopWords::resize(const unsigned int capacity)
+  {
+    std::vector<std::string> words(capacity);
+    std::vector<unsigned int> hashes(capacity, 0);
+    words.swap(_words);
+    hashes.swap(_hashes);
+    _mask = capacity - 1;
+
+    for (unsigned int i = 0; i < hashes.size(); i++)
+      if (hashes[i] != 0)
+      {
+	const unsigned int j = findSlot(words[i], hashes[i]);
+	_words[j].swap(words[i]);
+	_hashes[j] = hashes[i];
+      }
+  }
+}
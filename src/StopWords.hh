@@ -0,0 +1,47 @@
+#ifndef STOPWORDS_HH_
+# define STOPWORDS_HH_
+
+# include <iostream>
+# include <string>
+# include <vector>
+# include "Utils.hh"
+# include "Normalizer.hh"
+
+namespace Index
+{
+  /*!
+  ** A set of stop words, stored in an open addressing hash table with
+  ** linear probing. The table is kept at most half full, so that a
+  ** lookup usually compares a single hash, and at most one string.
+  ** Stop words are normalized when loaded, like the words they're
+  ** compared with.
+  */
+  class StopWords
+  {
+  public:
+    StopWords();
+    ~StopWords();
+
+  public:
+    void insert(const std::string& word);
+    bool contains(const std::string& word) const;
+    unsigned int size() const;
+    void clear();
+    bool load(const std::string& filename, const Normalizer& normalizer);
+    void loadDefault(const Normalizer& normalizer);
+
+  private:
+    unsigned int findSlot(const std::string& word, const unsigned int h) const;
+    void resize(const unsigned int capacity);
+
+  private:
+    std::vector<std::string>	_words;
+    std::vector<unsigned int>	_hashes;
+    unsigned int		_size;
+    unsigned int		_mask;
+  };
+}
+
+# include "StopWords.hxx"
+
+#endif /* !STOPWORDS_HH_ */
@@ -0,0 +1,44 @@
+namespace Index
+{
+  /*!
+  ** Find the slot of a word, or the empty slot where it would be.
+  **
+  ** @param word The word to look for
+  ** @param h The hash of the word
+  **
+  ** @return The index of the slot
+  */
+  inline unsigned int
+  StopWords::findSlot(const std::string& word, const unsigned int h) const
+  {
+    unsigned int i = h & _mask;
+    while (_hashes[i] != 0 && (_hashes[i] != h || _words[i] != word))
+      i = (i + 1) & _mask;
+
+    return i;
+  }
+
+  /*!
+  ** Check if a word is a stop word.
+  **
+  ** @param word The word to check
+  **
+  ** @return If the word is in the set
+  */
+  inline bool
+  StopWords::contains(const std::string& word) const
+  {
+    return _hashes[findSlot(word, Utils::hash(word))] != 0;
+  }
+
+  /*!
+  ** Get the number of stop words.
+  **
+  ** @return The number of stop words
+  */
+  inline unsigned int
+  StopWords::size() const
+  {
+    return _size;
+  }
+}
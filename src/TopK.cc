@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <functional>
+#include "TopK.hh"
+
+namespace
+{
+  /*!
+  ** A position in a posting list, with the best score of the list.
+  */
+  struct Cursor
+  {
+    const PostingList*	list;
+    unsigned int	pos;
+    double		maxScore;
+
+    bool operator<(const Cursor& other) const
+    {
+      return maxScore < other.maxScore;
+    }
+  };
+}
+
+/*!
+** Construct an empty selection.
+**
+** @param k Number of documents to keep
+*/
+TopK::TopK(const unsigned int k)
+  : _k(k)
+{
+  _heap.reserve(k);
+}
+
+/*!
+** Destruct a selection.
+*/
+TopK::~TopK()
+{
+}
+
+/*!
+** Offer all documents of a posting list.
+**
+** @param postings The posting list
+*/
+void
+TopK::addAll(const PostingList& postings)
+{
+  for (unsigned int i = 0; i < postings.ids.size(); i++)
+    push(postings.ids[i], postings.scores[i]);
+}
+
+/*!
+** Offer the documents matching any of the given lists, with the sum of
+** their scores, skipping the ones which can't be kept (MaxScore).
+** Lists are sorted by best score. While the best scores of the first
+** lists sum below the threshold, a document found only in them can't be
+** kept: these lists are no longer walked, only searched for the documents
+** of the others, and only while the document can still pass the threshold.
+**
+** @param lists The posting lists
+*/
+void
+TopK::addDisjunction(const std::vector<const PostingList*>& lists)
+{
+  const unsigned int size = lists.size();
+  std::vector<Cursor> cursors(size);
+  std::vector<double> bounds(size);
+
+  for (unsigned int i = 0; i < size; i++)
+  {
+    const std::vector<double>& scores = lists[i]->scores;
+    cursors[i].list = lists[i];
+    cursors[i].pos = 0;
+    cursors[i].maxScore = scores.empty() ? 0 :
+      *std::max_element(scores.begin(), scores.end());
+  }
+  std::sort(cursors.begin(), cursors.end());
+  for (unsigned int i = 0; i < size; i++)
+    bounds[i] = cursors[i].maxScore + (i > 0 ? bounds[i - 1] : 0);
+
+  // Lists before firstEssential can't bring a document on their own
+  unsigned int firstEssential = 0;
+  for (;;)
+  {
+    unsigned int id = 0;
+    bool found = false;
+    for (unsigned int i = firstEssential; i < size; i++)
+      if (cursors[i].pos < cursors[i].list->ids.size() &&
+	  (!found || cursors[i].list->ids[cursors[i].pos] < id))
+      {
+	id = cursors[i].list->ids[cursors[i].pos];
+	found = true;
+      }
+    if (!found)
+      break;
+
+    double score = 0;
+    for (unsigned int i = firstEssential; i < size; i++)
+    {
+      Cursor& c = cursors[i];
+      if (c.pos < c.list->ids.size() && c.list->ids[c.pos] == id)
+	score += c.list->scores[c.pos++];
+    }
+
+    bool pruned = false;
+    for (unsigned int i = firstEssential; i-- > 0; )
+    {
+      if (score + bounds[i] < getThreshold())
+      {
+	pruned = true;
+	break;
+      }
+      Cursor& c = cursors[i];
+      c.pos = ArrayUtils::gallop(c.list->ids, c.pos, id);
+      if (c.pos < c.list->ids.size() && c.list->ids[c.pos] == id)
+	score += c.list->scores[c.pos];
+    }
+
+    if (!pruned && push(id, score))
+      while (firstEssential < size && bounds[firstEssential] < getThreshold())
+	firstEssential++;
+  }
+}
+
+/*!
+** Get the kept documents, the best first.
+**
+** @return The kept documents, as (score, id) pairs
+*/
+const std::vector<TopK::entry>
+TopK::getSorted() const
+{
+  std::vector<entry> res(_heap);
+  std::sort(res.begin(), res.end(), std::greater<entry>());
+  return res;
+}
@@ -0,0 +1,38 @@
+#ifndef TOPK_HH_
+# define TOPK_HH_
+
+# include <algorithm>
+# include <functional>
+# include <vector>
+# include <utility>
+# include "ArrayUtils.hh"
+
+/*!
+** Keep the k best scored documents among the ones given, in a bounded
+** min-heap: the worst kept document is on top, and is replaced as soon
+** as a better one is found.
+*/
+class TopK
+{
+public:
+  typedef std::pair<double, unsigned int> entry;
+
+public:
+  TopK(const unsigned int k);
+  ~TopK();
+
+public:
+  bool push(const unsigned int id, const double score);
+  double getThreshold() const;
+  void addAll(const PostingList& postings);
+  void addDisjunction(const std::vector<const PostingList*>& lists);
+  const std::vector<entry> getSorted() const;
+
+private:
+  std::vector<entry>	_heap;
+  const unsigned int	_k;
+};
+
+# include "TopK.hxx"
+
+#endif /* !TOPK_HH_ */
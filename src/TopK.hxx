@@ -0,0 +1,38 @@
+/*!
+** Offer a document. It's kept if there are less than k documents, or
+** if it's better than the worst kept one, which is then dropped.
+**
+** @param id The document id
+** @param score The document score
+**
+** @return If the document was kept
+*/
+inline bool
+TopK::push(const unsigned int id, const double score)
+{
+  const entry e(score, id);
+  if (_heap.size() < _k)
+  {
+    _heap.push_back(e);
+    std::push_heap(_heap.begin(), _heap.end(), std::greater<entry>());
+    return true;
+  }
+  if (_k == 0 || !(_heap.front() < e))
+    return false;
+
+  std::pop_heap(_heap.begin(), _heap.end(), std::greater<entry>());
+  _heap.back() = e;
+  std::push_heap(_heap.begin(), _heap.end(), std::greater<entry>());
+  return true;
+}
+
+/*!
+** Get the score a document must pass to be kept.
+**
+** @return The score of the worst kept document, or -1 while there is room
+*/
+inline double
+TopK::getThreshold() const
+{
+  return _heap.size() < _k ? -1 : _heap.front().first;
+}
@@ -1,4 +1,10 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <cassert>
+#include <cerrno>
+#include <cstdio>
 #include "Utils.hh"
 
 /*!
@@ -113,155 +119,97 @@ Utils::stringToDouble(const std::string s)
 }
 
 /*!
-** Transform a wide UTF-8 string to an UNICODE string one.
+** Write a file atomically: the content is written in a temporary file,
+** synchronized on disk, then renamed.
 **
-** @param ws The wide UTF-8 string
+** @param filename The path of the file
+** @param content The content
 **
-** @return An UNICODE string
+** @return If the file was written
 */
-std::string
-Utils::narrow(const std::wstring& ws)
+bool
+Utils::writeFile(const std::string& filename, const std::string& content)
 {
-  std::vector<char> buffer(ws.size());
-  std::locale loc("fr_FR.utf8");
-  std::use_facet< std::ctype<wchar_t> >(loc).narrow(ws.data(), ws.data() + ws.size(), '?', &buffer[0]);
+  const std::string tmp = filename + ".tmp";
+  const int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
 
-  return std::string(&buffer[0], buffer.size());
-}
-std::string
-Utils::my_narrow(const std::wstring& ws)
-{
-  std::ostringstream s;
-  unsigned int length = ws.length();
-  for (unsigned int i = 0; i < length; i++)
+  std::string::size_type written = 0;
+  while (written < content.length())
   {
-    switch (ws[i])
-    {
-      case L'â': s << "â"; break;
-      case L'à': s << "à"; break;
-      case L'ç': s << "ç"; break;
-      case L'ë': s << "ë"; break;
-      case L'é': s << "é"; break;
-      case L'ê': s << "ê"; break;
-      case L'è': s << "è"; break;
-      case L'ï': s << "ï"; break;
-      case L'î': s << "î"; break;
-      case L'ô': s << "ô"; break;
-      case L'û': s << "û"; break;
-      case L'ù': s << "ù"; break;
-      default: s << static_cast<unsigned char>(ws[i]);
-    }
+    const ssize_t n = ::write(fd, content.data() + written, content.length() - written);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    written += n;
+  }
+
+  const bool res = written == content.length() && fsync(fd) == 0;
+  if (::close(fd) != 0 || !res || rename(tmp.c_str(), filename.c_str()) != 0)
+  {
+    unlink(tmp.c_str());
+    return false;
   }
 
-  return s.str();
+  return true;
 }
 
 /*!
-** Renarrow a string.
-** It's an ugly ugly hack to make things works.
-** Fucking encoding !
+** Encode increasing word positions as deltas, with 7 bits per byte, the
+** high bit set on all bytes but the last one of each delta.
 **
-** @param s The string to renarrow
-**
-** @return The renarrowed string
+** @param positions The positions, in increasing order
+** @param out Where to write the encoded positions
 */
-std::string
-Utils::renarrow(const std::string& s)
+void
+Utils::encodePositions(const std::vector<unsigned int>& positions,
+		       std::string& out)
 {
-  std::ostringstream ws;
-  unsigned int length = s.length();
-  for (unsigned int i = 0; i < length; i++)
+  out.clear();
+  unsigned int last = 0;
+  for (std::vector<unsigned int>::const_iterator i = positions.begin();
+       i != positions.end(); ++i)
   {
-    if (i + 1 < length && s[i] == -61)
-    {
-      switch (s[i + 1])
-      {
-	case -94: ws << "â"; break;
-	case -96: ws << "à"; break;
-	case -89: ws << "ç"; break;
-	case -85: ws << "ë"; break;
-	case -87: ws << "é"; break;
-	case -86: ws << "ê"; break;
-	case -88: ws << "è"; break;
-	case -81: ws << "ï"; break;
-	case -82: ws << "î"; break;
-	case -76: ws << "ô"; break;
-	case -69: ws << "û"; break;
-	case -71: ws << "ù"; break;
-      }
-      i++;
-    }
-    else
+    unsigned int delta = *i - last;
+    last = *i;
+    while (delta >= 0x80)
     {
-      switch (s[i])
-      {
-	case -30: ws << "â"; break;
-	case -28: ws << "ä"; break;
-	case -32: ws << "à"; break;
-	case -25: ws << "ç"; break;
-	case -21: ws << "ë"; break;
-	case -23: ws << "é"; break;
-	case -22: ws << "ê"; break;
-	case -24: ws << "è"; break;
-	case -17: ws << "ï"; break;
-	case -18: ws << "î"; break;
-	case -12: ws << "ô"; break;
-	case -5:  ws << "û"; break;
-	case -7: ws << "ù"; break;
-	default : ws << s[i];
-      }
+      out += static_cast<char>((delta & 0x7F) | 0x80);
+      delta >>= 7;
     }
+    out += static_cast<char>(delta);
   }
-
-  return ws.str();
 }
 
-
 /*!
-** Transform an UNICODE string to a wide UTF-8 string one.
+** Decode word positions written by encodePositions.
 **
-** @param ws The UNICODE string
-**
-** @return A wide UTF-8 string
+** @param data The encoded positions
+** @param length The number of bytes
+** @param positions Where to store the positions, in increasing order
 */
-std::wstring
-Utils::widen(const std::string& s)
-{
-  std::vector<wchar_t> buffer(s.size());
-  std::locale loc("fr_FR.utf8");
-  std::use_facet< std::ctype<wchar_t> >(loc).widen(s.data(), s.data() + s.size(), &buffer[0]);
-
-  return std::wstring(&buffer[0], buffer.size());
-}
-std::wstring
-Utils::my_widen(const std::string& s)
+void
+Utils::decodePositions(const char* data, const unsigned int length,
+		       std::vector<unsigned int>& positions)
 {
-  std::wostringstream ws;
-  unsigned int length = s.length();
-  for (unsigned int i = 0; i < length; i++)
+  positions.clear();
+  unsigned int position = 0;
+  unsigned int i = 0;
+  while (i < length)
   {
-    if (i + 1 < length && s[i] == -61)
+    unsigned int delta = 0;
+    unsigned int shift = 0;
+    unsigned char byte;
+    do
     {
-      switch (s[i + 1])
-      {
-	case -94: ws << L'â'; break;
-	case -96: ws << L'à'; break;
-	case -89: ws << L'ç'; break;
-	case -85: ws << L'ë'; break;
-	case -87: ws << L'é'; break;
-	case -86: ws << L'ê'; break;
-	case -88: ws << L'è'; break;
-	case -81: ws << L'ï'; break;
-	case -82: ws << L'î'; break;
-	case -76: ws << L'ô'; break;
-	case -69: ws << L'û'; break;
-	case -71: ws << L'ù'; break;
-      }
-      i++;
+      byte = data[i++];
+      delta |= (byte & 0x7F) << shift;
+      shift += 7;
     }
-    else
-      ws << static_cast<wchar_t>(s[i]);
+    while (byte & 0x80 && i < length);
+    position += delta;
+    positions.push_back(position);
   }
-
-  return ws.str();
 }
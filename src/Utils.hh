@@ -6,7 +6,6 @@
 # include <sstream>
 # include <fstream>
 # include <iostream>
-# include <locale>
 
 class Utils
 {
@@ -33,12 +32,12 @@ public:
   static double stringToDouble(const std::string s);
   static const std::string activeSpecialChar(const std::string& s);
   static bool fileExists(const std::string& filename);
-  static std::string narrow(const std::wstring& ws);
-  static std::wstring widen(const std::string& s);
-  static std::string my_narrow(const std::wstring& ws);
-  static std::wstring my_widen(const std::string& s);
-  static void rewiden(std::string& s);
-  static std::string renarrow(const std::string& s);
+  static bool writeFile(const std::string& filename, const std::string& content);
+  static unsigned int hash(const std::string& s);
+  static void encodePositions(const std::vector<unsigned int>& positions,
+			      std::string& out);
+  static void decodePositions(const char* data, const unsigned int length,
+			      std::vector<unsigned int>& positions);
 };
 
 # include "Utils.hxx"
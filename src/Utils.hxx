@@ -153,50 +153,22 @@ Utils::fileExists(const std::string& filename)
 }
 
 /*!
-** Special widen, transform weird character to a better one.
+** Compute the FNV-1a hash of a string. As 0 is used to mark empty slots
+** in hash tables, it is never returned.
 **
-** @param s The string to modify
+** @param s The string to hash
+**
+** @return The hash of the string
 */
-inline void
-Utils::rewiden(std::string& buf)
+inline unsigned int
+Utils::hash(const std::string& s)
 {
-  static const std::pair<int, std::string> tab[] = {
-    std::make_pair(-5, "â"),
-    std::make_pair(-5, "à"),
-    std::make_pair(-5, "ç"),
-    std::make_pair(-5, "ë"),
-    std::make_pair(-5, "é"),
-    std::make_pair(-5, "ê"),
-    std::make_pair(-5, "è"),
-    std::make_pair(-5, "ï"),
-    std::make_pair(-5, "î"),
-    std::make_pair(-5, "ô"),
-    std::make_pair(-5, "û"),
-    std::make_pair(-5, "ù"),
-    std::make_pair(0, "")
-  };
-
-  std::ostringstream s;
-  for (std::string::iterator i = buf.begin(); i != buf.end(); ++i)
+  unsigned int h = 2166136261u;
+  for (std::string::const_iterator i = s.begin(); i != s.end(); ++i)
   {
-    int code = (int)(*i);
-    switch (code)
-    {
-      case -5: s << "â"; break;
-      case -96: s << "à"; break;
-      case -89: s << "ç"; break;
-      case -85: s << "ë"; break;
-      case -87: s << "é"; break;
-      case -86: s << "ê"; break;
-      case -88: s << "è"; break;
-      case -81: s << "ï"; break;
-      case -82: s << "î"; break;
-      case -76: s << "ô"; break;
-      case -69: s << "û"; break;
-      case -71: s << "ù"; break;
-      default: s << *i;
-    }
+    h ^= static_cast<unsigned char>(*i);
+    h *= 16777619u;
   }
 
-  buf = s.str();
+  return h ? h : 1;
 }
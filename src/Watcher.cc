@@ -0,0 +1,416 @@
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <boost/filesystem/operations.hpp>
+#include "Watcher.hh"
+#include "StemmerFactory.hh"
+#include "Configuration.hh"
+
+namespace Index
+{
+  namespace
+  {
+    // Events which may change the indexed content of a directory
+    static const uint32_t EVENTS = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB |
+      IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+    // Time a path must stay quiet before being processed, in milliseconds
+    static const unsigned long long QUIET_DELAY = 500;
+
+    // Minimum time between two collections of unused terms, in milliseconds
+    static const unsigned long long CLEANUP_DELAY = 60000;
+
+    // Number of paths processed within a single transaction
+    static const unsigned int BATCH_SIZE = 64;
+
+    // Size of the buffer where the events are read
+    static const unsigned int BUFFER_SIZE = 64 * 1024;
+
+    // Set when the watcher is asked to stop
+    static volatile sig_atomic_t stopped = 0;
+
+    void
+    stop(int)
+    {
+      stopped = 1;
+    }
+  }
+
+  /*!
+  ** Construct a watcher.
+  **
+  ** @param indexer The indexer which processes the modified files
+  */
+  Watcher::Watcher(const Indexer& indexer)
+    : _indexer(indexer), _fd(-1), _buffer(BUFFER_SIZE), _modified(false),
+      _lastCleanup(0)
+  {
+    Stemmer::StemmerFactory factory;
+    Configuration& cfg = Configuration::getInstance();
+    _stem.reset(factory.get(cfg.getStemmerName(), cfg.getStemCache()));
+  }
+
+  /*!
+  ** Destruct a watcher.
+  */
+  Watcher::~Watcher()
+  {
+    if (_fd >= 0)
+      close(_fd);
+  }
+
+  /*!
+  ** Index some directories, then keep their index up to date until
+  ** SIGINT or SIGTERM is received. The directories are watched before
+  ** being indexed, so that no modification is missed meanwhile.
+  **
+  ** @param roots The directories to watch
+  */
+  void
+  Watcher::run(const std::vector<std::string>& roots)
+  {
+    _fd = inotify_init();
+    if (_fd < 0)
+    {
+      std::cerr << "Can't watch files : " << strerror(errno) << std::endl;
+      return;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof (action));
+    action.sa_handler = stop;
+    sigaction(SIGINT, &action, 0);
+    sigaction(SIGTERM, &action, 0);
+
+    for (std::vector<std::string>::const_iterator i = roots.begin();
+	 i != roots.end(); ++i)
+    {
+      const fs::path root = fs::system_complete(fs::path(*i, fs::native));
+      if (!fs::is_directory(root))
+      {
+	std::cerr << "Not a directory: " << root.native_file_string() << std::endl;
+	continue;
+      }
+      _roots.push_back(root);
+      addWatches(root);
+      _indexer.indexDirectory(root.native_file_string());
+    }
+    Index::Database::getInstance().flush();
+    _lastCleanup = now();
+
+    while (!stopped && !_watches.empty())
+    {
+      struct pollfd fd = { _fd, POLLIN, 0 };
+      const int res = poll(&fd, 1, getTimeout());
+      if (res < 0 && errno != EINTR)
+	break;
+      if (res > 0 && !readEvents())
+	rescan();
+      processPending(false);
+      cleanup(false);
+    }
+
+    // Don't lose what was already seen
+    processPending(true);
+    cleanup(true);
+  }
+
+  /*!
+  ** Watch a directory and all its subdirectories, hidden ones excepted.
+  ** Watching a directory twice only updates its path.
+  **
+  ** @param directory The full boost path of the directory
+  */
+  void
+  Watcher::addWatches(const fs::path& directory)
+  {
+    const int wd = inotify_add_watch(_fd, directory.native_file_string().c_str(), EVENTS);
+    if (wd < 0)
+    {
+      std::cerr << directory.native_file_string() << " : " << strerror(errno) << std::endl;
+      return;
+    }
+    _watches[wd] = directory;
+
+    fs::directory_iterator end;
+    for (fs::directory_iterator it(directory); it != end; ++it)
+    {
+      try
+      {
+	if (_indexer.isIndexable(it->leaf()) && fs::is_directory(it->status()))
+	  addWatches(directory / it->leaf());
+      }
+      catch (const std::exception & ex)
+      {
+	std::cerr << it->leaf() << " : " << ex.what() << std::endl;
+      }
+    }
+  }
+
+  /*!
+  ** Stop watching a directory which was deleted or moved, and all its
+  ** subdirectories.
+  **
+  ** @param directory The full path of the directory
+  */
+  void
+  Watcher::removeWatches(const std::string& directory)
+  {
+    const std::string prefix = directory + "/";
+    watchMap::iterator i = _watches.begin();
+    while (i != _watches.end())
+    {
+      const std::string path = i->second.native_file_string();
+      if (path == directory || path.compare(0, prefix.length(), prefix) == 0)
+      {
+	inotify_rm_watch(_fd, i->first);
+	_watches.erase(i++);
+      }
+      else
+	++i;
+    }
+  }
+
+  /*!
+  ** Read the available events, and note the paths they concern. Each
+  ** event delays the processing of its path, so that a file being
+  ** written is only read once it's finished.
+  **
+  ** @return False if events were lost, because the queue overflowed
+  */
+  bool
+  Watcher::readEvents()
+  {
+    const ssize_t length = read(_fd, &_buffer[0], _buffer.size());
+    if (length <= 0)
+      return true;
+
+    const unsigned long long deadline = now() + QUIET_DELAY;
+    bool overflow = false;
+    for (ssize_t pos = 0; pos < length;)
+    {
+      const struct inotify_event* event =
+	reinterpret_cast<const struct inotify_event*>(&_buffer[pos]);
+      pos += sizeof (struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW)
+	overflow = true;
+      if (event->mask & IN_IGNORED)
+	_watches.erase(event->wd);
+
+      const watchMap::const_iterator watch = _watches.find(event->wd);
+      if (event->len == 0 || watch == _watches.end() ||
+	  !_indexer.isIndexable(event->name))
+	continue;
+
+      const fs::path path = watch->second / std::string(event->name);
+      const std::string filename = path.native_file_string();
+      if (event->mask & IN_ISDIR)
+      {
+	if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+	  removeWatches(filename);
+	if (event->mask & (IN_CREATE | IN_MOVED_TO))
+	{
+	  try
+	  {
+	    addWatches(path);
+	  }
+	  catch (const std::exception & ex)
+	  {
+	    std::cerr << filename << " : " << ex.what() << std::endl;
+	  }
+	}
+      }
+      _pending[filename] = deadline;
+    }
+
+    return !overflow;
+  }
+
+  /*!
+  ** Process the paths which stayed quiet long enough, by batches.
+  **
+  ** @param all If all paths are processed, quiet or not
+  */
+  void
+  Watcher::processPending(const bool all)
+  {
+    const unsigned long long current = now();
+    std::vector<std::string> batch;
+
+    pendingMap::iterator i = _pending.begin();
+    while (i != _pending.end())
+    {
+      if (!all && i->second > current)
+      {
+	++i;
+	continue;
+      }
+      batch.push_back(i->first);
+      _pending.erase(i++);
+      if (batch.size() == BATCH_SIZE)
+      {
+	processBatch(batch);
+	batch.clear();
+      }
+    }
+    if (!batch.empty())
+      processBatch(batch);
+  }
+
+  /*!
+  ** Process some paths within a single transaction. A directory which
+  ** appeared is indexed afterwards, with its own transactions. Then the
+  ** buffered postings are written, so that they can be searched.
+  **
+  ** @param batch The paths to process
+  */
+  void
+  Watcher::processBatch(const std::vector<std::string>& batch)
+  {
+    Index::Database& db = Index::Database::getInstance();
+    std::vector<std::string> directories;
+
+    db.beginTransaction();
+    for (std::vector<std::string>::const_iterator i = batch.begin();
+	 i != batch.end(); ++i)
+    {
+      try
+      {
+	if (fs::is_directory(*i))
+	  directories.push_back(*i);
+	else
+	  processPath(*i);
+      }
+      catch (const std::exception & ex)
+      {
+	std::cerr << *i << " : " << ex.what() << std::endl;
+      }
+    }
+    db.endTransaction();
+
+    for (std::vector<std::string>::const_iterator i = directories.begin();
+	 i != directories.end(); ++i)
+      _indexer.indexDirectory(*i);
+    db.flush();
+  }
+
+  /*!
+  ** Index a file which was modified, or remove a file which disappeared.
+  ** A path which disappeared may be a directory, so the documents under
+  ** it are removed too. Must be called within a transaction.
+  **
+  ** @param path The full path
+  */
+  void
+  Watcher::processPath(const std::string& path)
+  {
+    Index::Database& db = Index::Database::getInstance();
+    if (_indexer.getVerbose())
+      std::cout << "Processing : " << path << std::endl;
+
+    if (fs::is_regular(path))
+    {
+      ParsedDocument parsed;
+      parsed.doc = db.getDocumentByFilename(path);
+      if (_indexer.parseFile(path, parsed, *_stem))
+      {
+	_indexer.commitDocument(parsed);
+	_modified = true;
+      }
+      return;
+    }
+
+    if (_indexer.removeFile(path))
+      _modified = true;
+    const std::list<Column::Document> docs = db.getDocumentsUnder(path);
+    for (std::list<Column::Document>::const_iterator i = docs.begin();
+	 i != docs.end(); ++i)
+      if (_indexer.removeFile(i->filename))
+	_modified = true;
+  }
+
+  /*!
+  ** Delete the terms which are not used anymore, if documents were
+  ** modified. As all terms are checked, it's not done after each batch.
+  **
+  ** @param force If it's done now, however long ago it was last done
+  */
+  void
+  Watcher::cleanup(const bool force)
+  {
+    const unsigned long long current = now();
+    if (!_modified || (!force && current < _lastCleanup + CLEANUP_DELAY))
+      return;
+
+    Index::Database& db = Index::Database::getInstance();
+    db.beginTransaction();
+    const unsigned int terms = db.deleteUnusedTerms();
+    db.endTransaction();
+    if (_indexer.getVerbose() || terms > 0)
+      std::cout << "Removed " << terms << " unused terms." << std::endl;
+
+    _modified = false;
+    _lastCleanup = current;
+  }
+
+  /*!
+  ** Index all directories again, after events were lost. Their new
+  ** subdirectories are watched first.
+  */
+  void
+  Watcher::rescan()
+  {
+    std::cerr << "Events were lost, indexing everything again." << std::endl;
+    _pending.clear();
+    for (std::vector<fs::path>::const_iterator i = _roots.begin();
+	 i != _roots.end(); ++i)
+    {
+      addWatches(*i);
+      _indexer.indexDirectory(i->native_file_string());
+    }
+    Index::Database::getInstance().flush();
+  }
+
+  /*!
+  ** Get how long to wait for events: until the next pending path is
+  ** quiet, or the next collection of unused terms.
+  **
+  ** @return The delay in milliseconds, or -1 to wait forever
+  */
+  int
+  Watcher::getTimeout() const
+  {
+    unsigned long long next = 0;
+    if (_modified)
+      next = _lastCleanup + CLEANUP_DELAY;
+    for (pendingMap::const_iterator i = _pending.begin(); i != _pending.end(); ++i)
+      if (next == 0 || i->second < next)
+	next = i->second;
+
+    if (next == 0)
+      return -1;
+    const unsigned long long current = now();
+
+    return next > current ? static_cast<int>(next - current) : 0;
+  }
+
+  /*!
+  ** Get the time of a monotonic clock.
+  **
+  ** @return The time in milliseconds
+  */
+  unsigned long long
+  Watcher::now()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+  }
+}
@@ -0,0 +1,62 @@
+#ifndef WATCHER_HH_
+# define WATCHER_HH_
+
+# include <map>
+# include <memory>
+# include <string>
+# include <vector>
+# include <boost/filesystem/path.hpp>
+# include "Indexer.hh"
+
+namespace fs = boost::filesystem;
+
+namespace Index
+{
+  /*!
+  ** Keep the index of some directories up to date, until interrupted.
+  ** The directories are indexed once, then every directory of their
+  ** trees is watched with inotify. Events are coalesced by path, and
+  ** a path is only processed once it stayed quiet for a short delay,
+  ** by small batches, each in a single transaction. If the kernel
+  ** queue overflows, events were lost, so the trees are indexed again.
+  */
+  class Watcher
+  {
+    typedef std::map<int, fs::path> watchMap;
+    typedef std::map<std::string, unsigned long long> pendingMap;
+
+  public:
+    Watcher(const Indexer& indexer);
+    ~Watcher();
+
+  public:
+    void run(const std::vector<std::string>& roots);
+
+  private:
+    Watcher(const Watcher& watcher);
+    Watcher& operator=(const Watcher& watcher);
+    void addWatches(const fs::path& directory);
+    void removeWatches(const std::string& directory);
+    bool readEvents();
+    void processPending(const bool all);
+    void processBatch(const std::vector<std::string>& batch);
+    void processPath(const std::string& path);
+    void cleanup(const bool force);
+    void rescan();
+    int getTimeout() const;
+    static unsigned long long now();
+
+  private:
+    const Indexer&			_indexer;
+    std::auto_ptr<Stemmer::Generic>	_stem;
+    std::vector<fs::path>		_roots;
+    int					_fd;
+    watchMap				_watches;
+    pendingMap				_pending;
+    std::vector<char>			_buffer;
+    bool				_modified;
+    unsigned long long			_lastCleanup;
+  };
+}
+
+#endif /* !WATCHER_HH_ */
@@ -2,6 +2,9 @@
 #include "SQLiteException.hh"
 #include "Indexer.hh"
 #include "Searcher.hh"
+#include "Server.hh"
+#include "Client.hh"
+#include "Watcher.hh"
 #include "Configuration.hh"
 #include <boost/program_options/option.hpp>
 #include <boost/program_options/options_description.hpp>
@@ -43,6 +46,7 @@ namespace
       db.open(cfg.getDatabaseName());
       Index::Indexer idx;
       idx.setVerbose(cfg.getVerbose());
+      idx.setJobs(cfg.getJobs());
       idx.indexDirectory(item);
       db.close();
     }
@@ -55,6 +59,65 @@ namespace
     return 0;
   }
 
+  /*!
+  ** Index given items, then keep their index up to date until
+  ** interrupted.
+  **
+  ** @param items Directory paths
+  **
+  ** @return If indexation succeed
+  */
+  inline int watchItems(const std::vector<std::string>& items)
+  {
+    try
+    {
+      Index::Database& db = Index::Database::getInstance();
+      Configuration& cfg = Configuration::getInstance();
+      db.open(cfg.getDatabaseName());
+      Index::Indexer idx;
+      idx.setVerbose(cfg.getVerbose());
+      idx.setJobs(cfg.getJobs());
+      Index::Watcher watcher(idx);
+      watcher.run(items);
+      db.close();
+    }
+    catch (SQLite::Exception& ex)
+    {
+      std::cerr << ex.errorMessage() << std::endl;
+      return 3;
+    }
+
+    return 0;
+  }
+
+  /*!
+  ** Compact the index, merging all its segments.
+  **
+  ** @return If compaction succeed
+  */
+  inline int compact()
+  {
+    try
+    {
+      Index::Database& db = Index::Database::getInstance();
+      Configuration& cfg = Configuration::getInstance();
+      db.open(cfg.getDatabaseName());
+      boost::timer timer;
+      const unsigned int segments = db.compact();
+      if (cfg.getVerbose())
+	std::cout << "Merged " << segments << " segments in " << timer.elapsed()
+		  << " seconds." << std::endl;
+      db.close();
+    }
+    catch (SQLite::Exception& ex)
+    {
+      std::cerr << ex.errorMessage() << std::endl;
+      return 3;
+    }
+
+    return 0;
+  }
+
   /*!
   ** Search all documents matching the given request.
   **
@@ -70,7 +133,7 @@ namespace
       Configuration& cfg = Configuration::getInstance();
       db.open(cfg.getDatabaseName());
       Search::Searcher searcher;
-      searcher.search(expression);
+      searcher.search(expression, cfg.getLimit());
       searcher.displayFoundDocument();
       db.close();
     }
@@ -83,6 +146,57 @@ namespace
     return 0;
   }
 
+  /*!
+  ** Answer the search requests received on a socket, until interrupted.
+  **
+  ** @return If the server could run
+  */
+  inline int serve()
+  {
+    try
+    {
+      Index::Database& db = Index::Database::getInstance();
+      Configuration& cfg = Configuration::getInstance();
+      db.open(cfg.getDatabaseName());
+      bool listened;
+      {
+	Search::Server server(cfg.getSocketName(), cfg.getJobs());
+	listened = server.run();
+      }
+      db.close();
+      if (!listened)
+	return 3;
+    }
+    catch (SQLite::Exception& ex)
+    {
+      std::cerr << ex.errorMessage() << std::endl;
+      return 3;
+    }
+
+    return 0;
+  }
+
+  /*!
+  ** Send search requests to a running server, and display its answers.
+  **
+  ** @param expressions The expressions to match
+  **
+  ** @return 0 if the server answered, else another value
+  */
+  inline int query(const std::vector<std::string>& expressions)
+  {
+    Configuration& cfg = Configuration::getInstance();
+    Search::Client client(cfg.getSocketName());
+    if (!client.connect())
+      return 3;
+    for (std::vector<std::string>::const_iterator i = expressions.begin();
+	 i != expressions.end(); ++i)
+      if (!client.search(*i, cfg.getLimit()))
+	return 3;
+
+    return 0;
+  }
+
   /*!
   ** Parse all option and apply correct behavior.
   **
@@ -102,14 +216,44 @@ namespace
 	("help,h", "Produce help message.")
 	("verbose,v", "Active verbose mode.")
 	("mode,m", opt::value<std::string>(),
-	 "Behavior mode (indexer or searcher).")
+	 "Behavior mode (indexer, watch, compact, searcher, server or client).")
 	("database-location,d", opt::value<std::string>()->default_value("mydb.data"),
 	 "Location of the sqlite3 database used to store inverse index. "
 	 "Default is \"mydb.data\".")
 	("stemmer-type,s", opt::value<std::string>()->default_value("frenchquick"),
 	 "Type of stemmer (french or frenchquick). Default is frenchquick.")
+#ifdef EMBEDDED_STOPWORDS
+	("stopwords-file,t", opt::value<std::string>()->default_value(""),
+	 "File where the stop words are (default is the list embedded at build time).")
+#else
 	("stopwords-file,t", opt::value<std::string>()->default_value("StopWordList.txt"),
 	 "File where the stop words are (default is \"StopWordList.txt\").")
+#endif
+	("jobs,j", opt::value<unsigned int>()->default_value(1),
+	 "Number of threads parsing documents while indexing, or answering "
+	 "requests in a server. Default is 1.")
+	("limit,l", opt::value<unsigned int>()->default_value(0),
+	 "Only find the given number of best documents. Default is 0, no limit.")
+	("stem-cache,c", opt::value<unsigned int>()->default_value(65536),
+	 "Number of stems remembered while indexing. Default is 65536, 0 disables it.")
+	("fold-accents,a",
+	 "Index and search words without their accents. The same choice must be "
+	 "made when indexing and searching.")
+	("storage-engine,e", opt::value<std::string>()->default_value("sqlite"),
+	 "Where the postings are stored: sqlite, or segment for compressed files "
+	 "next to the database. The same choice must be made when indexing and "
+	 "searching. Default is sqlite.")
+	("scorer,r", opt::value<std::string>()->default_value("static"),
+	 "How found documents are ranked: static, with the scores computed "
+	 "while indexing, or bm25, from the statistics of the collection. "
+	 "With --limit, static reads a single term by best score from the "
+	 "sqlite engine, while bm25 reads all its documents. Default is static.")
+	("paranoid,p",
+	 "Hash every file while indexing, even when its size, date and inode "
+	 "show it's unchanged.")
+	("socket,k", opt::value<std::string>()->default_value("mdr2008.sock"),
+	 "Where the search server listens: the path of a Unix socket, or a TCP "
+	 "port on localhost. Default is \"mdr2008.sock\".")
 	;
 
       // Invisible option, used for classic unnamed options
@@ -134,9 +278,17 @@ namespace
       if (vm.count("help"))
       {
 	std::cout << "Usage : \n\t--mode=indexer [--database-location] "
-	  "[--stemmer-type] [--stopwords-file] [--verbose] items" <<
-	  "\n\t--mode=searcher [--stemmer-type] [--stop-words-file] "
-	  " [--verbose] expressions" <<
+	  "[--stemmer-type] [--stopwords-file] [--jobs] [--stem-cache] [--fold-accents] "
+	  "[--storage-engine] [--paranoid] [--verbose] items" <<
+	  "\n\t--mode=watch [--database-location] [--stemmer-type] [--stopwords-file] "
+	  "[--jobs] [--stem-cache] [--fold-accents] [--storage-engine] [--paranoid] "
+	  "[--verbose] directories" <<
+	  "\n\t--mode=compact [--database-location] [--storage-engine] [--verbose]" <<
+	  "\n\t--mode=searcher [--database-location] [--stemmer-type] [--stopwords-file] "
+	  "[--limit] [--fold-accents] [--storage-engine] [--scorer] [--verbose] expressions" <<
+	  "\n\t--mode=server [--database-location] [--stopwords-file] [--fold-accents] "
+	  "[--storage-engine] [--scorer] [--jobs] [--socket] [--verbose]" <<
+	  "\n\t--mode=client [--limit] [--socket] expressions" <<
 	  '\n';
 	std::cout << desc << std::endl;
 	return 1;
@@ -148,6 +300,24 @@ namespace
       cfg.setStemmerName(vm["stemmer-type"].as<std::string>());
       cfg.setStopwordFilename(vm["stopwords-file"].as<std::string>());
       cfg.setVerbose(vm.count("verbose") > 0);
+      cfg.setJobs(vm["jobs"].as<unsigned int>());
+      cfg.setLimit(vm["limit"].as<unsigned int>());
+      cfg.setStemCache(vm["stem-cache"].as<unsigned int>());
+      cfg.setFoldAccents(vm.count("fold-accents") > 0);
+      cfg.setParanoid(vm.count("paranoid") > 0);
+      cfg.setSocketName(vm["socket"].as<std::string>());
+      cfg.setStorageEngine(vm["storage-engine"].as<std::string>());
+      if (cfg.getStorageEngine() != "sqlite" && cfg.getStorageEngine() != "segment")
+      {
+	std::cerr << cfg.getStorageEngine() << " : Unknow storage engine" << std::endl;
+	return 2;
+      }
+      cfg.setScorerName(vm["scorer"].as<std::string>());
+      if (cfg.getScorerName() != "bm25" && cfg.getScorerName() != "static")
+      {
+	std::cerr << cfg.getScorerName() << " : Unknow scorer" << std::endl;
+	return 2;
+      }
 
       if (vm.count("mode"))
       {
@@ -168,26 +338,54 @@ namespace
 	  }
 	}
 	else
-	  if (vm["mode"].as<std::string>() == "searcher")
+	  if (vm["mode"].as<std::string>() == "watch")
 	  {
 	    if (vm.count("items"))
-	    {
-	      std::vector<std::string> opts = vm["items"].as<std::vector<std::string> >();
-	      for (std::vector<std::string>::const_iterator iter = opts.begin();
-		   iter != opts.end(); ++iter)
-		res = max(res, search(*iter));
-	    }
+	      res = watchItems(vm["items"].as<std::vector<std::string> >());
 	    else
 	    {
-	      std::cerr << "Error : You must specify at least one search request." << std::endl;
+	      std::cerr << "Error : You must specify which directories to watch." << std::endl;
 	      return 2;
 	    }
 	  }
 	  else
-	  {
-	    std::cerr << vm["mode"].as<std::string>() << " : Unknow mode" << std::endl;
-	    return 2;
-	  }
+	    if (vm["mode"].as<std::string>() == "compact")
+	      res = compact();
+	    else
+	      if (vm["mode"].as<std::string>() == "searcher")
+	      {
+		if (vm.count("items"))
+		{
+		  std::vector<std::string> opts = vm["items"].as<std::vector<std::string> >();
+		  for (std::vector<std::string>::const_iterator iter = opts.begin();
+		       iter != opts.end(); ++iter)
+		    res = max(res, search(*iter));
+		}
+		else
+		{
+		  std::cerr << "Error : You must specify at least one search request." << std::endl;
+		  return 2;
+		}
+	      }
+	      else
+		if (vm["mode"].as<std::string>() == "server")
+		  res = serve();
+		else
+		  if (vm["mode"].as<std::string>() == "client")
+		  {
+		    if (vm.count("items"))
+		      res = query(vm["items"].as<std::vector<std::string> >());
+		    else
+		    {
+		      std::cerr << "Error : You must specify at least one search request." << std::endl;
+		      return 2;
+		    }
+		  }
+		  else
+		  {
+		    std::cerr << vm["mode"].as<std::string>() << " : Unknow mode" << std::endl;
+		    return 2;
+		  }
       }
       else
       {